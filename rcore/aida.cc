@@ -934,6 +934,31 @@ Any::from_transition (BaseConnection &base_connection)
     }
 }
 
+void
+Any::transition_orbids (std::vector<uint64> &orbids) const
+{
+  switch (kind())
+    {
+    case SEQUENCE:
+      for (size_t i = 0; i < u_.vanys().size(); i++)
+        u_.vanys()[i].transition_orbids (orbids);
+      break;
+    case RECORD:
+      for (size_t i = 0; i < u_.vfields().size(); i++)
+        u_.vfields()[i].transition_orbids (orbids);
+      break;
+    case ANY:
+      if (u_.vany)
+        u_.vany->transition_orbids (orbids);
+      break;
+    case TRANSITION:
+      if (u_.vint64)
+        orbids.push_back (u_.vint64);
+      break;
+    default: ;
+    }
+}
+
 // == OrbObject ==
 OrbObject::OrbObject (uint64 orbid) :
   orbid_ (orbid)
@@ -1163,6 +1188,27 @@ ProtoMsg::to_string() const
   return s;
 }
 
+/// Collect the orbids of all handles contained in a message without popping them.
+void
+ProtoMsg::transition_orbids (std::vector<uint64> &orbids) const
+{
+  for (size_t i = 0; i < size(); i++)
+    switch (type_at (i))
+      {
+      case TRANSITION:
+        if (upeek (i).vint64)
+          orbids.push_back (upeek (i).vint64);
+        break;
+      case SEQUENCE: case RECORD:
+        ((const ProtoMsg*) &upeek (i))->transition_orbids (orbids);
+        break;
+      case ANY:
+        upeek (i).vany->transition_orbids (orbids);
+        break;
+      default: ;
+      }
+}
+
 #if 0
 ProtoMsg*
 ProtoMsg::new_error (const String &msg,
@@ -1587,6 +1633,12 @@ public:
 };
 
 // == ObjectMap ==
+/* The ObjectMap assigns orbids to instances used remotely. An orbid contains a slot index
+ * plus a generation counter in the bits left out by id_mask, the generation is incremented
+ * whenever a slot is released, so stale orbids referring to a reused slot are detected.
+ * The orbid is cached on the instance, so mapping instances to orbids needs no lookups,
+ * instances already mapped by another ObjectMap are tracked in a separate hash map.
+ */
 template<class Instance>
 class ObjectMap {
 public:
@@ -1595,10 +1647,11 @@ private:
   struct Entry {
     OrbObjectW  orbow;
     InstanceP   instancep;
+    uint16      generation;
   };
-  uint64                                start_id_, id_mask_;
+  uint64                                start_id_, id_mask_, generation_mask_, prandom_;
   std::vector<Entry>                    entries_;
-  std::unordered_map<Instance*, uint64> map_;
+  std::unordered_map<Instance*, uint64> foreign_map_;   // instances with orbid_cache_ of another ObjectMap
   std::vector<uint>                     free_list_;
   class MappedObject : public virtual OrbObject {
     friend class FriendAllocator<MappedObject>;
@@ -1609,9 +1662,12 @@ private:
   };
   void          delete_orbid            (uint64            orbid);
   uint          next_index              ();
+  Entry*        lookup_entry            (uint64            orbid);
+  static uint64 generation_bits         (uint16 generation)     { return uint64 (generation) << 32; }
 public:
-  explicit   ObjectMap          (size_t            start_id = 0) : start_id_ (start_id), id_mask_ (0xffffffffffffffff) {}
-  /*dtor*/  ~ObjectMap          ()                 { assert (entries_.size() == 0); assert (map_.size() == 0); }
+  explicit   ObjectMap          (size_t            start_id = 0) :
+    start_id_ (start_id), id_mask_ (0xffffffffffffffff), generation_mask_ (0), prandom_ (0x9e3779b97f4a7c15) {}
+  /*dtor*/  ~ObjectMap          ()                 { assert (entries_.size() == free_list_.size()); assert (foreign_map_.size() == 0); }
   OrbObjectP orbo_from_instance (InstanceP         instancep);
   InstanceP  instance_from_orbo (const OrbObjectP &orbo);
   OrbObjectP orbo_from_orbid    (uint64            orbid);
@@ -1626,24 +1682,48 @@ ObjectMap<Instance>::assign_start_id (uint64 start_id, uint64 id_mask)
   start_id_ = start_id;
   assert (id_mask > 0);
   id_mask_ = id_mask;
-  assert (map_.size() == 0);
+  generation_mask_ = ~id_mask_ & OrbObject::orbid_make (0, 0xffff, 0); // generations use unmasked type_index bits
+  assert (foreign_map_.size() == 0);
 }
 
-template<class Instance> void
-ObjectMap<Instance>::delete_orbid (uint64 orbid)
+/// Find the entry for @a orbid if its slot is in use by the same generation.
+template<class Instance> typename ObjectMap<Instance>::Entry*
+ObjectMap<Instance>::lookup_entry (uint64 orbid)
 {
-  assert ((orbid & id_mask_) >= start_id_);
+  if ((orbid & id_mask_) < start_id_)
+    return NULL;
   const uint64 index = (orbid & id_mask_) - start_id_;
-  assert (index < entries_.size());
+  if (index >= entries_.size())
+    return NULL;
   Entry &e = entries_[index];
-  assert (e.orbow.expired());   // ensure last OrbObjectP reference has been dropped
-  assert (e.instancep != NULL); // ensure *first* deletion attempt for this entry
-  auto it = map_.find (e.instancep.get());
-  assert (it != map_.end());
-  map_.erase (it);
-  e.instancep.reset();
-  e.orbow.reset();
-  free_list_.push_back (index);
+  if (!e.instancep ||                                                   // check for deletion
+      (orbid & generation_mask_) != (generation_bits (e.generation) & generation_mask_)) // stale orbid
+    return NULL;
+  return &e;
+}
+
+template<class Instance> void
+ObjectMap<Instance>::delete_orbid (uint64 orbid)
+{
+  Entry *e = lookup_entry (orbid);
+  assert (e != NULL);           // ensure *first* deletion attempt for this entry
+  assert (e->orbow.expired());  // ensure last OrbObjectP reference has been dropped
+  Instance *instance = e->instancep.get();
+  if (instance->orbid_omap_ == this)
+    {
+      instance->orbid_omap_ = NULL;
+      instance->orbid_cache_ = 0;
+    }
+  else
+    {
+      auto it = foreign_map_.find (instance);
+      assert (it != foreign_map_.end());
+      foreign_map_.erase (it);
+    }
+  e->instancep.reset();
+  e->orbow.reset();
+  e->generation += 1;           // invalidates all orbids referring to the old slot contents
+  free_list_.push_back (e - &entries_[0]);
 }
 
 template<class Instance> uint
@@ -1651,10 +1731,10 @@ ObjectMap<Instance>::next_index ()
 {
   uint idx;
   const size_t FREE_LENGTH = 31;
-  if (free_list_.size() > FREE_LENGTH)
+  if (free_list_.size() > FREE_LENGTH)  // delay reuse of released slots
     {
-      const size_t prandom = byte_hash64 ((uint8*) free_list_.data(), sizeof (free_list_.data()) * free_list_.size());
-      const size_t end = free_list_.size(), j = prandom % (end - 1);
+      prandom_ = prandom_ * 6364136223846793005ULL + 1442695040888963407ULL; // LCG step, see Knuth's MMIX
+      const size_t end = free_list_.size(), j = (prandom_ >> 32) % (end - 1);
       assert (j < end - 1); // use end-1 to avoid popping the last pushed slot
       idx = free_list_[j];
       free_list_[j] = free_list_[end - 1];
@@ -1674,15 +1754,24 @@ ObjectMap<Instance>::orbo_from_instance (InstanceP instancep)
   OrbObjectP orbop;
   if (instancep)
     {
-      uint64 orbid = map_[instancep.get()];
+      Instance *instance = instancep.get();
+      const bool cached = instance->orbid_omap_ == this || instance->orbid_omap_ == NULL;
+      uint64 orbid = instance->orbid_omap_ == this ? instance->orbid_cache_ : cached ? 0 : foreign_map_[instance];
       if (AIDA_UNLIKELY (orbid == 0))
         {
           const uint64 index = next_index();
-          orbid = start_id_ + index;
+          Entry &e = entries_[index];
+          orbid = start_id_ + index + (generation_bits (e.generation) & generation_mask_);
           orbop = FriendAllocator<MappedObject>::make_shared (orbid, *this); // calls delete_orbid from dtor
-          Entry e { orbop, instancep };
-          entries_[index] = e;
-          map_[instancep.get()] = orbid;
+          e.orbow = orbop;
+          e.instancep = instancep;
+          if (cached)
+            {
+              instance->orbid_omap_ = this;
+              instance->orbid_cache_ = orbid;
+            }
+          else
+            foreign_map_[instance] = orbid;
         }
       else
         orbop = entries_[(orbid & id_mask_) - start_id_].orbow.lock();
@@ -1694,9 +1783,9 @@ template<class Instance> OrbObjectP
 ObjectMap<Instance>::orbo_from_orbid (uint64 orbid)
 {
   assert ((orbid & id_mask_) >= start_id_);
-  const uint64 index = (orbid & id_mask_) - start_id_;
-  if (index < entries_.size() && entries_[index].instancep) // check for deletion
-    return entries_[index].orbow.lock();
+  Entry *e = lookup_entry (orbid);
+  if (e)
+    return e->orbow.lock();
   return OrbObjectP();
 }
 
@@ -1704,12 +1793,9 @@ template<class Instance> std::shared_ptr<Instance>
 ObjectMap<Instance>::instance_from_orbo (const OrbObjectP &orbo)
 {
   const uint64 orbid = orbo ? orbo->orbid() : 0;
-  if ((orbid & id_mask_) >= start_id_)
-    {
-      const uint64 index = (orbid & id_mask_) - start_id_;
-      if (index < entries_.size())
-        return entries_[index].instancep;
-    }
+  Entry *e = lookup_entry (orbid);
+  if (e)
+    return e->instancep;
   return NULL;
 }
 
@@ -1834,16 +1920,18 @@ class ClientConnectionImpl : public ClientConnection {
   TransportChannel              transport_channel_;     // messages arriving at client
   sem_t                         transport_sem_;         // signal incomming results
   std::deque<ProtoMsg*>         event_queue_;           // messages pending for client
-  typedef std::map<uint64, OrbObjectW> Id2OrboMap;
+  typedef std::unordered_map<uint64, OrbObjectW> Id2OrboMap;
+  typedef std::pair<uint64, uint64> OrbidCount;
   Id2OrboMap                    id2orbo_map_;           // map server orbid -> OrbObjectP
+  std::vector<OrbidCount>       gc_trash_;              // released orbids with receive counts, pending report
   std::vector<SignalHandler*>   signal_handlers_;
   UIntSet                       ehandler_set; // client event handler
   bool                          blocking_for_sem_;
-  bool                          seen_garbage_;
   SignalHandler*                signal_lookup (size_t handler_id);
+  enum { GC_REPORT_BATCH = 256, }; // maximum number of released orbids per GARBAGE_REPORT
 public:
   ClientConnectionImpl (const std::string &protocol, ServerConnection &server_connection) :
-    ClientConnection (protocol), blocking_for_sem_ (false), seen_garbage_ (false)
+    ClientConnection (protocol), blocking_for_sem_ (false)
   {
     assert (!server_connection.has_peer());
     signal_handlers_.push_back (NULL); // reserve 0 for NULL
@@ -1868,7 +1956,8 @@ public:
   }
   void                 notify_for_result ()             { if (blocking_for_sem_) sem_post (&transport_sem_); }
   void                 block_for_result  ()             { AIDA_ASSERT (blocking_for_sem_); sem_wait (&transport_sem_); }
-  void                 gc_sweep          (const ProtoMsg *fb);
+  void                 gc_report         ();
+  void                 gc_claim          ();
   virtual int          notify_fd         () override    { return transport_channel_.inputfd(); }
   virtual bool         pending           () override    { return !event_queue_.empty() || transport_channel_.has_msg(); }
   virtual ProtoMsg*    call_remote       (ProtoMsg*) override;
@@ -1881,24 +1970,13 @@ public:
   virtual size_t       signal_connect    (uint64 hhi, uint64 hlo, const RemoteHandle &rhandle, SignalEmitHandler seh, void *data) override;
   virtual bool         signal_disconnect (size_t signal_handler_id) override;
   struct ClientOrbObject;
-  void
-  client_orb_object_deleting (ClientOrbObject &coo)
-  {
-    if (!seen_garbage_)
-      {
-        seen_garbage_ = true;
-        ProtoMsg *fb = ProtoMsg::_new (3);
-        fb->add_header1 (MSGID_META_SEEN_GARBAGE, 0, 0);
-        GCLOG ("ClientConnectionImpl: SEEN_GARBAGE (%016x)", coo.orbid());
-        ProtoMsg *fr = this->call_remote (fb); // takes over fb
-        assert (fr == NULL);
-      }
-  }
+  void                 client_orb_object_deleting (ClientOrbObject &coo);
   class ClientOrbObject : public OrbObject {
     friend                class FriendAllocator<ClientOrbObject>;
     ClientConnectionImpl &client_connection_;
   public:
-    explicit ClientOrbObject (uint64 orbid, ClientConnectionImpl &c) : OrbObject (orbid), client_connection_ (c) { assert (orbid); }
+    uint64                   received_;         // number of times orbid was received from the server
+    explicit ClientOrbObject (uint64 orbid, ClientConnectionImpl &c) : OrbObject (orbid), client_connection_ (c), received_ (0) { assert (orbid); }
     virtual                  ~ClientOrbObject   () override          { client_connection_.client_orb_object_deleting (*this); }
     virtual ClientConnection* client_connection ()                   { return &client_connection_; }
   };
@@ -1948,39 +2026,82 @@ void
 ClientConnectionImpl::pop_handle (ProtoReader &fr, RemoteHandle &rhandle)
 {
   const uint64 orbid = fr.pop_orbid();
-  OrbObjectP orbop = id2orbo_map_[orbid].lock();
-  if (AIDA_UNLIKELY (!orbop) && orbid)
+  OrbObjectP orbop;
+  if (AIDA_LIKELY (orbid))
     {
-      orbop = FriendAllocator<ClientOrbObject>::make_shared (orbid, *this);
-      id2orbo_map_[orbid] = orbop;
+      OrbObjectW &orbow = id2orbo_map_[orbid];
+      orbop = orbow.lock();
+      if (AIDA_UNLIKELY (!orbop))
+        {
+          orbop = FriendAllocator<ClientOrbObject>::make_shared (orbid, *this);
+          orbow = orbop;
+        }
+      static_cast<ClientOrbObject*> (orbop.get())->received_ += 1; // balances the server's send count
     }
   (rhandle.*pmf_upgrade_from) (orbop);
 }
 
 void
-ClientConnectionImpl::gc_sweep (const ProtoMsg *fb)
+ClientConnectionImpl::client_orb_object_deleting (ClientOrbObject &coo)
 {
-  ProtoReader fbr (*fb);
-  const MessageId msgid = MessageId (fbr.pop_int64());
-  assert (msgid_is (msgid, MSGID_META_GARBAGE_SWEEP));
-  // collect expired object ids and send to server
-  vector<uint64> trashids;
-  for (auto it = id2orbo_map_.begin(); it != id2orbo_map_.end();)
-    if (it->second.expired())
-      {
-        trashids.push_back (it->first);
-        it = id2orbo_map_.erase (it);
-      }
-    else
-      ++it;
-  ProtoMsg *fr = ProtoMsg::_new (3 + 1 + trashids.size()); // header + length + items
+  // the weak reference has expired already, the map entry can only be replaced after this returns
+  auto it = id2orbo_map_.find (coo.orbid());
+  if (it != id2orbo_map_.end() && it->second.expired())
+    id2orbo_map_.erase (it);
+  gc_trash_.push_back (OrbidCount (coo.orbid(), coo.received_));
+  if (gc_trash_.size() >= GC_REPORT_BATCH)
+    gc_report();
+}
+
+/// Send pending released orbids with their receive counts to the server, the server releases a reference once all sends are accounted for.
+void
+ClientConnectionImpl::gc_report ()
+{
+  return_if (gc_trash_.empty());
+  ProtoMsg *fr = ProtoMsg::_new (3 + 1 + 2 * gc_trash_.size()); // header + length + items
   fr->add_header1 (MSGID_META_GARBAGE_REPORT, 0, 0); // header
-  fr->add_int64 (trashids.size()); // length
-  for (auto v : trashids)
-    fr->add_int64 (v); // items
-  GCLOG ("ClientConnectionImpl: GARBAGE_REPORT: %u trash ids", trashids.size());
+  fr->add_int64 (gc_trash_.size()); // length
+  for (const auto &oc : gc_trash_)
+    {
+      fr->add_orbid (oc.first);
+      fr->add_int64 (oc.second);
+    }
+  GCLOG ("ClientConnectionImpl: GARBAGE_REPORT: %u released ids", gc_trash_.size());
+  gc_trash_.clear();
+  post_peer_msg (fr);
+}
+
+/** Reply to a server sweep with all orbids still held and their receive counts, ids not listed were lost or released.
+ * Must be called when the sweep arrives, ids received later were sent after the sweep and are not claimed.
+ * Ids in queued events were sent before the sweep, they are claimed although they are popped later.
+ */
+void
+ClientConnectionImpl::gc_claim ()
+{
+  gc_report();  // releases must be accounted for before the claim
+  std::unordered_map<uint64, uint64> claims;
+  claims.reserve (id2orbo_map_.size());
+  for (const auto &it : id2orbo_map_)
+    {
+      OrbObjectP orbop = it.second.lock();
+      if (orbop)
+        claims[it.first] = static_cast<ClientOrbObject*> (orbop.get())->received_;
+    }
+  std::vector<uint64> queued;
+  for (const ProtoMsg *fb : event_queue_)
+    fb->transition_orbids (queued);
+  for (uint64 orbid : queued)
+    claims[orbid] += 1;
+  ProtoMsg *fr = ProtoMsg::_new (3 + 1 + 2 * claims.size()); // header + length + items
+  fr->add_header1 (MSGID_META_GARBAGE_CLAIM, 0, 0); // header
+  fr->add_int64 (claims.size()); // length
+  for (const auto &oc : claims)
+    {
+      fr->add_orbid (oc.first);
+      fr->add_int64 (oc.second);
+    }
+  GCLOG ("ClientConnectionImpl: GARBAGE_CLAIM: %u held ids", claims.size());
   post_peer_msg (fr);
-  seen_garbage_ = false;
 }
 
 void
@@ -2025,7 +2146,7 @@ ClientConnectionImpl::dispatch ()
       }
       break;
     case MSGID_META_GARBAGE_SWEEP:
-      gc_sweep (fb);
+      gc_claim();       // fetched from the transport, so no ids from after the sweep have been received
       break;
     default: // result/reply messages are handled in call_remote
       print_warning (string_format ("%s: invalid message: %016x", __func__, msgid));
@@ -2033,12 +2154,15 @@ ClientConnectionImpl::dispatch ()
     }
   if (AIDA_UNLIKELY (fb))
     delete fb;
+  gc_report(); // handles released by signal handlers
 }
 
 ProtoMsg*
 ClientConnectionImpl::call_remote (ProtoMsg *fb)
 {
   AIDA_ASSERT (fb != NULL);
+  // report released handles before any call that might resend them
+  gc_report();
   // enqueue method call message
   const MessageId callid = MessageId (fb->first_id());
   const bool needsresult = msgid_needs_result (callid);
@@ -2077,7 +2201,7 @@ ClientConnectionImpl::call_remote (ProtoMsg *fb)
         event_queue_.push_back (fr);
       else if (retmask == MSGID_META_GARBAGE_SWEEP)
         {
-          gc_sweep (fr);
+          gc_claim();   // claim in order, before the result pops ids sent after the sweep
           delete fr;
         }
       else
@@ -2202,9 +2326,15 @@ class ServerConnectionImpl : public ServerConnection {
   ObjectMap<ImplicitBase>  object_map_;         // map of all objects used remotely
   ImplicitBaseP            remote_origin_;
   std::unordered_map<size_t, EmitResultHandler> emit_result_map_;
-  std::unordered_set<OrbObjectP> live_remotes_, *sweep_remotes_;
+  struct RemoteRef { OrbObjectP orbop; uint64 sent, swept; };
+  std::unordered_map<uint64, RemoteRef> live_remotes_; // orbid -> references sent and not yet released by the client
+  size_t                   sweep_threshold_;    // live_remotes_ size that triggers the next sweep
+  bool                     sweep_pending_;
+  enum { GC_SWEEP_MINIMUM = 1024, };            // minimum number of live references before sweeping
   RAPICORN_CLASS_NON_COPYABLE (ServerConnectionImpl);
-  void                  start_garbage_collection ();
+  void                  garbage_report          (ProtoReader &fbr);
+  void                  garbage_sweep           ();
+  void                  garbage_claim           (ProtoReader &fbr);
 public:
   explicit              ServerConnectionImpl    (const std::string &protocol);
   virtual              ~ServerConnectionImpl    () override;
@@ -2226,25 +2356,92 @@ public:
   }
 };
 
+/// Release references reported by the client, an object is kept alive until the client has released all copies sent.
 void
-ServerConnectionImpl::start_garbage_collection()
+ServerConnectionImpl::garbage_report (ProtoReader &fbr)
 {
-  if (sweep_remotes_)
+  const uint64 n_ids = fbr.pop_int64();
+  uint64 retain = 0, purge = 0;
+  for (uint64 i = 0; i < n_ids; i++)
     {
-      print_warning ("ServerConnectionImpl::start_garbage_collection: duplicate garbage collection request unimplemented");
-      return;
+      const uint64 orbid = fbr.pop_orbid(), received = fbr.pop_int64();
+      auto it = live_remotes_.find (orbid);
+      if (AIDA_UNLIKELY (it == live_remotes_.end() || it->second.sent < received))
+        {
+          print_warning (string_format ("%s: invalid release of orbid: %016x", __func__, orbid));
+          continue;
+        }
+      it->second.sent -= received;
+      it->second.swept -= MIN (it->second.swept, received);     // released before a pending claim
+      if (it->second.sent)
+        retain++;                       // copies still in transit to the client
+      else
+        {
+          live_remotes_.erase (it);     // deletes reference
+          purge++;
+        }
     }
-  // GARBAGE_SWEEP
-  sweep_remotes_ = new std::unordered_set<OrbObjectP>();
-  sweep_remotes_->swap (live_remotes_);
+  GCLOG ("ServerConnectionImpl: GARBAGE_COLLECTED: considered=%u retained=%u purged=%u active=%u",
+         n_ids, retain, purge, live_remotes_.size());
+}
+
+/** Start a sweep that expires references the client never claimed.
+ * Ids sent in messages that the client dropped without popping them are never released, so
+ * once the number of live references doubled, the client is asked for all ids it still holds.
+ * Only copies sent before the sweep are considered, the client claims the counts it received up to the sweep.
+ */
+void
+ServerConnectionImpl::garbage_sweep ()
+{
+  for (auto &it : live_remotes_)
+    it.second.swept = it.second.sent;
+  sweep_pending_ = true;
   ProtoMsg *fb = ProtoMsg::_new (3);
-  fb->add_header2 (MSGID_META_GARBAGE_SWEEP, 0, 0);
-  GCLOG ("ServerConnectionImpl: GARBAGE_SWEEP: %u candidates", sweep_remotes_->size());
+  fb->add_header1 (MSGID_META_GARBAGE_SWEEP, 0, 0);
+  GCLOG ("ServerConnectionImpl: GARBAGE_SWEEP: %u candidates", live_remotes_.size());
   post_peer_msg (fb);
 }
 
+/// Release all copies sent before a sweep that the client neither claimed nor released.
+void
+ServerConnectionImpl::garbage_claim (ProtoReader &fbr)
+{
+  const uint64 n_ids = fbr.pop_int64();
+  for (uint64 i = 0; i < n_ids; i++)
+    {
+      const uint64 orbid = fbr.pop_orbid(), received = fbr.pop_int64();
+      auto it = live_remotes_.find (orbid);
+      if (AIDA_UNLIKELY (it == live_remotes_.end() || it->second.swept < received))
+        {
+          print_warning (string_format ("%s: invalid claim of orbid: %016x", __func__, orbid));
+          continue;
+        }
+      it->second.sent -= it->second.swept - received;   // copies lost in transit
+      it->second.swept = 0;
+    }
+  uint64 expired = 0;
+  for (auto it = live_remotes_.begin(); it != live_remotes_.end();)
+    if (AIDA_UNLIKELY (it->second.swept))
+      {
+        it->second.sent -= it->second.swept;            // unclaimed copies were lost
+        it->second.swept = 0;
+        if (it->second.sent == 0)
+          {
+            it = live_remotes_.erase (it);              // deletes reference
+            expired++;
+            continue;
+          }
+        ++it;
+      }
+    else
+      ++it;
+  sweep_pending_ = false;
+  sweep_threshold_ = MAX (size_t (GC_SWEEP_MINIMUM), 2 * live_remotes_.size());
+  GCLOG ("ServerConnectionImpl: GARBAGE_CLAIMED: claimed=%u expired=%u active=%u", n_ids, expired, live_remotes_.size());
+}
+
 ServerConnectionImpl::ServerConnectionImpl (const std::string &protocol) :
-  ServerConnection (protocol), remote_origin_ (NULL), sweep_remotes_ (NULL)
+  ServerConnection (protocol), remote_origin_ (NULL), sweep_threshold_ (GC_SWEEP_MINIMUM), sweep_pending_ (false)
 {
   connection_registry->register_connection (*this);
   const uint64 start_id = OrbObject::orbid_make (0,  // unused
@@ -2275,7 +2472,12 @@ ServerConnectionImpl::add_interface (ProtoMsg &fb, ImplicitBaseP ibase)
   OrbObjectP orbop = object_map_.orbo_from_instance (ibase);
   fb.add_orbid (orbop ? orbop->orbid() : 0);
   if (orbop)
-    live_remotes_.insert (orbop);
+    {
+      RemoteRef &rref = live_remotes_[orbop->orbid()];
+      if (!rref.orbop)
+        rref = RemoteRef { orbop, 0, 0 };
+      rref.sent += 1;
+    }
 }
 
 ImplicitBaseP
@@ -2335,35 +2537,15 @@ ServerConnectionImpl::dispatch ()
           }
       }
       break;
-    case MSGID_META_SEEN_GARBAGE:
-      {
-        const uint64 hashhigh = fbr.pop_int64(), hashlow = fbr.pop_int64();
-        if (hashhigh == 0 && hashlow == 0) // convention, hash=(0,0)
-          start_garbage_collection();
-      }
-      break;
     case MSGID_META_GARBAGE_REPORT:
-      if (sweep_remotes_)
-        {
-          const uint64 __attribute__ ((__unused__)) hashhigh = fbr.pop_int64(), hashlow = fbr.pop_int64();
-          const uint64 sweeps = sweep_remotes_->size();
-          const uint64 n_ids = fbr.pop_int64();
-          std::unordered_set<uint64> trashids;
-          trashids.reserve (n_ids);
-          for (uint64 i = 0; i < n_ids; i++)
-            trashids.insert (fbr.pop_int64());
-          uint64 retain = 0;
-          for (auto orbop : *sweep_remotes_)
-            if (trashids.find (orbop->orbid()) == trashids.end())
-              {
-                live_remotes_.insert (orbop);   // retained objects
-                retain++;
-              }
-          delete sweep_remotes_;                // deletes references
-          sweep_remotes_ = NULL;
-          GCLOG ("ServerConnectionImpl: GARBAGE_COLLECTED: considered=%u retained=%u purged=%u active=%u",
-                 sweeps, retain, sweeps - retain, live_remotes_.size());
-        }
+      fbr.skip(); // hashhigh
+      fbr.skip(); // hashlow
+      garbage_report (fbr);
+      break;
+    case MSGID_META_GARBAGE_CLAIM:
+      fbr.skip(); // hashhigh
+      fbr.skip(); // hashlow
+      garbage_claim (fbr);
       break;
     case MSGID_EMIT_RESULT:
       {
@@ -2384,6 +2566,8 @@ ServerConnectionImpl::dispatch ()
     }
   if (AIDA_UNLIKELY (fb))
     delete fb;
+  if (AIDA_UNLIKELY (live_remotes_.size() >= sweep_threshold_) && !sweep_pending_)
+    garbage_sweep();    // all messages containing references have been posted
 }
 
 void
@@ -51,6 +51,7 @@ typedef std::string String;
 class RemoteHandle;
 class OrbObject;
 class ImplicitBase;
+template<class> class ObjectMap;
 class BaseConnection;
 class ClientConnection;
 class ServerConnection;
@@ -197,7 +198,13 @@ typedef std::vector<TypeHash> TypeHashList;
 // == ImplicitBase ==
 /// Abstract base interface that all IDL interfaces are implicitely derived from.
 class ImplicitBase : public virtual std::enable_shared_from_this<ImplicitBase> {
+  template<class> friend class ObjectMap;
+  const void                 *orbid_omap_;      // ObjectMap that assigned orbid_cache_
+  uint64                      orbid_cache_;     // orbid of this instance within orbid_omap_
 protected:
+  explicit                    ImplicitBase        () : orbid_omap_ (NULL), orbid_cache_ (0) {}
+  /*copy*/                    ImplicitBase        (const ImplicitBase&) : orbid_omap_ (NULL), orbid_cache_ (0) {}
+  ImplicitBase&               operator=           (const ImplicitBase&) { return *this; } // orbids stay with instances
   virtual                    ~ImplicitBase        () = 0; // abstract class
   virtual const PropertyList& __aida_properties__ () = 0; ///< Retrieve the list of properties for @a this instance.
   Property*                   __aida_lookup__     (const std::string &property_name);
@@ -264,9 +271,9 @@ enum MessageId {
   // meta messages and results
   MSGID_META_HELLO          = 0x7100000000000000ULL, ///< Hello from client, expects WELCOME.
   MSGID_META_WELCOME        = 0xf100000000000000ULL, ///< Hello reply from server, contains remote_origin.
-  MSGID_META_GARBAGE_SWEEP  = 0x7200000000000000ULL, ///< Garbage collection cycle, expects GARBAGE_REPORT.
-  MSGID_META_GARBAGE_REPORT = 0xf200000000000000ULL, ///< Reports expired/retained references.
-  MSGID_META_SEEN_GARBAGE   = 0x3300000000000000ULL, ///< Client indicates garbage collection may be useful.
+  MSGID_META_GARBAGE_REPORT = 0x3200000000000000ULL, ///< Client reports released references with their receive counts.
+  MSGID_META_GARBAGE_SWEEP  = 0x3300000000000000ULL, ///< Server asks for all references held by the client, expects GARBAGE_CLAIM.
+  MSGID_META_GARBAGE_CLAIM  = 0x3400000000000000ULL, ///< Client lists held references with their receive counts.
 };
 /// Check if msgid is a reply for a two-way call (one of the _RESULT or _REPLY message ids).
 inline constexpr bool msgid_is_result (MessageId msgid) { return (msgid & 0xc000000000000000ULL) == 0xc000000000000000ULL; }
@@ -549,6 +556,7 @@ public:
   std::vector<String> any_to_strings   () const;
   void                to_transition    (BaseConnection &base_connection);
   void                from_transition  (BaseConnection &base_connection);
+  void                transition_orbids (std::vector<uint64> &orbids) const; ///< Collect orbids of handles in transition.
   String              repr             (const String &field_name = "") const;
   String              to_string        () const; ///< Retrieve string representation of Any for printouts.
   int64               as_int64         () const; ///< Obtain contents as int64.
@@ -602,6 +610,7 @@ public:
   inline void      reset        ();
   String           first_id_str () const;
   String           to_string    () const;
+  void             transition_orbids (std::vector<uint64> &orbids) const;
   static String    type_name    (int field_type);
   static ProtoMsg* _new         (uint32 _ntypes); // Heap allocated ProtoMsg
   // static ProtoMsg* new_error (const String &msg, const String &domain = "");
@@ -2,6 +2,7 @@
 #include "formatter.hh"
 #include "main.hh"
 #include <cstring>
+#include <cmath>
 #include <unistd.h>     // isatty
 
 /** @TODO:
@@ -12,20 +13,6 @@
 namespace Rapicorn {
 namespace Lib {
 
-template<class... Args> static std::string
-system_string_printf (const char *format, Args... args)
-{
-  char *cstr = NULL;
-  int ret = asprintf (&cstr, format, args...);
-  if (ret >= 0 && cstr)
-    {
-      std::string result = cstr;
-      free (cstr);
-      return result;
-    }
-  return format;
-}
-
 static bool
 parse_unsigned_integer (const char **stringp, uint64_t *up)
 { // '0' | [1-9] [0-9]* : <= 18446744073709551615
@@ -253,76 +240,252 @@ StringFormatter::arg_as_precision (size_t nth)
   return MAX (0, precision);
 }
 
-template<class Arg> std::string
-StringFormatter::render_arg (const Directive &dir, const char *modifier, Arg arg)
+/// Left alignment is requested by the '-' flag or, like in C, by a negative '*' width argument.
+bool
+StringFormatter::adjust_left (const Directive &dir)
+{
+  return dir.adjust_left || (dir.use_width && dir.width_index && int32_t (arg_as_longlong (dir.width_index)) < 0);
+}
+
+template<class Arg> void
+StringFormatter::render_arg (FormatBuffer &out, const Directive &dir, const char *modifier, Arg arg)
 {
-  std::string result, format;
   const int field_width = !dir.use_width || !dir.width_index ? dir.field_width : arg_as_width (dir.width_index);
   const int field_precision = !dir.use_precision || !dir.precision_index ? MAX (0, dir.precision) : arg_as_precision (dir.precision_index);
+  const bool left = adjust_left (dir); // field_width is always positive
   // format directive
-  format += '%';
-  if (dir.adjust_left)
-    format += '-';
+  char format[32], *f = format;
+  *f++ = '%';
+  if (left)
+    *f++ = '-';
   if (dir.add_sign)
-    format += '+';
+    *f++ = '+';
   if (dir.add_space)
-    format += ' ';
-  if (dir.zero_padding && !dir.adjust_left&& strchr ("diouXx" "FfGgEeAa", dir.conversion))
-    format += '0';
+    *f++ = ' ';
+  if (dir.zero_padding && !left && strchr ("diouXx" "FfGgEeAa", dir.conversion))
+    *f++ = '0';
   if (dir.alternate_form && strchr ("oXx" "FfGgEeAa", dir.conversion))
-    format += '#';
+    *f++ = '#';
   if (dir.locale_grouping && strchr ("idu" "FfGg", dir.conversion))
-    format += '\'';
+    *f++ = '\'';
   if (dir.use_width)
-    format += '*';
+    *f++ = '*';
   if (dir.use_precision && strchr ("sm" "diouXx" "FfGgEeAa", dir.conversion)) // !cp
-    format += ".*";
-  if (modifier)
-    format += modifier;
-  format += dir.conversion;
-  // printf formatting
-  if (dir.use_width && dir.use_precision)
-    return system_string_printf (format.c_str(), field_width, field_precision, arg);
-  else if (dir.use_precision)
-    return system_string_printf (format.c_str(), field_precision, arg);
-  else if (dir.use_width)
-    return system_string_printf (format.c_str(), field_width, arg);
+    {
+      *f++ = '.';
+      *f++ = '*';
+    }
+  while (modifier && *modifier)
+    *f++ = *modifier++;
+  *f++ = dir.conversion;
+  *f = 0;
+  // printf formatting, needs the POSIX locale unless CURRENT_LOCALE was requested
+  if (locale_context_ != CURRENT_LOCALE && !saved_locale_)
+    saved_locale_ = uselocale (ScopedPosixLocale::posix_locale());
+  size_t avail = 64;
+  for (;;)
+    {
+      char *dest = out.reserve (avail);
+      int n;
+      if (dir.use_width && dir.use_precision)
+        n = snprintf (dest, avail + 1, format, field_width, field_precision, arg);
+      else if (dir.use_precision)
+        n = snprintf (dest, avail + 1, format, field_precision, arg);
+      else if (dir.use_width)
+        n = snprintf (dest, avail + 1, format, field_width, arg);
+      else
+        n = snprintf (dest, avail + 1, format, arg);
+      if (n < 0)
+        return out.append (format, f - format);
+      if (size_t (n) <= avail)
+        return out.commit (n);
+      avail = n;
+    }
+}
+
+static const char decimal_pairs[] =
+  "00010203040506070809" "10111213141516171819" "20212223242526272829" "30313233343536373839" "40414243444546474849"
+  "50515253545556575859" "60616263646566676869" "70717273747576777879" "80818283848586878889" "90919293949596979899";
+
+// write digits of @a u backwards, ending at @a end, returns start
+static inline char*
+render_decimal (char *end, unsigned long long u)
+{
+  while (u >= 100)
+    {
+      const unsigned d = u % 100;
+      u /= 100;
+      *--end = decimal_pairs[2 * d + 1];
+      *--end = decimal_pairs[2 * d];
+    }
+  if (u >= 10)
+    {
+      *--end = decimal_pairs[2 * u + 1];
+      *--end = decimal_pairs[2 * u];
+    }
+  else
+    *--end = '0' + u;
+  return end;
+}
+
+// pad sign + digits to the field width like printf, zero_padding goes between sign and digits
+static void
+render_padded (FormatBuffer &out, char sign, const char *digits, size_t n_digits, uint32_t width, bool adjust_left, bool zero_padding)
+{
+  const size_t length = n_digits + (sign != 0);
+  const size_t padding = width > length ? width - length : 0;
+  char *dest = out.reserve (length + padding), *d = dest;
+  if (padding && !adjust_left && !zero_padding)
+    d = (char*) memset (d, ' ', padding) + padding;
+  if (sign)
+    *d++ = sign;
+  if (padding && !adjust_left && zero_padding)
+    d = (char*) memset (d, '0', padding) + padding;
+  d = (char*) memcpy (d, digits, n_digits) + n_digits;
+  if (padding && adjust_left)
+    d = (char*) memset (d, ' ', padding) + padding;
+  out.commit (d - dest);
+}
+
+// integer conversions without precision or alternate forms, equivalent to snprintf()
+bool
+StringFormatter::render_integer (FormatBuffer &out, const Directive &dir)
+{
+  if (dir.use_precision || dir.alternate_form || dir.locale_grouping)
+    return false;
+  const FormatArg &farg = format_arg (dir.value_index);
+  unsigned long long mask = ~0ULL;      // truncation according to size modifier
+  switch (farg.kind)
+    {
+    case '1':   mask = 0xff;                    break;
+    case '2':   mask = 0xffff;                  break;
+    case '4':   mask = 0xffffffff;              break;
+    case '6':   mask = sizeof (long) == 4 ? 0xffffffff : ~0ULL; break;
+    }
+  const LLong value = arg_as_longlong (dir.value_index);
+  char buffer[32], *const end = buffer + sizeof (buffer), *digits = end, sign = 0;
+  unsigned long long u = value & mask;
+  switch (dir.conversion)
+    {
+    case 'd': case 'i':
+      if (value < 0)
+        {
+          sign = '-';
+          u = 0ULL - (unsigned long long) value;
+        }
+      else
+        sign = dir.add_sign ? '+' : dir.add_space ? ' ' : 0;
+      digits = render_decimal (end, u);
+      break;
+    case 'u':
+      digits = render_decimal (end, u);
+      break;
+    case 'x': case 'X':
+      {
+        const char *hexdigits = dir.conversion == 'x' ? "0123456789abcdef" : "0123456789ABCDEF";
+        do
+          *--digits = hexdigits[u & 0xf];
+        while (u >>= 4);
+      }
+      break;
+    case 'o':
+      do
+        *--digits = '0' + (u & 7);
+      while (u >>= 3);
+      break;
+    default:
+      return false;
+    }
+  const uint32_t width = !dir.use_width ? 0 : !dir.width_index ? dir.field_width : arg_as_width (dir.width_index);
+  render_padded (out, sign, digits, end - digits, width, adjust_left (dir), dir.zero_padding);
+  return true;
+}
+
+// fixed point conversions with up to 9 digits precision, in the POSIX locale
+bool
+StringFormatter::render_float (FormatBuffer &out, const Directive &dir)
+{
+  if (locale_context_ == CURRENT_LOCALE || dir.alternate_form || dir.locale_grouping ||
+      (dir.use_precision && dir.precision_index) || (dir.use_width && dir.width_index))
+    return false;
+  const FormatArg &farg = format_arg (dir.value_index);
+  if (farg.kind != 'f' || !std::isfinite (farg.f))
+    return false;
+  const uint32_t precision = dir.use_precision ? dir.precision : 6;
+  static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+  if (precision >= ARRAY_SIZE (pow10))
+    return false;
+  // the scaled value is exact to 2^-13, so rounding is decided correctly unless it's close to a tie
+  const double scaled = std::fabs (farg.f) * pow10[precision];
+  if (scaled >= 1099511627776.0) // 2^40
+    return false;
+  const double rounded = std::nearbyint (scaled), fraction = std::fabs (scaled - std::trunc (scaled));
+  if (std::fabs (fraction - 0.5) < 1.0 / 1024)
+    return false;
+  const unsigned long long u = rounded;
+  char buffer[48], *const end = buffer + sizeof (buffer), *digits = end;
+  const unsigned long long multiplier = pow10[precision];
+  if (precision)
+    {
+      digits = render_decimal (end, u % multiplier + multiplier) + 1; // leading 1 preserves zeros
+      *--digits = '.';
+    }
+  digits = render_decimal (digits, u / multiplier);
+  const char sign = std::signbit (farg.f) ? '-' : dir.add_sign ? '+' : dir.add_space ? ' ' : 0;
+  render_padded (out, sign, digits, end - digits, dir.use_width ? dir.field_width : 0, dir.adjust_left, dir.zero_padding);
+  return true;
+}
+
+void
+StringFormatter::render_string (FormatBuffer &out, const Directive &dir)
+{
+  const char *s = arg_as_chars (dir.value_index);
+  const int precision = !dir.use_precision ? -1 : !dir.precision_index ? dir.precision : arg_as_precision (dir.precision_index);
+  const size_t length = precision < 0 ? strlen (s) : strnlen (s, precision);
+  const uint32_t width = !dir.use_width ? 0 : !dir.width_index ? dir.field_width : arg_as_width (dir.width_index);
+  if (width <= length)
+    out.append (s, length);
   else
-    return system_string_printf (format.c_str(), arg);
+    render_padded (out, 0, s, length, width, adjust_left (dir), false);
 }
 
-std::string
-StringFormatter::render_directive (const Directive &dir)
+void
+StringFormatter::render_directive (FormatBuffer &out, const Directive &dir)
 {
   switch (dir.conversion)
     {
     case 'm':
-      return render_arg (dir, "", int (0)); // dummy arg to silence compiler
+      return render_arg (out, dir, "", int (0)); // dummy arg to silence compiler
     case 'p':
-      return render_arg (dir, "", arg_as_ptr (dir.value_index));
+      return render_arg (out, dir, "", arg_as_ptr (dir.value_index));
     case 's': // precision
-      return render_arg (dir, "", arg_as_chars (dir.value_index));
+      return render_string (out, dir);
     case 'c': case 'd': case 'i': case 'o': case 'u': case 'X': case 'x':
+      if (dir.conversion != 'c' && render_integer (out, dir))
+        return;
       switch (format_arg (dir.value_index).kind)
         {
-        case '1':       return render_arg (dir, "hh", format_arg (dir.value_index).i1);
-        case '2':       return render_arg (dir, "h", format_arg (dir.value_index).i2);
-        case '4':       return render_arg (dir, "", format_arg (dir.value_index).i4);
-        case '6':       return render_arg (dir, "l", format_arg (dir.value_index).i6);
-        case '8':       return render_arg (dir, "ll", format_arg (dir.value_index).i8);
-        default:        return render_arg (dir, "ll", arg_as_longlong (dir.value_index));
+        case '1':       return render_arg (out, dir, "hh", format_arg (dir.value_index).i1);
+        case '2':       return render_arg (out, dir, "h", format_arg (dir.value_index).i2);
+        case '4':       return render_arg (out, dir, "", format_arg (dir.value_index).i4);
+        case '6':       return render_arg (out, dir, "l", format_arg (dir.value_index).i6);
+        case '8':       return render_arg (out, dir, "ll", format_arg (dir.value_index).i8);
+        default:        return render_arg (out, dir, "ll", arg_as_longlong (dir.value_index));
         }
     case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+      if (strchr ("fF", dir.conversion) && render_float (out, dir))
+        return;
       switch (format_arg (dir.value_index).kind)
         {
-        case 'f':       return render_arg (dir, "", format_arg (dir.value_index).f);
+        case 'f':       return render_arg (out, dir, "", format_arg (dir.value_index).f);
         case 'd':
-        default:        return render_arg (dir, "L", arg_as_ldouble (dir.value_index));
+        default:        return render_arg (out, dir, "L", arg_as_ldouble (dir.value_index));
         }
     case '%':
-      return "%";
+      return out.append ('%');
     }
-  return std::string ("%") + dir.conversion;
+  out.append ('%');
+  out.append (dir.conversion);
 }
 
 static inline size_t
@@ -339,13 +502,24 @@ upper_directive_count (const char *format)
   return n;
 }
 
-std::string
-StringFormatter::render_format (const size_t last, const char *format)
+struct StringFormatter::ParsedFormat {
+  std::string       format;             // copy to validate cache hits
+  vector<Directive> directives;         // terminated by a Directive without conversion
+  size_t            argmaxref = 0;
+  const char       *error = NULL;
+  size_t            error_directive = 0;
+};
+
+void
+StringFormatter::parse_format (ParsedFormat &parsed, const char *format)
 {
-  assert (last == nargs_);
+  parsed.format = format;
+  parsed.error = NULL;
+  parsed.error_directive = 0;
+  parsed.argmaxref = 0;
   // allocate enough space to hold all directives possibly contained in format
-  const size_t max_dirs = 1 + upper_directive_count (format);
-  Directive fdirs[max_dirs];
+  vector<Directive> &fdirs = parsed.directives;
+  fdirs.resize (1 + upper_directive_count (format));
   // parse format into Directive stack
   size_t nextarg = 1, ndirs = 0;
   const char *p = format;
@@ -363,15 +537,21 @@ StringFormatter::render_format (const size_t last, const char *format)
       const size_t start = p - format;
       const char *err = parse_directive (&p, &nextarg, &fdirs[ndirs]);
       if (err)
-        return format_error (err, format, ndirs + 1);
+        {
+          parsed.error = err;
+          parsed.error_directive = ndirs + 1;
+          return;
+        }
       fdirs[ndirs].start = start;
       fdirs[ndirs].end = p - format;
       ndirs++;
-      assert (ndirs < max_dirs);
+      assert (ndirs < fdirs.size());
     }
   const size_t argcounter = nextarg - 1;
+  fdirs[ndirs] = Directive();
   fdirs[ndirs].end = fdirs[ndirs].start = p - format;
-  // check maximum argument reference and argument count
+  fdirs.resize (ndirs + 1);
+  // determine maximum argument reference
   size_t argmaxref = argcounter;
   for (size_t i = 0; i < ndirs; i++)
     {
@@ -380,43 +560,73 @@ StringFormatter::render_format (const size_t last, const char *format)
       argmaxref = MAX (argmaxref, fdir.width_index);
       argmaxref = MAX (argmaxref, fdir.precision_index);
     }
-  if (argmaxref > last)
-    return format_error ("too few arguments for format", format, 0);
-  if (argmaxref < last)
-    return format_error ("too many arguments for format", format, 0);
+  parsed.argmaxref = argmaxref;
+}
+
+/* Formats are mostly string literals, so parsed formats are cached per thread in a small direct
+ * mapped table, keyed by the format pointer. A copy of the format guards against reuse of the
+ * same pointer for different contents.
+ */
+const StringFormatter::ParsedFormat&
+StringFormatter::cached_format (const char *format)
+{
+  struct CacheEntry { const char *key = NULL; ParsedFormat parsed; };
+  static thread_local CacheEntry format_cache[64];
+  const uintptr_t hash = uintptr_t (format);
+  CacheEntry &entry = format_cache[(hash ^ (hash >> 6) ^ (hash >> 12)) % ARRAY_SIZE (format_cache)];
+  if (entry.key != format || strcmp (entry.parsed.format.c_str(), format) != 0)
+    {
+      parse_format (entry.parsed, format);
+      entry.key = format;
+    }
+  return entry.parsed;
+}
+
+void
+StringFormatter::render_format (FormatBuffer &out, const size_t last, const char *format)
+{
+  assert (last == nargs_);
+  ParsedFormat uncached;
+  if (arg_transform_)           // arg_transform_ may format recursively and evict cache entries
+    parse_format (uncached, format);
+  const ParsedFormat &parsed = arg_transform_ ? uncached : cached_format (format);
+  if (parsed.error)
+    return format_error (out, parsed.error, format, parsed.error_directive);
+  // check maximum argument reference and argument count
+  if (parsed.argmaxref > last)
+    return format_error (out, "too few arguments for format", format, 0);
+  if (parsed.argmaxref < last)
+    return format_error (out, "too many arguments for format", format, 0);
   // format pieces
-  std::string result;
-  p = format;
-  for (size_t i = 0; i <= ndirs; i++)
+  const char *p = format;
+  for (const Directive &fdir : parsed.directives)
     {
-      const Directive &fdir = fdirs[i];
-      result += std::string (p, fdir.start - (p - format));
-      if (fdir.conversion)
+      out.append (p, fdir.start - (p - format));
+      if (fdir.conversion && arg_transform_)
         {
-          String rendered_arg = render_directive (fdir);
-          if (arg_transform_)
-            rendered_arg = arg_transform_ (rendered_arg);
-          result += rendered_arg;
+          StackFormatBuffer<128> rendered_arg;
+          render_directive (rendered_arg, fdir);
+          out.append (arg_transform_ (rendered_arg.string()));
         }
+      else if (fdir.conversion)
+        render_directive (out, fdir);
       p = format + fdir.end;
     }
-  return result;
 }
 
-std::string
-StringFormatter::locale_format (const size_t last, const char *format)
+void
+StringFormatter::locale_format (FormatBuffer &out, const size_t last, const char *format)
 {
-  if (locale_context_ == CURRENT_LOCALE)
-    return render_format (last, format);
-  else
+  render_format (out, last, format);
+  if (saved_locale_)
     {
-      ScopedPosixLocale posix_locale_scope; // pushes POSIX locale for this scope
-      return render_format (last, format);
+      uselocale (saved_locale_); // pushed by render_arg() for the POSIX locale
+      saved_locale_ = NULL;
     }
 }
 
-std::string
-StringFormatter::format_error (const char *err, const char *format, size_t directive)
+void
+StringFormatter::format_error (FormatBuffer &out, const char *err, const char *format, size_t directive)
 {
   const char *cyan = "", *cred = "", *cyel = "", *crst = "";
   if (isatty (fileno (stderr)))
@@ -434,7 +644,36 @@ StringFormatter::format_error (const char *err, const char *format, size_t direc
     fprintf (stderr, "%sStringFormatter: %sWARNING:%s%s %s in directive %zu:%s %s\n", cyan, cred, crst, cyel, err, directive, crst, format);
   else
     fprintf (stderr, "%sStringFormatter: %sWARNING:%s%s %s:%s %s\n", cyan, cred, crst, cyel, err, crst, format);
-  return format;
+  out.append (format, strlen (format));
+}
+
+FormatBuffer::FormatBuffer (char *mem, size_t capacity) :
+  data_ (mem), size_ (0), capacity_ (mem ? capacity : 0), mem_ (mem)
+{
+  if (capacity_)
+    data_[0] = 0;
+}
+
+FormatBuffer::~FormatBuffer ()
+{
+  if (data_ != mem_)
+    free (data_);
+}
+
+void
+FormatBuffer::grow (size_t needed)
+{
+  const size_t capacity = MAX (needed, 2 * capacity_ + 64);
+  char *data = (char*) malloc (capacity);
+  if (!data)
+    throw std::bad_alloc();
+  if (size_)
+    memcpy (data, data_, size_);
+  data[size_] = 0;
+  if (data_ != mem_)
+    free (data_);
+  data_ = data;
+  capacity_ = capacity;
 }
 
 } // Lib
@@ -5,10 +5,51 @@
 #include <rcore/cxxaux.hh>
 #include <rcore/aida.hh>
 #include <sstream>
+#include <cstring>
+#include <locale.h>
 
 namespace Rapicorn {
 namespace Lib { // Namespace for implementation internals
 
+// == FormatBuffer ==
+/// Character buffer for formatted output, starts out in caller provided memory and grows on the heap.
+class FormatBuffer {
+  char       *data_;
+  size_t      size_, capacity_;
+  char *const mem_;
+  void        grow     (size_t needed);
+  RAPICORN_CLASS_NON_COPYABLE (FormatBuffer);
+public:
+  explicit    FormatBuffer (char *mem = NULL, size_t capacity = 0);
+  /*dtor*/   ~FormatBuffer ();
+  /// Provide space for @a n more characters (plus a terminating 0), see commit().
+  char*       reserve  (size_t n)                       { if (size_ + n >= capacity_) grow (size_ + n + 1); return data_ + size_; }
+  /// Append @a n characters previously written into reserve() memory.
+  void        commit   (size_t n)                       { size_ += n; data_[size_] = 0; }
+  void        append   (const char *s, size_t n)        { memcpy (reserve (n), s, n); commit (n); }
+  void        append   (char c, size_t n = 1)           { memset (reserve (n), c, n); commit (n); }
+  void        append   (const std::string &s)           { append (s.data(), s.size()); }
+  void        clear    ()                               { size_ = 0; if (capacity_) data_[0] = 0; }
+  const char* c_str    () const                         { return capacity_ ? data_ : ""; }
+  const char* data     () const                         { return c_str(); }
+  size_t      size     () const                         { return size_; }
+  std::string string   () const                         { return std::string (data(), size_); }
+};
+
+/// FormatBuffer with @a N bytes of stack memory.
+template<size_t N>
+class StackFormatBuffer : public FormatBuffer {
+  char stack_[N];
+public:
+  explicit StackFormatBuffer () : FormatBuffer (stack_, N) {}
+};
+
+// Count arguments that StringFormatter needs to convert into temporary strings.
+template<class... Args> struct FormatTemporaries { static constexpr size_t count = 0; };
+template<class A, class... Args> struct FormatTemporaries<A, Args...> {
+  static constexpr size_t count = (std::is_class<A>::value && !std::is_same<A, std::string>::value) + FormatTemporaries<Args...>::count;
+};
+
 // == StringFormatter ==
 
 /** StringFormatter - sprintf() like string formatting for C++.
@@ -61,8 +102,9 @@ class StringFormatter {
   {
     std::ostringstream os;
     os << arg;
-    temporaries_.push_back (os.str());
-    assign (farg, temporaries_[temporaries_.size()-1]);
+    std::string &temporary = temporaries_[n_temporaries_++];
+    temporary = os.str();
+    assign (farg, temporary);
   }
   const FormatArg& format_arg       (size_t nth);
   uint32_t         arg_as_width     (size_t nth);
@@ -82,32 +124,42 @@ class StringFormatter {
       field_width (0), precision (0), start (0), end (0), value_index (0), width_index (0), precision_index (0)
     {}
   };
+  struct ParsedFormat;
   typedef std::function<String (const String&)> ArgTransform;
   FormatArg          *const fargs_;
   const size_t        nargs_;
   const int           locale_context_;
   const ArgTransform &arg_transform_;
-  vector<std::string> temporaries_;
-  static std::string            format_error     (const char *err, const char *format, size_t directive);
+  std::string        *const temporaries_;
+  size_t              n_temporaries_;
+  locale_t            saved_locale_;    // set once the POSIX locale is pushed for printf fallbacks
+  static void                   format_error     (FormatBuffer &out, const char *err, const char *format, size_t directive);
   static const char*            parse_directive  (const char **stringp, size_t *indexp, Directive *dirp);
-  std::string                   locale_format    (size_t last, const char *format);
-  std::string                   render_format    (size_t last, const char *format);
-  std::string                   render_directive (const Directive &dir);
-  template<class A> std::string render_arg       (const Directive &dir, const char *modifier, A arg);
-  template<size_t N> inline std::string
-  intern_format (const char *format)
+  static void                   parse_format     (ParsedFormat &parsed, const char *format);
+  static const ParsedFormat&    cached_format    (const char *format);
+  void                          locale_format    (FormatBuffer &out, size_t last, const char *format);
+  void                          render_format    (FormatBuffer &out, size_t last, const char *format);
+  bool                          adjust_left      (const Directive &dir);
+  void                          render_directive (FormatBuffer &out, const Directive &dir);
+  bool                          render_integer   (FormatBuffer &out, const Directive &dir);
+  bool                          render_float     (FormatBuffer &out, const Directive &dir);
+  void                          render_string    (FormatBuffer &out, const Directive &dir);
+  template<class A> void        render_arg       (FormatBuffer &out, const Directive &dir, const char *modifier, A arg);
+  template<size_t N> inline void
+  intern_format (FormatBuffer &out, const char *format)
   {
-    return locale_format (N, format);
+    locale_format (out, N, format);
   }
-  template<size_t N, class A, class ...Args> inline std::string
-  intern_format (const char *format, const A &arg, const Args &...args)
+  template<size_t N, class A, class ...Args> inline void
+  intern_format (FormatBuffer &out, const char *format, const A &arg, const Args &...args)
   {
     assign (fargs_[N], arg);
-    return intern_format<N+1> (format, args...);
+    intern_format<N+1> (out, format, args...);
   }
-  template<size_t N> inline constexpr
-  StringFormatter (const ArgTransform &arg_transform, size_t nargs, FormatArg (&mem)[N], int lc) :
-    fargs_ (mem), nargs_ (nargs), locale_context_ (lc), arg_transform_ (arg_transform) {}
+  template<size_t N, size_t T> inline
+  StringFormatter (const ArgTransform &arg_transform, size_t nargs, FormatArg (&mem)[N], std::string (&temporaries)[T], int lc) :
+    fargs_ (mem), nargs_ (nargs), locale_context_ (lc), arg_transform_ (arg_transform),
+    temporaries_ (temporaries), n_temporaries_ (0), saved_locale_ (NULL) {}
 public:
   enum LocaleContext {
     POSIX_LOCALE,
@@ -134,10 +186,24 @@ public:
   static __attribute__ ((__format__ (printf, 2, 0), noinline)) std::string
   format (const ArgTransform &arg_transform, const char *format, const Args &...arguments)
   {
-    constexpr size_t N = sizeof... (Args);
+    StackFormatBuffer<256> buffer;
+    format_to<LC> (buffer, arg_transform, format, arguments...);
+    return buffer.string();
+  }
+  /** Append formatted output to @a buffer, see format().
+   * Parsed format strings are cached per thread, integer, "%s" and "%f" conversions are
+   * rendered without snprintf(). Output only requires heap memory if @a buffer outgrows its
+   * memory or class arguments need conversion via operator<<().
+   */
+  template<LocaleContext LC = POSIX_LOCALE, class ...Args>
+  static __attribute__ ((__format__ (printf, 3, 0))) void
+  format_to (FormatBuffer &buffer, const ArgTransform &arg_transform, const char *format, const Args &...arguments)
+  {
+    constexpr size_t N = sizeof... (Args), T = FormatTemporaries<Args...>::count;
     FormatArg mem[N ? N : 1];
-    StringFormatter formatter (arg_transform, N, mem, LC);
-    return formatter.intern_format<0> (format, arguments...);
+    std::string temporaries[T ? T : 1];
+    StringFormatter formatter (arg_transform, N, mem, temporaries, LC);
+    formatter.intern_format<0> (buffer, format, arguments...);
   }
 };
 
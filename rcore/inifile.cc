@@ -3,7 +3,9 @@
 #include "unicode.hh"
 #include "strings.hh"
 #include "thread.hh"
+#include "randomhash.hh"
 #include <cstring>
+#include <algorithm>
 
 #define ISASCIINLSPACE(c)    (c == ' ' || (c >= 9 && c <= 13))                  // ' \t\n\v\f\r'
 #define ISASCIIWHITESPACE(c) (c == ' ' || c == '\t' || (c >= 11 && c <= 13))    // ' \t\v\f\r'
@@ -265,9 +267,16 @@ parse_section (const char **stringp, size_t *linenop, String *sectionp)
   return true;
 }
 
+static inline uint64
+entry_hash (const char *section, size_t section_size, const char *key, size_t key_size)
+{
+  return pcg_hash64 (key, key_size, byte_hash64 (section, section_size));
+}
+
 void
 IniFile::load_ini (const String &inputname, const String &data)
 {
+  std::map<String, std::vector<std::pair<String,String>>> assignments;
   const char *p = data.c_str();
   size_t nextno = 1;
   String section = "";
@@ -304,7 +313,7 @@ IniFile::load_ini (const String &inputname, const String &data)
           if (strchr (section.c_str(), '=') || strchr (key.c_str(), '.'))
             RAPICORN_DIAG ("%s:%d: invalid key name: %s.%s", inputname.c_str(), lineno, section.c_str(), k.c_str());
           else
-            sections_[section].push_back (k + "=" + text);
+            assignments[section].push_back (std::make_pair (k, text));
         }
       else if (skip_line (&p, &nextno, debugp))
         {
@@ -314,6 +323,48 @@ IniFile::load_ini (const String &inputname, const String &data)
       else
         break; // EOF if !skip_line
     }
+  // index sections by name and entries by (section, key[locale]), values are cooked once here
+  text_.clear();
+  sections_.clear();
+  entries_.clear();
+  for (const auto &sit : assignments)
+    {
+      const Section section { uint32 (text_.size()), uint32 (sit.first.size()), uint32 (entries_.size()), uint32 (sit.second.size()) };
+      text_ += sit.first;
+      for (const auto &kv : sit.second)
+        {
+          const String cooked = cook_string (kv.second);
+          Entry e;
+          e.section = sections_.size();
+          e.key = text_.size();
+          e.key_size = kv.first.size();
+          text_ += kv.first;
+          e.raw = text_.size();
+          e.raw_size = kv.second.size();
+          text_ += kv.second;
+          e.value = text_.size();
+          e.value_size = cooked.size();
+          text_ += cooked;
+          entries_.push_back (e);
+        }
+      sections_.push_back (section);
+    }
+  size_t n_buckets = 8;
+  while (n_buckets < 2 * entries_.size())
+    n_buckets *= 2;
+  buckets_.assign (n_buckets, 0);
+  for (size_t i = 0; i < entries_.size(); i++)
+    {
+      const Entry &e = entries_[i];
+      const Section &section = sections_[e.section];
+      const char *const sname = text_.data() + section.name, *const key = text_.data() + e.key;
+      if (find_entry (sname, section.name_size, key, e.key_size))
+        continue;       // duplicate key, the first definition wins
+      size_t j = entry_hash (sname, section.name_size, key, e.key_size) & (n_buckets - 1);
+      while (buckets_[j])
+        j = (j + 1) & (n_buckets - 1);
+      buckets_[j] = i + 1;
+    }
 }
 
 IniFile::IniFile (const String &name, const String &inidata)
@@ -339,43 +390,73 @@ IniFile::IniFile (const IniFile &source)
 IniFile&
 IniFile::operator= (const IniFile &source)
 {
-  sections_  = source.sections_;
+  text_ = source.text_;
+  sections_ = source.sections_;
+  entries_ = source.entries_;
+  buckets_ = source.buckets_;
   return *this;
 }
 
-bool
-IniFile::has_sections () const
+const IniFile::Section*
+IniFile::find_section (const char *name, size_t name_size) const
 {
-  return !sections_.empty();
+  // sections_ is sorted like std::string::compare()
+  auto cmp = [this] (const Section &section, const std::pair<const char*,size_t> &key) {
+    const int c = memcmp (text_.data() + section.name, key.first, std::min (size_t (section.name_size), key.second));
+    return c < 0 || (c == 0 && section.name_size < key.second);
+  };
+  const auto key = std::make_pair (name, name_size);
+  auto it = std::lower_bound (sections_.begin(), sections_.end(), key, cmp);
+  if (it != sections_.end() && it->name_size == name_size && memcmp (text_.data() + it->name, name, name_size) == 0)
+    return &*it;
+  return NULL;
 }
 
-const StringVector&
-IniFile::section (const String &name) const
+const IniFile::Entry*
+IniFile::find_entry (const char *section, size_t section_size, const char *key, size_t key_size) const
 {
-  SectionMap::const_iterator cit = sections_.find (name);
-  if (cit != sections_.end())
-    return cit->second;
-  static const StringVector *dummy = NULL;
-  do_once {
-    static uint64 space[(sizeof (StringVector) + 7) / 8];
-    dummy = new (space) StringVector();
-  }
-  return *dummy;
+  if (buckets_.empty())
+    return NULL;
+  const size_t mask = buckets_.size() - 1;
+  for (size_t i = entry_hash (section, section_size, key, key_size) & mask; buckets_[i]; i = (i + 1) & mask)
+    {
+      const Entry &e = entries_[buckets_[i] - 1];
+      const Section &s = sections_[e.section];
+      if (e.key_size == key_size && s.name_size == section_size &&
+          memcmp (text_.data() + e.key, key, key_size) == 0 &&
+          memcmp (text_.data() + s.name, section, section_size) == 0)
+        return &e;
+    }
+  return NULL;
+}
+
+const IniFile::Entry*
+IniFile::find_dotpath (const String &dotpath) const
+{
+  const char *p = dotpath.c_str(), *d = strrchr (p, '.');
+  if (!d)
+    return NULL;
+  return find_entry (p, d - p, d + 1, dotpath.size() - (d + 1 - p));
+}
+
+bool
+IniFile::has_sections () const
+{
+  return !sections_.empty();
 }
 
 bool
 IniFile::has_section (const String &section) const
 {
-  SectionMap::const_iterator cit = sections_.find (section);
-  return cit != sections_.end();
+  return find_section (section.data(), section.size()) != NULL;
 }
 
 StringVector
 IniFile::sections () const
 {
   StringVector secs;
-  for (auto it : sections_)
-    secs.push_back (it.first);
+  for (const Section &section : sections_)
+    secs.push_back (String (text_.data() + section.name, section.name_size));
   return secs;
 }
 
@@ -383,63 +464,47 @@ StringVector
 IniFile::attributes (const String &section) const
 {
   StringVector opts;
-  SectionMap::const_iterator cit = sections_.find (section);
-  if (cit != sections_.end())
-    for (auto s : cit->second)
-      opts.push_back (s.substr (0, s.find ('=')));
+  const Section *s = find_section (section.data(), section.size());
+  if (s)
+    for (size_t i = s->first; i < s->first + s->count; i++)
+      opts.push_back (String (text_.data() + entries_[i].key, entries_[i].key_size));
   return opts;
 }
 
 bool
 IniFile::has_attribute (const String &section, const String &key) const
 {
-  SectionMap::const_iterator cit = sections_.find (section);
-  if (cit == sections_.end())
-    return false;
-  for (auto s : cit->second)
-    if (s.size() > key.size() && s[key.size()] == '=' && memcmp (s.data(), key.data(), key.size()) == 0)
-      return true;
-  return false;
+  return find_entry (section.data(), section.size(), key.data(), key.size()) != NULL;
 }
 
 StringVector
 IniFile::raw_values () const
 {
   StringVector opts;
-  for (auto it : sections_)
-    for (auto s : it.second)
-      opts.push_back (it.first + "." + s);
+  for (const Entry &e : entries_)
+    {
+      const Section &section = sections_[e.section];
+      opts.push_back (String (text_.data() + section.name, section.name_size) + "." +
+                      String (text_.data() + e.key, e.key_size) + "=" +
+                      String (text_.data() + e.raw, e.raw_size));
+    }
   return opts;
 }
 
 bool
 IniFile::has_raw_value (const String &dotpath, String *valuep) const
 {
-  const char *p = dotpath.c_str(), *d = strrchr (p, '.');
-  if (!d)
-    return false;
-  const String secname = String (p, d - p);
-  d++; // point to key
-  const StringVector &sv = section (secname);
-  if (!sv.size())
-    return false;
-  const size_t l = dotpath.size() - (d - p); // key length
-  for (auto kv : sv)
-    if (kv.size() > l && kv[l] == '=' && memcmp (kv.data(), d, l) == 0)
-      {
-        if (valuep)
-          *valuep = kv.substr (l + 1);
-        return true;
-      }
-  return false;
+  const Entry *e = find_dotpath (dotpath);
+  if (e && valuep)
+    valuep->assign (text_.data() + e->raw, e->raw_size);
+  return e != NULL;
 }
 
 String
 IniFile::raw_value (const String &dotpath) const
 {
-  String v;
-  has_raw_value (dotpath, &v);
-  return v;
+  const Entry *e = find_dotpath (dotpath);
+  return e ? String (text_.data() + e->raw, e->raw_size) : String();
 }
 
 String
@@ -484,18 +549,17 @@ IniFile::cook_string (const String &input)
 bool
 IniFile::has_value (const String &dotpath, String *valuep) const
 {
-  const bool hasit = has_raw_value (dotpath, valuep);
-  if (valuep && hasit)
-    *valuep = cook_string (*valuep);
-  return hasit;
+  const Entry *e = find_dotpath (dotpath);
+  if (e && valuep)
+    valuep->assign (text_.data() + e->value, e->value_size);
+  return e != NULL;
 }
 
 String
 IniFile::value_as_string (const String &dotpath) const
 {
-  String raw = raw_value (dotpath);
-  String v = cook_string (raw);
-  return v;
+  const Entry *e = find_dotpath (dotpath);
+  return e ? String (text_.data() + e->value, e->value_size) : String();
 }
 
 
@@ -9,13 +9,25 @@ namespace Rapicorn {
 // == IniFile ==
 /// Class to parse INI configuration file sections and values.
 class IniFile {
-  typedef std::map<String,StringVector> SectionMap;
-  SectionMap                    sections_;
+  struct Section {
+    uint32      name, name_size, first, count;      // name offset into text_, entries_ range
+  };
+  struct Entry {
+    uint32      section;                            // index into sections_
+    uint32      key, key_size;                      // "key[locale]" offset into text_
+    uint32      raw, raw_size, value, value_size;   // uncooked and cooked value offsets into text_
+  };
+  String                text_;          // section names, keys and values, referenced by offsets
+  std::vector<Section>  sections_;      // sorted by name
+  std::vector<Entry>    entries_;       // grouped by section, in file order
+  std::vector<uint32>   buckets_;       // open addressing hash table of entries_ indices + 1
   void          load_ini        (const String &inputname, const String &data);
   //bool        set             (const String &section, const String &key, const String &value, const String &locale = "");
   //bool        del             (const String &section, const String &key, const String &locale = "*");
   //bool        value           (const String &dotpath, const String &value);
-  const StringVector& section   (const String &name) const;
+  const Section* find_section   (const char *name, size_t name_size) const;
+  const Entry*  find_entry      (const char *section, size_t section_size, const char *key, size_t key_size) const;
+  const Entry*  find_dotpath    (const String &dotpath) const;
 public:
   explicit      IniFile         (const String &name, const String &inidata); ///< Load INI file from immediate @a data.
   explicit      IniFile         (Blob blob);                    ///< Load INI file from Blob.
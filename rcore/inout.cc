@@ -10,6 +10,8 @@
 #include <sys/types.h>
 #include <fcntl.h>
 #include <cstring>
+#include <algorithm>
+#include <unordered_map>
 
 static constexpr int UNCHECKED = -1;    // undetermined bool option
 
@@ -517,6 +519,487 @@ FlipperOption::flipper_check (const char *key, bool vdefault)
 }
 #endif // !DOXYGEN
 
+// == Binary Tracing ==
+bool volatile _rapicorn_trace_check_cache = true; // initially enable tracing
+
+enum : size_t {
+  TRACE_RING_SIZE       = 64 * 1024,    // per thread record buffer
+  TRACE_RECORD_MAX      = 1024,         // maximum event record size, strings are truncated to fit
+  TRACE_CHUNK_HEADER    = 8,            // uint32 length, uint32 type
+  TRACE_EVENT_HEADER    = 24,           // chunk header, uint32 site, uint32 tid, uint64 stamp
+  TRACE_FILE_HEADER     = 16,           // magic, uint32 version, uint32 byte order
+};
+static const char   trace_magic[8] = { 'R', 'A', 'P', 'T', 'R', 'A', 'C', 'E' };
+static const uint32 TRACE_VERSION = 1, TRACE_BYTE_ORDER = 0x01020304;
+
+/* Each thread appends complete records to its own single producer single consumer ring and
+ * publishes them by advancing head. Consumers are serialized by drain_mutex, they copy out
+ * everything up to head and release the space by advancing tail. Records that don't fit are
+ * counted as dropped, so the recording thread never blocks or allocates.
+ */
+struct TraceRing {
+  std::atomic<uint64> head, tail, dropped;
+  std::atomic<bool>   retired;          // owning thread exited
+  uint32              tid;
+  uint64              dropped_reported; // consumer side
+  char                data[TRACE_RING_SIZE];
+  explicit TraceRing (uint32 t) : head (0), tail (0), dropped (0), retired (false), tid (t), dropped_reported (0) {}
+  void
+  push (const char *record, size_t length)
+  {
+    const uint64 h = head.load (std::memory_order_relaxed);
+    if (h + length - tail.load (std::memory_order_acquire) > TRACE_RING_SIZE)
+      {
+        dropped.fetch_add (1, std::memory_order_relaxed);
+        return;
+      }
+    const size_t offset = h % TRACE_RING_SIZE, first = min (length, TRACE_RING_SIZE - offset);
+    memcpy (data + offset, record, first);
+    memcpy (data, record + first, length - first);
+    head.store (h + length, std::memory_order_release);
+  }
+  void
+  pop (String &out)
+  {
+    const uint64 t = tail.load (std::memory_order_relaxed), h = head.load (std::memory_order_acquire);
+    const size_t length = h - t, offset = t % TRACE_RING_SIZE, first = min (length, TRACE_RING_SIZE - offset);
+    out.append (data + offset, first);
+    out.append (data, length - first);
+    tail.store (h, std::memory_order_release);
+  }
+  RAPICORN_CLASS_NON_COPYABLE (TraceRing);
+};
+
+struct TraceRegistry {
+  Mutex              mutex;             // guards sites, rings, flushing
+  vector<TraceSite*> sites;
+  vector<TraceRing*> rings;
+  bool               flushing;
+  Mutex              drain_mutex;       // serializes ring consumers
+  int                trace_fd;          // from RAPICORN_TRACE=tracefile=...
+  size_t             trace_fd_sites;    // number of sites written to trace_fd
+  TraceRegistry() : flushing (false), trace_fd (-1), trace_fd_sites (0) {}
+  RAPICORN_CLASS_NON_COPYABLE (TraceRegistry);
+};
+static DurableInstance<TraceRegistry> trace_registry;
+
+struct TraceRingHolder {
+  TraceRing *ring = NULL;
+  ~TraceRingHolder()
+  {
+    if (ring)
+      ring->retired.store (true, std::memory_order_release);
+    ring = NULL;
+  }
+};
+static thread_local TraceRingHolder trace_ring_holder;
+
+static TraceRing*
+trace_thread_ring ()
+{
+  TraceRing *ring = trace_ring_holder.ring;
+  if (RAPICORN_UNLIKELY (!ring))
+    {
+      const uint32 tid = ThisThread::thread_pid();
+      ScopedLock<Mutex> locker (trace_registry->mutex);
+      for (TraceRing *r : trace_registry->rings)        // recycle empty rings of exited threads
+        if (r->retired.load (std::memory_order_acquire) &&
+            r->head.load (std::memory_order_relaxed) == r->tail.load (std::memory_order_acquire) &&
+            r->dropped.load (std::memory_order_relaxed) == 0)
+          {
+            ring = r;
+            ring->tid = tid;
+            ring->retired.store (false, std::memory_order_relaxed);
+            break;
+          }
+      if (!ring)
+        {
+          ring = new TraceRing (tid);
+          trace_registry->rings.push_back (ring);
+        }
+      trace_ring_holder.ring = ring;
+    }
+  return ring;
+}
+
+template<class T> static inline void
+trace_get (const char *data, T *value)
+{
+  memcpy (value, data, sizeof (*value));
+}
+
+template<class T> static inline void
+trace_put (String &out, const T &value)
+{
+  out.append ((const char*) &value, sizeof (value));
+}
+
+static String
+trace_file_header ()
+{
+  String out (trace_magic, sizeof (trace_magic));
+  trace_put (out, TRACE_VERSION);
+  trace_put (out, TRACE_BYTE_ORDER);
+  return out;
+}
+
+// collect pending records of all threads, preceeded by the sites registered after *n_sites, drain_mutex must be held
+static String
+trace_drain (size_t *n_sites)
+{
+  String events, out;
+  vector<TraceRing*> rings;
+  {
+    ScopedLock<Mutex> locker (trace_registry->mutex);
+    rings = trace_registry->rings;
+  }
+  for (TraceRing *ring : rings)
+    {
+      const bool retired = ring->retired.load (std::memory_order_acquire);
+      ring->pop (events);
+      const uint64 dropped = ring->dropped.load (std::memory_order_relaxed);
+      if (dropped != ring->dropped_reported)
+        {
+          trace_put (events, uint32 (TRACE_EVENT_HEADER));
+          trace_put (events, uint32 ('D'));
+          trace_put (events, uint32 (0));
+          trace_put (events, uint32 (ring->tid));
+          trace_put (events, dropped - ring->dropped_reported);
+          ring->dropped_reported = dropped;
+        }
+      if (retired)
+        {
+          ScopedLock<Mutex> locker (trace_registry->mutex);
+          vector<TraceRing*> &all = trace_registry->rings;
+          if (ring->retired.load (std::memory_order_relaxed) && // not recycled meanwhile
+              ring->head.load (std::memory_order_relaxed) == ring->tail.load (std::memory_order_relaxed))
+            {
+              all.erase (std::find (all.begin(), all.end(), ring));
+              delete ring;
+            }
+        }
+    }
+  ScopedLock<Mutex> locker (trace_registry->mutex); // sites are registered before records refer to them
+  for (; *n_sites < trace_registry->sites.size(); *n_sites += 1)
+    {
+      const TraceSite &site = *trace_registry->sites[*n_sites];
+      const size_t start = out.size();
+      trace_put (out, uint32 (0));
+      trace_put (out, uint32 ('S'));
+      trace_put (out, uint32 (site.id));
+      trace_put (out, int32 (site.line));
+      for (const char *s : { site.key, site.file, site.format })
+        out.append (s, strlen (s) + 1);
+      const uint32 length = out.size() - start;
+      memcpy (&out[start], &length, sizeof (length));
+    }
+  return out + events;
+}
+
+static bool
+trace_write (int fd, const String &data)
+{
+  size_t n = 0;
+  while (n < data.size())
+    {
+      const ssize_t l = write (fd, data.data() + n, data.size() - n);
+      if (l < 0 && (errno == EINTR || errno == EAGAIN))
+        continue;
+      if (l <= 0)
+        return false;
+      n += l;
+    }
+  return true;
+}
+
+/** Write pending trace records to the file configured via #$RAPICORN_TRACE.
+ * This is called periodically from a background thread once the first trace site is enabled,
+ * and at program exit.
+ */
+void
+trace_flush ()
+{
+  ScopedLock<Mutex> locker (trace_registry->drain_mutex);
+  if (trace_registry->trace_fd >= 0)
+    trace_write (trace_registry->trace_fd, trace_drain (&trace_registry->trace_fd_sites));
+}
+
+/** Write all pending trace records to @a fd.
+ * The output is self contained and can be converted into text with trace_decode() or the rapidtrace tool.
+ * Records that were already written by trace_flush() are not included.
+ */
+bool
+trace_dump (int fd)
+{
+  ScopedLock<Mutex> locker (trace_registry->drain_mutex);
+  size_t n_sites = 0;
+  return trace_write (fd, trace_file_header() + trace_drain (&n_sites));
+}
+
+static void
+trace_start_flushing ()
+{
+  const char *val = getenv ("RAPICORN_TRACE");
+  const int l = max (size_t (64), strlen (val ? val : "") + 1);
+  char path[l];
+  if (!val || cstring_option_sense (val, "tracefile", path) < 0)
+    return;             // records are kept until trace_dump()
+  const int fd = open (Path::abspath (path).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_NOCTTY | O_CLOEXEC, 0666);
+  if (fd < 0 || !trace_write (fd, trace_file_header()))
+    {
+      debug_handler ('G', "", string_format ("failed to open trace file \"%s\": %s", (const char*) path, strerror (errno)));
+      if (fd >= 0)
+        close (fd);
+      return;
+    }
+  {
+    ScopedLock<Mutex> locker (trace_registry->drain_mutex);
+    trace_registry->trace_fd = fd;
+  }
+  std::thread ([] () {
+      for (;;)
+        {
+          ThisThread::sleep_for (std::chrono::milliseconds (100));
+          trace_flush();
+        }
+    }).detach();
+  atexit (trace_flush);
+}
+
+/// Enable tracing for @a site if #$RAPICORN_TRACE contains its key, the first call per site decides.
+bool
+trace_site_register (TraceSite &site, const char *format)
+{
+  const bool enabled = envkey_flipper_check ("RAPICORN_TRACE", site.key, false, &_rapicorn_trace_check_cache);
+  bool start_flushing = false;
+  {
+    ScopedLock<Mutex> locker (trace_registry->mutex);
+    if (site.id == 0)
+      {
+        site.format = format ? format : "";
+        if (enabled)
+          {
+            trace_registry->sites.push_back (&site);
+            __atomic_store_n (&site.id, int (trace_registry->sites.size()), __ATOMIC_RELEASE);
+            start_flushing = !trace_registry->flushing;
+            trace_registry->flushing = true;
+          }
+        else
+          __atomic_store_n (&site.id, -1, __ATOMIC_RELEASE);
+      }
+  }
+  if (start_flushing)
+    trace_start_flushing();
+  return site.id > 0;
+}
+
+/// Append a binary event record for @a site to the ring buffer of the calling thread.
+void
+trace_record (const TraceSite &site, size_t nargs, const TraceArg *args)
+{
+  TraceRing *ring = trace_thread_ring();
+  char record[TRACE_RECORD_MAX];
+  size_t n = 0;
+  auto put = [&] (const void *data, size_t length) {
+    memcpy (record + n, data, length);
+    n += length;
+  };
+  const uint32 type = 'E', id = site.id, tid = ring->tid;
+  const uint64 stamp = timestamp_realtime();
+  n = 4;        // length is filled in last
+  put (&type, 4);
+  put (&id, 4);
+  put (&tid, 4);
+  put (&stamp, 8);
+  for (size_t i = 0; i < nargs && n + 10 <= TRACE_RECORD_MAX; i++)
+    {
+      const TraceArg &arg = args[i];
+      record[n++] = arg.kind;
+      record[n++] = arg.size;
+      if (arg.kind == 's')
+        {
+          const size_t reserved = 10 * (nargs - i - 1);         // space for the remaining arguments
+          const uint32 length = min (size_t (arg.length), TRACE_RECORD_MAX - min (size_t (TRACE_RECORD_MAX), n + 4 + reserved));
+          put (&length, 4);
+          put (arg.s, length);
+        }
+      else
+        put (&arg.u, 8);
+    }
+  const uint32 length = n;
+  memcpy (record, &length, 4);
+  ring->push (record, n);
+}
+
+static String
+trace_render (const char *directive, const TraceArg &arg)
+{
+  switch (arg.kind)
+    {
+    case 'i':
+      switch (arg.size)
+        {
+        case 1:         return string_format (directive, (signed char) arg.i);
+        case 2:         return string_format (directive, short (arg.i));
+        case 4:         return string_format (directive, int (arg.i));
+        default:        return string_format (directive, arg.i);
+        }
+    case 'u':
+      switch (arg.size)
+        {
+        case 1:         return string_format (directive, (unsigned char) arg.u);
+        case 2:         return string_format (directive, (unsigned short) arg.u);
+        case 4:         return string_format (directive, uint (arg.u));
+        default:        return string_format (directive, arg.u);
+        }
+    case 'f':           return string_format (directive, arg.f);
+    case 'p':           return string_format (directive, (void*) uintptr_t (arg.u));
+    case 's':           return string_format (directive, String (arg.s, arg.length));
+    default:            return directive;
+    }
+}
+
+// replay a format string with recorded arguments, one directive at a time
+static String
+trace_format (const char *format, const vector<TraceArg> &args)
+{
+  String out;
+  size_t nth = 0;
+  for (const char *p = format; *p; p++)
+    if (p[0] != '%')
+      out += p[0];
+    else if (p[1] == '%')
+      out += *++p;
+    else
+      {
+        const size_t l = 1 + strspn (p + 1, "-+ #0'123456789.$*hlLqjztZ");
+        const String directive (p, l + (p[l] != 0));
+        p += directive.size() - 1;
+        if (!strchr ("spcCdiouXxFfGgEeAa", directive.back()))
+          out += directive;                                     // includes %m
+        else if (nth >= args.size())
+          out += directive;                                     // argument missing or truncated
+        else if (directive.find_first_of ("$*") != String::npos)
+          out += trace_render ("%s", args[nth++]);              // positional arguments are not replayed
+        else
+          out += trace_render (directive.c_str(), args[nth++]);
+      }
+  return out;
+}
+
+/** Decode trace records written by trace_dump() or trace_flush().
+ * Calls @a handler for each event in @a data, returns false and sets @a errorp for invalid data.
+ */
+bool
+trace_decode (const String &data, const std::function<void (const TraceEvent&)> &handler, String *errorp)
+{
+  struct Site { const char *key, *file, *format; int line; };
+  std::unordered_map<uint32, Site> sites;
+  const char *const start = data.data(), *const end = start + data.size();
+  const char *p = start;
+  auto error = [&] (const char *message) {
+    if (errorp)
+      *errorp = string_format ("offset %u: %s", p - start, message);
+    return false;
+  };
+  if (size_t (end - p) < TRACE_FILE_HEADER || memcmp (p, trace_magic, sizeof (trace_magic)) != 0)
+    return error ("missing trace header");
+  vector<TraceArg> args;
+  while (p < end)
+    {
+      if (size_t (end - p) >= TRACE_FILE_HEADER && memcmp (p, trace_magic, sizeof (trace_magic)) == 0)
+        {
+          uint32 version, byte_order;
+          trace_get (p + 8, &version);
+          trace_get (p + 12, &byte_order);
+          if (byte_order != TRACE_BYTE_ORDER)
+            return error ("unsupported byte order");
+          if (version != TRACE_VERSION)
+            return error ("unsupported trace version");
+          p += TRACE_FILE_HEADER;
+          continue;
+        }
+      uint32 length, type;
+      if (size_t (end - p) < TRACE_CHUNK_HEADER)
+        return error ("truncated record");
+      trace_get (p, &length);
+      trace_get (p + 4, &type);
+      if (length < TRACE_CHUNK_HEADER || length > size_t (end - p))
+        return error ("invalid record length");
+      const char *const cend = p + length;
+      if (type == 'S')
+        {
+          uint32 id;
+          Site site;
+          if (length < 16 + 3 || cend[-1] != 0)
+            return error ("invalid site record");
+          trace_get (p + 8, &id);
+          trace_get (p + 12, &site.line);
+          site.key = p + 16;
+          site.file = site.key + strlen (site.key) + 1;
+          site.format = site.file < cend ? site.file + strlen (site.file) + 1 : cend;
+          if (site.format >= cend)
+            return error ("invalid site record");
+          sites[id] = site;
+        }
+      else if (type == 'E' || type == 'D')
+        {
+          if (length < TRACE_EVENT_HEADER)
+            return error ("invalid event record");
+          uint32 id, tid;
+          TraceEvent event;
+          trace_get (p + 8, &id);
+          trace_get (p + 12, &tid);
+          trace_get (p + 16, &event.stamp);
+          event.tid = tid;
+          event.key = event.file = NULL;
+          event.line = 0;
+          event.dropped = 0;
+          if (type == 'D')
+            event.dropped = event.stamp, event.stamp = 0;
+          else
+            {
+              auto it = sites.find (id);
+              if (it == sites.end())
+                return error ("event refers to unknown site");
+              args.clear();
+              for (const char *a = p + TRACE_EVENT_HEADER; a < cend;)
+                {
+                  TraceArg arg;
+                  if (cend - a < 6)
+                    return error ("invalid event argument");
+                  arg.kind = a[0];
+                  arg.size = a[1];
+                  a += 2;
+                  if (arg.kind == 's')
+                    {
+                      trace_get (a, &arg.length);
+                      arg.s = a + 4;
+                      a += 4 + size_t (arg.length);
+                    }
+                  else if (cend - a >= 8)
+                    {
+                      trace_get (a, &arg.u);
+                      a += 8;
+                    }
+                  else
+                    a = cend + 1;
+                  if (a > cend)
+                    return error ("invalid event argument");
+                  args.push_back (arg);
+                }
+              event.key = it->second.key;
+              event.file = it->second.file;
+              event.line = it->second.line;
+              event.message = trace_format (it->second.format, args);
+            }
+          handler (event);
+        }
+      p = cend;         // skip unknown records
+    }
+  return true;
+}
+
 /** @def RAPICORN_DEBUG_OPTION(key, blurb)
  * Create a Rapicorn::DebugOption object that can be used to query, cache and document debugging options.
  * When converted to bool, it is checked if #$RAPICORN_DEBUG enables or disables the debugging option @a key.
@@ -591,6 +1074,8 @@ FlipperOption::flipper_check (const char *key, bool vdefault)
  * @def RAPICORN_KEY_DEBUG(key, format,...)
  * Issues a debugging message if #$RAPICORN_DEBUG contains the literal @a "key" or "all".
  * The message @a format uses printf-like syntax.
+ * If #$RAPICORN_TRACE contains @a "key" or "all", a binary trace record is kept in addition,
+ * see trace_dump(). Tracing postpones formatting, so @a format must be a string literal.
  */
 
 // == AnsiColors ==
@@ -45,7 +45,7 @@ bool   debug_devel_check ();
 // == Debugging Macros ==
 #define RAPICORN_FLIPPER(key, blurb,...)  Rapicorn::FlipperOption (key, bool (__VA_ARGS__))
 #define RAPICORN_DEBUG_OPTION(key, blurb) Rapicorn::DebugOption (key)
-#define RAPICORN_KEY_DEBUG(key,...)       do { if (RAPICORN_UNLIKELY (Rapicorn::_rapicorn_debug_check_cache)) Rapicorn::rapicorn_debug (key, RAPICORN_PRETTY_FILE, __LINE__, Rapicorn::string_format (__VA_ARGS__)); } while (0)
+#define RAPICORN_KEY_DEBUG(key,...)       RAPICORN_KEY_DEBUG_decl (key, _rapicorn_trace_site_, __VA_ARGS__)
 #define RAPICORN_FATAL(...)               do { Rapicorn::debug_fmessage (RAPICORN_PRETTY_FILE, __LINE__, Rapicorn::string_format (__VA_ARGS__)); } while (0)
 #define RAPICORN_ASSERT(cond)             do { if (RAPICORN_LIKELY (cond)) break; Rapicorn::debug_fassert (RAPICORN_PRETTY_FILE, __LINE__, #cond); } while (0)
 #define RAPICORN_ASSERT_RETURN(cond, ...) do { if (RAPICORN_LIKELY (cond)) break; Rapicorn::debug_assert (RAPICORN_PRETTY_FILE, __LINE__, #cond); return __VA_ARGS__; } while (0)
@@ -59,6 +59,21 @@ bool   debug_devel_check ();
 void rapicorn_debug         (const char *key, const char *file, int line, const String &msg);
 bool rapicorn_debug_check   (const char *key = NULL);
 
+// == Binary Tracing ==
+/// Trace record as decoded by trace_decode().
+struct TraceEvent {
+  uint64      stamp;    ///< Recording time in µseconds, see timestamp_realtime().
+  int         tid;      ///< Thread ID of the recording thread.
+  const char *key;      ///< Debugging key of RAPICORN_KEY_DEBUG().
+  const char *file;     ///< Source file of the recording site.
+  int         line;     ///< Source line of the recording site.
+  uint64      dropped;  ///< Number of records lost for @a tid due to buffer overruns (for events without @a key).
+  String      message;  ///< Formatted message.
+};
+bool trace_dump     (int fd);
+void trace_flush    ();
+bool trace_decode   (const String &data, const std::function<void (const TraceEvent&)> &handler, String *errorp = NULL);
+
 // == AnsiColors ==
 /// The AnsiColors namespace contains utility functions for colored terminal output
 namespace AnsiColors {
@@ -115,12 +130,105 @@ private:
 };
 
 #define RAPICORN_STARTUP_ASSERT_decl(e, _N)     namespace { static struct _N { inline _N() { RAPICORN_ASSERT (e); } } _N; }
+#define RAPICORN_KEY_DEBUG_decl(key, _S, ...)   do { if (RAPICORN_UNLIKELY (Rapicorn::_rapicorn_debug_check_cache || Rapicorn::_rapicorn_trace_check_cache)) { \
+      static Rapicorn::TraceSite _S (key, RAPICORN_PRETTY_FILE, __LINE__); Rapicorn::rapicorn_key_debug (_S, __VA_ARGS__); } } while (0)
 
 #ifdef __RAPICORN_BUILD__
 #define RAPICORN_STARTUP_DEBUG(...)             RAPICORN_KEY_DEBUG ("StartUp", __VA_ARGS__)
 #endif
 
 extern bool volatile _rapicorn_debug_check_cache; ///< Caching flag to inhibit useless rapicorn_debug() calls.
+extern bool volatile _rapicorn_trace_check_cache; ///< Caching flag to inhibit useless trace_record() calls.
+
+struct TraceSite {
+  const char *const key, *const file;
+  const int         line;
+  const char       *format;
+  int               id;         // 0: unregistered, < 0: not traced
+  constexpr TraceSite (const char *k, const char *f, int l) : key (k), file (f), line (l), format (NULL), id (0) {}
+};
+
+struct TraceArg {
+  union { long long i; unsigned long long u; double f; const void *p; const char *s; };
+  uint32 length;        // string length
+  char   kind, size;    // i u f p s, sizeof original argument, 0 for strings
+};
+
+class TraceArgs {
+  TraceArg *const args_;
+  const size_t    nargs_;
+  vector<String>  temporaries_;
+  template<class T> void
+  assign_int (TraceArg &targ, T arg)
+  {
+    targ.size = sizeof (T);
+    if (T (-1) < T (0))
+      { targ.kind = 'i'; targ.i = arg; }
+    else
+      { targ.kind = 'u'; targ.u = arg; }
+  }
+  inline void assign (TraceArg &targ, const char        *arg) { targ.kind = 's'; targ.size = 0; targ.s = arg ? arg : "(null)"; targ.length = strlen (targ.s); }
+  inline void assign (TraceArg &targ, char              *arg) { assign (targ, (const char*) arg); }
+  inline void assign (TraceArg &targ, const std::string &arg) { targ.kind = 's'; targ.size = 0; targ.s = arg.data(); targ.length = arg.size(); }
+  inline void assign (TraceArg &targ, const void        *arg) { targ.kind = 'p'; targ.size = sizeof (arg); targ.p = arg; }
+  template<class T> inline void assign (TraceArg &targ, T *const &arg) { assign (targ, (const void*) arg); }
+  template<class T> typename std::enable_if<std::is_integral<T>::value, void>       // eliminated via SFINAE
+  ::type      assign (TraceArg &targ, const T &arg) { assign_int (targ, arg); }
+  template<class T> typename std::enable_if<std::is_floating_point<T>::value, void> // eliminated via SFINAE
+  ::type      assign (TraceArg &targ, const T &arg) { targ.kind = 'f'; targ.size = sizeof (double); targ.f = arg; }
+  template<class T> typename std::enable_if<std::is_enum<T>::value, void>           // eliminated via SFINAE
+  ::type      assign (TraceArg &targ, const T &arg) { targ.kind = 'i'; targ.size = sizeof (long long); targ.i = (long long) arg; }
+  template<class T> typename std::enable_if<std::is_class<T>::value, void>          // eliminated via SFINAE
+  ::type      assign (TraceArg &targ, const T &arg)
+  {
+    std::ostringstream os;
+    os << arg;
+    temporaries_.reserve (nargs_); // keep temporaries in place
+    temporaries_.push_back (os.str());
+    assign (targ, temporaries_.back());
+  }
+  template<size_t N> inline void
+  assign_args ()
+  {}
+  template<size_t N, class A, class ...Args> inline void
+  assign_args (const A &arg, const Args &...args)
+  {
+    assign (args_[N], arg);
+    assign_args<N+1> (args...);
+  }
+public:
+  template<size_t N, class ...Args>
+  TraceArgs (TraceArg (&mem)[N], const Args &...args) : args_ (mem), nargs_ (sizeof... (Args))
+  {
+    assign_args<0> (args...);
+  }
+  const TraceArg* args  () const { return args_; }
+  size_t          nargs () const { return nargs_; }
+};
+
+bool trace_site_register (TraceSite &site, const char *format);
+void trace_record        (const TraceSite &site, size_t nargs, const TraceArg *args);
+
+inline bool
+trace_site_check (TraceSite &site, const char *format)
+{
+  const int id = __atomic_load_n (&site.id, __ATOMIC_ACQUIRE);
+  return RAPICORN_LIKELY (id != 0) ? id > 0 : trace_site_register (site, format);
+}
+
+template<class... Args> void
+rapicorn_key_debug (TraceSite &site, const char *format, const Args &...args)
+{
+  if (RAPICORN_UNLIKELY (_rapicorn_trace_check_cache) && trace_site_check (site, format))
+    {
+      constexpr size_t N = sizeof... (Args);
+      TraceArg mem[N ? N : 1];
+      const TraceArgs targs (mem, args...);
+      trace_record (site, targs.nargs(), targs.args());
+    }
+  if (RAPICORN_UNLIKELY (_rapicorn_debug_check_cache))
+    rapicorn_debug (site.key, site.file, site.line, string_format (format, args...));
+}
 
 inline bool
 rapicorn_debug_check (const char *key)
@@ -1,7 +1,11 @@
 // This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
 #include "loop.hh"
 #include "strings.hh"
+#include "../configure.h"       // HAVE_SYS_EPOLL_H
 #include <sys/poll.h>
+#ifdef  HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif // HAVE_SYS_EPOLL_H
 #include <errno.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -13,10 +17,13 @@
 
 namespace Rapicorn {
 
+static auto dbe_loop_stats = RAPICORN_DEBUG_OPTION ("loop-stats", "Collect dispatch statistics of main loop sources and print them when loops are destroyed.");
+
 enum {
   WAITING             = 0,
   PREPARED,
   NEEDS_DISPATCH,
+  QUEUED,               // TimedSource pending in EventLoop::timers_
 };
 
 // == PollFD invariants ==
@@ -37,6 +44,26 @@ RAPICORN_STATIC_ASSERT (offsetof (PollFD, events)       == offsetof (struct poll
 RAPICORN_STATIC_ASSERT (sizeof (((PollFD*) 0)->events)  == sizeof (((struct pollfd*) 0)->events));
 RAPICORN_STATIC_ASSERT (offsetof (PollFD, revents)      == offsetof (struct pollfd, revents));
 RAPICORN_STATIC_ASSERT (sizeof (((PollFD*) 0)->revents) == sizeof (((struct pollfd*) 0)->revents));
+#ifdef  HAVE_SYS_EPOLL_H
+RAPICORN_STATIC_ASSERT (int (PollFD::IN)     == int (EPOLLIN));
+RAPICORN_STATIC_ASSERT (int (PollFD::PRI)    == int (EPOLLPRI));
+RAPICORN_STATIC_ASSERT (int (PollFD::OUT)    == int (EPOLLOUT));
+RAPICORN_STATIC_ASSERT (int (PollFD::RDNORM) == int (EPOLLRDNORM));
+RAPICORN_STATIC_ASSERT (int (PollFD::RDBAND) == int (EPOLLRDBAND));
+RAPICORN_STATIC_ASSERT (int (PollFD::WRNORM) == int (EPOLLWRNORM));
+RAPICORN_STATIC_ASSERT (int (PollFD::WRBAND) == int (EPOLLWRBAND));
+RAPICORN_STATIC_ASSERT (int (PollFD::ERR)    == int (EPOLLERR));
+RAPICORN_STATIC_ASSERT (int (PollFD::HUP)    == int (EPOLLHUP));
+#endif // HAVE_SYS_EPOLL_H
+
+// == epoll(7) registrations ==
+enum {
+  POLLSLOT_REGISTERED = 1,      // PollFD is watched by epoll(7)
+  POLLSLOT_FALLBACK   = 2,      // PollFD cannot be watched by epoll(7), needs poll(2)
+  POLLSLOT_REARM      = 4,      // descriptor may have been closed and reopened, verify registration
+};
+static const uint EPOLL_INDEX = UINT_MAX - 1;   // PollFD index for descriptors watched by epoll(7)
+static const uint64 EPOLL_WAKEUP = 0;           // epoll(7) key of the wakeup eventfd
 
 // === Stupid ID allocator ===
 static volatile int global_id_counter = 65536;
@@ -113,7 +140,7 @@ struct QuickSourcePArray : public QuickArray<EventSourceP*> {
 
 // === EventLoop ===
 EventLoop::EventLoop (MainLoop &main) :
-  main_loop_ (&main), dispatch_priority_ (0), primary_ (false)
+  main_loop_ (&main), timers_stamp_ (0), dispatch_priority_ (0), primary_ (false)
 {
   poll_sources_.reserve (7);
   // we cannot *use* main_loop_ yet, because we might be called from within MainLoop::MainLoop(), see SlaveLoop()
@@ -193,6 +220,8 @@ EventLoop::add (EventSourceP source, int priority)
   source->loop_state_ = WAITING;
   source->priority_ = priority;
   sources_.push_back (source);
+  if (source->timed_only_)
+    queue_timer_L (source);
   locker.unlock();
   wakeup();
   return source->id_;
@@ -203,6 +232,11 @@ EventLoop::remove_source_Lm (EventSourceP source)
 {
   ScopedLock<Mutex> locker (main_loop_->mutex(), BALANCED_LOCK);
   assert_return (source->loop_ == this);
+  const uint npfds = source->n_pfds();
+  for (uint i = 0; i < npfds; i++)
+    main_loop_->epoll_release_L (*source, i);
+  if (source->timed_only_)
+    unqueue_timer_L (*source);
   source->loop_ = NULL;
   source->loop_state_ = WAITING;
   auto pos = find (sources_.begin(), sources_.end(), source);
@@ -295,13 +329,48 @@ EventLoop::wakeup ()
 // === MainLoop ===
 MainLoop::MainLoop() :
   EventLoop (*this), // sets *this as MainLoop on self
-  rr_index_ (0), running_ (false), has_quit_ (false), quit_code_ (0)
+  rr_index_ (0), dispatch_budget_ (1), dispatch_budget_usecs_ (0),
+  epollfd_ (-1), running_ (false), has_quit_ (false), quit_code_ (0),
+  collect_stats_ (false), dump_stats_ (false), poll_count_ (0), poll_wait_nsecs_ (0)
 {
+  if (dbe_loop_stats)
+    collect_stats_ = dump_stats_ = true;
   ScopedLock<Mutex> locker (main_loop_->mutex());
   const int err = eventfd_.open();
   if (err < 0)
     fatal ("MainLoop: failed to create wakeup pipe: %s", strerror (-err));
   // has_quit_ and eventfd_ need to be setup here, so calling quit() before run() works
+#ifdef  HAVE_SYS_EPOLL_H
+  // watch PollFDs persistently via epoll(7) if possible, the wakeup eventfd is always registered
+  epollfd_ = epoll_create1 (EPOLL_CLOEXEC);
+  if (epollfd_ >= 0)
+    {
+      struct epoll_event event = { 0, };
+      event.events = EPOLLIN;
+      event.data.u64 = EPOLL_WAKEUP;
+      if (epoll_ctl (epollfd_, EPOLL_CTL_ADD, eventfd_.inputfd(), &event) < 0)
+        {
+          close (epollfd_);
+          epollfd_ = -1;
+        }
+    }
+#endif // HAVE_SYS_EPOLL_H
+}
+
+/** Configure how many sources may be dispatched per loop iteration.
+ * By default, a single source is dispatched per iteration. A larger @a max_sources
+ * allows the dispatching of all sources that need dispatching at the winning priority
+ * within one iteration, saving the prepare, poll and check phases in between.
+ * Sources that turn ready at a higher priority meanwhile are only noticed by the next
+ * iteration, so no further sources are dispatched once @a max_usecs have elapsed (if non-0),
+ * to bound the delay for such sources and other loops.
+ */
+void
+MainLoop::dispatch_budget (uint max_sources, uint max_usecs)
+{
+  ScopedLock<Mutex> locker (mutex_);
+  dispatch_budget_ = MAX (1, max_sources);
+  dispatch_budget_usecs_ = max_usecs;
 }
 
 /** Create a new main loop object, users can run or iterate this loop directly.
@@ -323,6 +392,9 @@ MainLoop::~MainLoop()
   if (main_loop_)
     kill_loops_Lm();
   assert_return (loops_.empty() == true);
+  if (epollfd_ >= 0)
+    close (epollfd_);
+  epollfd_ = -1;
 }
 
 void
@@ -344,6 +416,8 @@ void
 MainLoop::kill_loop_Lm (EventLoop &loop)
 {
   assert_return (this == loop.main_loop_);
+  if (UNLIKELY (dump_stats_))
+    printerr ("%s", loop.stats_dump_L());
   loop.kill_sources_Lm();
   if (loop.main_loop_) // guard against nested kill_loop_Lm (same) calls
     {
@@ -492,6 +566,7 @@ EventLoop::collect_sources_Lm (LoopState &state)
     }
   if (UNLIKELY (!state.seen_primary && primary_))
     state.seen_primary = true;
+  expire_timers_L (state.current_time_usecs, false);
   EventSourceP* arraymem[7]; // using a vector+malloc here shows up in the profiles
   QuickSourcePArray poll_candidates (ARRAY_SIZE (arraymem), arraymem);
   // determine dispatch priority & collect sources for preparing
@@ -502,7 +577,8 @@ EventLoop::collect_sources_Lm (LoopState &state)
       if (UNLIKELY (!state.seen_primary && source.primary_))
         state.seen_primary = true;
       if (source.loop_ != this ||                               // ignore destroyed and
-          (source.dispatching_ && !source.may_recurse_))        // avoid unallowed recursion
+          (source.dispatching_ && !source.may_recurse_) ||      // avoid unallowed recursion
+          source.loop_state_ == QUEUED)                         // leave pending timers to timers_
         continue;
       if (source.priority_ > dispatch_priority_ &&              // ignore lower priority sources
           source.loop_state_ == NEEDS_DISPATCH)                 // if NEEDS_DISPATCH sources remain
@@ -536,11 +612,23 @@ EventLoop::prepare_sources_Lm (LoopState &state, int64 *timeout_usecs, QuickPfdA
       if (source.loop_ != this) // test undestroyed
         continue;
       int64 timeout = -1;
-      main_mutex.unlock();
-      const bool need_dispatch = source.prepare (state, &timeout);
-      main_mutex.lock();
-      if (source.loop_ != this)
-        continue; // ignore newly destroyed sources
+      bool need_dispatch = false;
+      if (source.pollfd_only_)  // PollFD watchers need no unlocking and prepare() calls
+        for (uint i = 0; source.pfds_ && source.pfds_[i].pfd; i++)
+          need_dispatch |= source.pfds_[i].pfd->fd < 0;
+      else if (source.timed_only_)
+        need_dispatch = true;   // only expired timers leave timers_
+      else
+        {
+          const uint64 stamp = UNLIKELY (main_loop_->collect_stats_) ? timestamp_benchmark() : 0;
+          main_mutex.unlock();
+          need_dispatch = source.prepare (state, &timeout);
+          main_mutex.lock();
+          if (UNLIKELY (stamp))
+            stats_L (source).prepare_nsecs += timestamp_benchmark() - stamp;
+          if (source.loop_ != this)
+            continue; // ignore newly destroyed sources
+        }
       if (need_dispatch)
         {
           dispatch_priority_ = MAX (dispatch_priority_, source.priority_); // upgrade dispatch priority
@@ -554,13 +642,29 @@ EventLoop::prepare_sources_Lm (LoopState &state, int64 *timeout_usecs, QuickPfdA
       for (uint i = 0; i < npfds; i++)
         if (source.pfds_[i].pfd->fd >= 0)
           {
+            if (main_loop_->epoll_sync_L (source, i))
+              {
+                source.pfds_[i].idx = EPOLL_INDEX; // revents are updated by epoll_poll_Lm()
+                source.pfds_[i].pfd->revents = 0;
+                continue;
+              }
             uint idx = pfda.size();
             source.pfds_[i].idx = idx;
             pfda.push (*source.pfds_[i].pfd);
             pfda[idx].revents = 0;
           }
         else
-          source.pfds_[i].idx = UINT_MAX;
+          {
+            main_loop_->epoll_release_L (source, i);
+            source.pfds_[i].idx = UINT_MAX;
+          }
+    }
+  // the earliest pending timer bounds the poll timeout
+  if (!timers_.empty())
+    {
+      const uint64 expiration = timers_[0].expiration;
+      const int64 timeout = expiration > state.current_time_usecs ? MIN (INT_MAX, expiration - state.current_time_usecs) : 0;
+      *timeout_usecs = MIN (*timeout_usecs, timeout);
     }
   return dispatch_priority_ > UNDEFINED_PRIORITY;
 }
@@ -580,17 +684,29 @@ EventLoop::check_sources_Lm (LoopState &state, const QuickPfdArray &pfda)
       for (uint i = 0; i < npfds; i++)
         {
           uint idx = source.pfds_[i].idx;
+          if (idx == EPOLL_INDEX)
+            continue;           // revents already updated
           if (idx < pfda.size() &&
               source.pfds_[i].pfd->fd == pfda[idx].fd)
             source.pfds_[i].pfd->revents = pfda[idx].revents;
           else
             source.pfds_[i].idx = UINT_MAX;
         }
-      main_mutex.unlock();
-      bool need_dispatch = source.check (state);
-      main_mutex.lock();
-      if (source.loop_ != this)
-        continue; // ignore newly destroyed sources
+      bool need_dispatch = false;
+      if (source.pollfd_only_)  // PollFD watchers need no unlocking and check() calls
+        for (uint i = 0; i < npfds; i++)
+          need_dispatch |= source.pfds_[i].pfd->fd < 0 || source.pfds_[i].pfd->revents;
+      else
+        {
+          const uint64 stamp = UNLIKELY (main_loop_->collect_stats_) ? timestamp_benchmark() : 0;
+          main_mutex.unlock();
+          need_dispatch = source.check (state);
+          main_mutex.lock();
+          if (UNLIKELY (stamp))
+            stats_L (source).check_nsecs += timestamp_benchmark() - stamp;
+          if (source.loop_ != this)
+            continue; // ignore newly destroyed sources
+        }
       if (need_dispatch)
         {
           dispatch_priority_ = MAX (dispatch_priority_, source.priority_); // upgrade dispatch priority
@@ -599,6 +715,8 @@ EventLoop::check_sources_Lm (LoopState &state, const QuickPfdArray &pfda)
       else
         source.loop_state_ = WAITING;
     }
+  // timers expired during polling are dispatched without another iteration
+  expire_timers_L (state.current_time_usecs, true);
   return dispatch_priority_ > UNDEFINED_PRIORITY;
 }
 
@@ -606,34 +724,252 @@ void
 EventLoop::dispatch_source_Lm (LoopState &state)
 {
   Mutex &main_mutex = main_loop_->mutex();
-  // find a source to dispatch at dispatch_priority_
-  EventSourceP dispatch_source = NULL;                  // shared_ptr to keep alive even if everything else is destroyed
-  for (auto lit = poll_sources_.begin(); lit != poll_sources_.end(); lit++)
+  const int16 priority = dispatch_priority_;
+  dispatch_priority_ = UNDEFINED_PRIORITY;
+  const uint max_dispatches = MAX (1, main_loop_->dispatch_budget_);
+  const uint64 deadline = main_loop_->dispatch_budget_usecs_ && max_dispatches > 1 ?
+                          timestamp_realtime() + main_loop_->dispatch_budget_usecs_ : 0;
+  // dispatch sources at dispatch priority in poll order, until the budget is exhausted
+  size_t index = 0;
+  for (uint n = 0; n < max_dispatches; n++)
     {
-      EventSourceP &source = *lit;
-      if (source->loop_ == this &&                      // test undestroyed
-          source->priority_ == dispatch_priority_ &&    // only dispatch at dispatch priority
-          source->loop_state_ == NEEDS_DISPATCH)
+      EventSourceP dispatch_source = NULL;              // shared_ptr to keep alive even if everything else is destroyed
+      for (; index < poll_sources_.size(); index++)     // poll_sources_ may shrink during recursion
         {
-          dispatch_source = source;
-          break;
+          EventSourceP &source = poll_sources_[index];
+          if (source->loop_ == this &&                  // test undestroyed
+              source->priority_ == priority &&          // only dispatch at dispatch priority
+              source->loop_state_ == NEEDS_DISPATCH)
+            {
+              dispatch_source = source;
+              index++;
+              break;
+            }
         }
-    }
-  dispatch_priority_ = UNDEFINED_PRIORITY;
-  // dispatch single source
-  if (dispatch_source)
-    {
+      if (!dispatch_source)
+        break;
+      // dispatch single source
       dispatch_source->loop_state_ = WAITING;
       const bool old_was_dispatching = dispatch_source->was_dispatching_;
       dispatch_source->was_dispatching_ = dispatch_source->dispatching_;
       dispatch_source->dispatching_ = true;
+      const uint64 stamp = UNLIKELY (main_loop_->collect_stats_) ? timestamp_benchmark() : 0;
       main_mutex.unlock();
       const bool keep_alive = dispatch_source->dispatch (state);
       main_mutex.lock();
+      if (UNLIKELY (stamp))
+        {
+          const uint64 elapsed = timestamp_benchmark() - stamp;
+          EventSourceStats &stats = stats_L (*dispatch_source);
+          stats.dispatches += 1;
+          stats.dispatch_nsecs += elapsed;
+          stats.max_dispatch_nsecs = MAX (stats.max_dispatch_nsecs, elapsed);
+        }
       dispatch_source->dispatching_ = dispatch_source->was_dispatching_;
       dispatch_source->was_dispatching_ = old_was_dispatching;
+      if (dispatch_source->loop_ == this && dispatch_source->pfds_)
+        main_loop_->epoll_rearm_L (*dispatch_source);
       if (dispatch_source->loop_ == this && !keep_alive)
         remove_source_Lm (dispatch_source);
+      else if (dispatch_source->loop_ == this && dispatch_source->timed_only_)
+        queue_timer_L (dispatch_source);
+      if (deadline && timestamp_realtime() >= deadline)
+        break;
+    }
+}
+
+// == Dispatch statistics ==
+EventSourceStats::EventSourceStats () :
+  id (0), priority (0), dispatches (0), dispatch_nsecs (0), max_dispatch_nsecs (0), prepare_nsecs (0), check_nsecs (0)
+{}
+
+inline EventSourceStats&
+EventLoop::stats_L (EventSource &source)
+{
+  if (UNLIKELY (!source.stats_))
+    source.stats_ = new EventSourceStats();
+  return *source.stats_;
+}
+
+/** Enable or disable the collection of dispatch statistics.
+ * Statistics are collected for all sources of the main loop and its slave loops,
+ * the debug key "loop-stats" enables statistics for all main loops and prints them
+ * when a loop is destroyed.
+ */
+void
+EventLoop::collect_stats (bool on)
+{
+  ScopedLock<Mutex> locker (main_loop_->mutex());
+  main_loop_->collect_stats_ = on;
+}
+
+vector<EventSourceStats>
+EventLoop::source_stats ()
+{
+  ScopedLock<Mutex> locker (main_loop_->mutex());
+  vector<EventSourceStats> svector;
+  for (auto &source : sources_)
+    {
+      svector.push_back (source->stats_ ? *source->stats_ : EventSourceStats());
+      EventSourceStats &stats = svector.back();
+      stats.type = cxx_demangle (typeid (*source).name());
+      stats.id = source->id_;
+      stats.priority = source->priority_;
+    }
+  return svector;
+}
+
+static String
+priority_name (int priority)
+{
+  static const struct { int priority; const char *name; } names[] = {
+    { EventLoop::PRIORITY_NOW,    "NOW" },    { EventLoop::PRIORITY_ASCENT, "ASCENT" },
+    { EventLoop::PRIORITY_HIGH,   "HIGH" },   { EventLoop::PRIORITY_NEXT,   "NEXT" },
+    { EventLoop::PRIORITY_NORMAL, "NORMAL" }, { EventLoop::PRIORITY_UPDATE, "UPDATE" },
+    { EventLoop::PRIORITY_IDLE,   "IDLE" },   { EventLoop::PRIORITY_LOW,    "LOW" },
+  };
+  for (size_t i = 0; i < ARRAY_SIZE (names); i++)
+    if (priority == names[i].priority)
+      return names[i].name;
+    else if (priority > names[i].priority)
+      return string_format ("%s+%d", names[i].name, priority - names[i].priority);
+  return string_format ("%d", priority);
+}
+
+String
+EventLoop::stats_dump_L ()
+{
+  String s;
+  if (this == main_loop_)
+    s += string_format ("MainLoop(%p): polls=%u poll_wait=%.3fms\n", this,
+                        main_loop_->poll_count_, main_loop_->poll_wait_nsecs_ * 0.000001);
+  else
+    s += string_format ("EventLoop(%p):\n", this);
+  for (auto &source : sources_)
+    {
+      const EventSourceStats stats = source->stats_ ? *source->stats_ : EventSourceStats();
+      s += string_format ("  %u: %s priority=%s dispatches=%u dispatch=%.3fms max=%.3fms prepare=%.3fms check=%.3fms\n",
+                          source->id_, cxx_demangle (typeid (*source).name()), priority_name (source->priority_),
+                          stats.dispatches, stats.dispatch_nsecs * 0.000001, stats.max_dispatch_nsecs * 0.000001,
+                          stats.prepare_nsecs * 0.000001, stats.check_nsecs * 0.000001);
+    }
+  return s;
+}
+
+String
+EventLoop::stats_dump ()
+{
+  ScopedLock<Mutex> locker (main_loop_->mutex());
+  return stats_dump_L();
+}
+
+uint64
+MainLoop::poll_wait_nsecs ()
+{
+  ScopedLock<Mutex> locker (mutex_);
+  return poll_wait_nsecs_;
+}
+
+// == TimedSource scheduling ==
+/* Pending TimedSource objects are kept in a binary min-heap ordered by expiration,
+ * so the next deadline is found in O(1) and (re-)queueing or expiring a timer is
+ * O(log N). Queued timers take no part in the collect/prepare/check phases, once
+ * expired, they are collected like any other source whose prepare() returns true.
+ */
+inline void
+EventLoop::timer_move_L (uint to, TimerEntry &&entry)
+{
+  entry.timer->timer_index_ = to;
+  timers_[to] = std::move (entry);
+}
+
+void
+EventLoop::timer_sift_L (uint index)
+{
+  const uint n = timers_.size();
+  TimerEntry entry = std::move (timers_[index]);
+  while (index > 0)                             // sift up
+    {
+      const uint parent = (index - 1) / 2;
+      if (timers_[parent].expiration <= entry.expiration)
+        break;
+      timer_move_L (index, std::move (timers_[parent]));
+      index = parent;
+    }
+  for (uint child = 2 * index + 1; child < n; child = 2 * index + 1) // sift down
+    {
+      if (child + 1 < n && timers_[child + 1].expiration < timers_[child].expiration)
+        child++;
+      if (entry.expiration <= timers_[child].expiration)
+        break;
+      timer_move_L (index, std::move (timers_[child]));
+      index = child;
+    }
+  timer_move_L (index, std::move (entry));
+}
+
+void
+EventLoop::queue_timer_L (EventSourceP source)
+{
+  TimedSource *timer = dynamic_cast<TimedSource*> (source.get());
+  assert_return (timer != NULL);
+  source->loop_state_ = QUEUED;
+  if (UNLIKELY (timer->timer_index_ != UINT_MAX))       // requeued during recursion
+    {
+      timers_[timer->timer_index_].expiration = timer->expiration_usecs_;
+      timer_sift_L (timer->timer_index_);
+      return;
+    }
+  timers_.push_back (TimerEntry { timer->expiration_usecs_, timer, std::move (source) });
+  timer_sift_L (timers_.size() - 1);
+}
+
+void
+EventLoop::unqueue_timer_L (EventSource &source)
+{
+  TimedSource *timer = dynamic_cast<TimedSource*> (&source);
+  if (!timer || timer->timer_index_ == UINT_MAX)
+    return;
+  const uint index = timer->timer_index_, last = timers_.size() - 1;
+  timer->timer_index_ = UINT_MAX;
+  if (index != last)
+    {
+      timer_move_L (index, std::move (timers_[last]));
+      timers_.pop_back();
+      timer_sift_L (index);
+    }
+  else
+    timers_.pop_back();
+}
+
+/// Unqueue all timers expired at @a now_usecs, during the check phase they are flagged NEEDS_DISPATCH.
+void
+EventLoop::expire_timers_L (uint64 now_usecs, bool need_polling)
+{
+  if (UNLIKELY (now_usecs < timers_stamp_))     // clock warped back in time
+    {
+      for (auto &entry : timers_)
+        if (!entry.timer->first_interval_)
+          {
+            const uint64 interval = entry.timer->interval_msecs_ * 1000ULL;
+            if (now_usecs + interval < entry.expiration)
+              entry.timer->expiration_usecs_ = entry.expiration = now_usecs + interval;
+          }
+      for (uint i = timers_.size() / 2; i > 0; i--)
+        timer_sift_L (i - 1);
+    }
+  timers_stamp_ = now_usecs;
+  while (!timers_.empty() && timers_[0].expiration <= now_usecs)
+    {
+      EventSourceP source = std::move (timers_[0].source);
+      unqueue_timer_L (*source);
+      source->loop_state_ = WAITING;
+      if (need_polling)
+        {
+          dispatch_priority_ = MAX (dispatch_priority_, source->priority_); // upgrade dispatch priority
+          source->loop_state_ = NEEDS_DISPATCH;
+          poll_sources_.push_back (source);
+        }
     }
 }
 
@@ -645,8 +981,8 @@ MainLoop::iterate_loops_Lm (LoopState &state, bool may_block, bool may_dispatch)
   int64 timeout_usecs = INT64_MAX;
   PollFD reserved_pfd_mem[7];   // store PollFD array in stack memory, to reduce malloc overhead
   QuickPfdArray pfda (ARRAY_SIZE (reserved_pfd_mem), reserved_pfd_mem); // pfda.size() == 0
-  // allow poll wakeups
-  const PollFD wakeup = { eventfd_.inputfd(), PollFD::IN, 0 };
+  // allow poll wakeups, with epoll(7) the eventfd is watched by epollfd_
+  const PollFD wakeup = { epollfd_ >= 0 ? epollfd_ : eventfd_.inputfd(), PollFD::IN, 0 };
   const uint wakeup_idx = 0; // wakeup_idx = pfda.size();
   pfda.push (wakeup);
   // create pollable loop list
@@ -657,13 +993,13 @@ MainLoop::iterate_loops_Lm (LoopState &state, bool may_block, bool may_dispatch)
   // collect
   state.phase = state.COLLECT;
   state.seen_primary = false;
+  state.current_time_usecs = timestamp_realtime();
   for (size_t i = 0; i < nloops; i++)
     loops[i]->collect_sources_Lm (state);
   // prepare
   bool any_dispatchable = false;
   bool priority_ascension = false;      // flag for priority elevation between loops
   state.phase = state.PREPARE;
-  state.current_time_usecs = timestamp_realtime();
   bool dispatchable[nloops];
   for (size_t i = 0; i < nloops; i++)
     {
@@ -678,15 +1014,28 @@ MainLoop::iterate_loops_Lm (LoopState &state, bool may_block, bool may_dispatch)
     timeout_msecs = 1;
   if (!may_block || any_dispatchable)
     timeout_msecs = 0;
-  main_mutex.unlock();
   int presult;
-  do
-    presult = poll ((struct pollfd*) &pfda[0], pfda.size(), MIN (timeout_msecs, INT_MAX));
-  while (presult < 0 && errno == EAGAIN); // EINTR may indicate a signal
-  main_mutex.lock();
+  const uint64 poll_stamp = UNLIKELY (collect_stats_) ? timestamp_benchmark() : 0;
+  if (epollfd_ >= 0 && pfda.size() == 1)
+    presult = epoll_poll_Lm (timeout_msecs);    // all PollFDs are watched by epoll(7)
+  else
+    {
+      main_mutex.unlock();
+      do
+        presult = poll ((struct pollfd*) &pfda[0], pfda.size(), MIN (timeout_msecs, INT_MAX));
+      while (presult < 0 && errno == EAGAIN); // EINTR may indicate a signal
+      main_mutex.lock();
+      if (presult > 0 && epollfd_ >= 0 && pfda[wakeup_idx].revents)
+        presult = epoll_poll_Lm (0);            // collect events from epoll(7) watched PollFDs
+    }
+  if (UNLIKELY (poll_stamp))
+    {
+      poll_count_ += 1;
+      poll_wait_nsecs_ += timestamp_benchmark() - poll_stamp;
+    }
   if (presult < 0 && errno != EINTR)
     critical ("MainLoop: poll() failed: %s", strerror());
-  else if (pfda[wakeup_idx].revents)
+  else if (epollfd_ < 0 && pfda[wakeup_idx].revents)
     eventfd_.flush(); // restart queueing wakeups, possibly triggered by dispatching
   // check
   state.phase = state.CHECK;
@@ -721,6 +1070,139 @@ MainLoop::iterate_loops_Lm (LoopState &state, bool may_block, bool may_dispatch)
   return any_dispatchable; // need to dispatch or recheck
 }
 
+/// Register or update a PollFD of @a source with epoll(7), returns false if poll(2) is needed instead.
+bool
+MainLoop::epoll_sync_L (EventSource &source, uint n)
+{
+#ifdef  HAVE_SYS_EPOLL_H
+  if (epollfd_ < 0)
+    return false;
+  uint &slot_index = source.pfds_[n].slot;
+  if (slot_index == UINT_MAX)
+    {
+      if (free_slots_.empty())
+        {
+          free_slots_.push_back (poll_slots_.size());
+          poll_slots_.push_back (PollSlot { NULL, NULL, -1, 0, 0, 0 });
+        }
+      slot_index = free_slots_.back();
+      free_slots_.pop_back();
+      PollSlot &slot = poll_slots_[slot_index];
+      slot.source = &source;
+      slot.pfd = source.pfds_[n].pfd;
+      slot.fd = -1;
+      slot.events = 0;
+      slot.flags = 0;
+    }
+  PollSlot &slot = poll_slots_[slot_index];
+  const PollFD &pfd = *slot.pfd;
+  if (slot.fd == pfd.fd && !(slot.flags & POLLSLOT_REARM))
+    {
+      if (slot.flags & POLLSLOT_FALLBACK)
+        return false;                   // e.g. regular files or descriptors watched twice
+      if ((slot.flags & POLLSLOT_REGISTERED) && slot.events == pfd.events)
+        return true;                    // up to date, the common case
+    }
+  struct epoll_event event = { 0, };
+  event.events = pfd.events;
+  event.data.u64 = (uint64 (slot.stamp) << 32) | (slot_index + 1);
+  int err = -1;
+  if ((slot.flags & POLLSLOT_REGISTERED) && slot.fd == pfd.fd)
+    err = epoll_ctl (epollfd_, EPOLL_CTL_MOD, pfd.fd, &event);
+  else if (slot.flags & POLLSLOT_REGISTERED)
+    epoll_ctl (epollfd_, EPOLL_CTL_DEL, slot.fd, &event);       // descriptor was changed
+  if (err < 0)  // ENOENT from MOD means the kernel dropped a closed descriptor
+    err = epoll_ctl (epollfd_, EPOLL_CTL_ADD, pfd.fd, &event);
+  slot.fd = pfd.fd;
+  slot.events = pfd.events;
+  slot.flags = err < 0 ? POLLSLOT_FALLBACK : POLLSLOT_REGISTERED;
+  return err == 0;
+#else  // !HAVE_SYS_EPOLL_H
+  return false;
+#endif // !HAVE_SYS_EPOLL_H
+}
+
+/** Flag the epoll(7) registrations of @a source for verification by the next epoll_sync_L().
+ * Dispatching may close a descriptor and open another one under the same number, which the kernel
+ * silently removes from the epoll(7) set. Re-arming also retries descriptors that needed poll(2).
+ */
+void
+MainLoop::epoll_rearm_L (EventSource &source)
+{
+  const uint npfds = source.n_pfds();
+  for (uint i = 0; i < npfds; i++)
+    if (source.pfds_[i].slot != UINT_MAX)
+      poll_slots_[source.pfds_[i].slot].flags |= POLLSLOT_REARM;
+}
+
+/// Unregister a PollFD of @a source from epoll(7), events pending for it are discarded.
+void
+MainLoop::epoll_release_L (EventSource &source, uint n)
+{
+  uint &slot_index = source.pfds_[n].slot;
+  if (slot_index == UINT_MAX)
+    return;
+  PollSlot &slot = poll_slots_[slot_index];
+#ifdef  HAVE_SYS_EPOLL_H
+  if (slot.flags & POLLSLOT_REGISTERED)
+    {
+      struct epoll_event event = { 0, };
+      epoll_ctl (epollfd_, EPOLL_CTL_DEL, slot.fd, &event);
+    }
+#endif // HAVE_SYS_EPOLL_H
+  slot.source = NULL;
+  slot.pfd = NULL;
+  slot.fd = -1;
+  slot.flags = 0;
+  slot.stamp++;         // invalidates keys of events already collected
+  free_slots_.push_back (slot_index);
+  slot_index = UINT_MAX;
+}
+
+/// Wait for epoll(7) events and update the revents of PollFDs that are being polled.
+int
+MainLoop::epoll_poll_Lm (int64 timeout_msecs)
+{
+#ifdef  HAVE_SYS_EPOLL_H
+  struct epoll_event events[64];
+  mutex_.unlock();
+  int presult;
+  do
+    presult = epoll_wait (epollfd_, events, ARRAY_SIZE (events), MIN (timeout_msecs, INT_MAX));
+  while (presult < 0 && errno == EAGAIN); // EINTR may indicate a signal
+  mutex_.lock();
+  for (int i = 0; i < presult; i++)
+    {
+      const uint64 key = events[i].data.u64;
+      if (key == EPOLL_WAKEUP)
+        {
+          eventfd_.flush(); // restart queueing wakeups, possibly triggered by dispatching
+          continue;
+        }
+      const uint slot_index = (key & 0xffffffff) - 1;
+      if (slot_index >= poll_slots_.size() || poll_slots_[slot_index].stamp != key >> 32)
+        continue;       // PollFD was removed meanwhile
+      PollSlot &slot = poll_slots_[slot_index];
+      if (!(slot.flags & POLLSLOT_REGISTERED) || slot.pfd->fd != slot.fd)
+        continue;       // PollFD was changed meanwhile
+      if (slot.source->loop_state_ == PREPARED)
+        slot.pfd->revents |= events[i].events & 0xffff;
+      else
+        {
+          /* The source is not polled in this iteration (priority or recursion), since epoll(7)
+           * is level triggered, suspend watching the descriptor until epoll_sync_L() is called.
+           */
+          struct epoll_event event = { 0, };
+          epoll_ctl (epollfd_, EPOLL_CTL_DEL, slot.fd, &event);
+          slot.flags &= ~POLLSLOT_REGISTERED;
+        }
+    }
+  return presult;
+#else  // !HAVE_SYS_EPOLL_H
+  return 0;
+#endif // !HAVE_SYS_EPOLL_H
+}
+
 struct SlaveLoop : public EventLoop {
   friend class FriendAllocator<SlaveLoop>;
   SlaveLoop (MainLoopP main) :
@@ -750,13 +1232,16 @@ LoopState::LoopState() :
 EventSource::EventSource () :
   loop_ (NULL),
   pfds_ (NULL),
+  stats_ (NULL),
   id_ (0),
   priority_ (UNDEFINED_PRIORITY),
   loop_state_ (0),
   may_recurse_ (0),
   dispatching_ (0),
   was_dispatching_ (0),
-  primary_ (0)
+  primary_ (0),
+  pollfd_only_ (0),
+  timed_only_ (0)
 {}
 
 uint
@@ -808,8 +1293,10 @@ EventSource::add_poll (PollFD *const pfd)
   if (!pfds_)
     fatal ("EventSource: out of memory");
   pfds_[npfds].idx = UINT_MAX;
+  pfds_[npfds].slot = UINT_MAX;
   pfds_[npfds].pfd = NULL;
   pfds_[idx].idx = UINT_MAX;
+  pfds_[idx].slot = UINT_MAX;  // registered for epoll(7) during prepare
   pfds_[idx].pfd = pfd;
 }
 
@@ -822,10 +1309,18 @@ EventSource::remove_poll (PollFD *const pfd)
       break;
   if (idx < npfds)
     {
+      MainLoop *main = main_loop();
+      if (main)
+        {
+          ScopedLock<Mutex> locker (main->mutex());
+          main->epoll_release_L (*this, idx);
+        }
       pfds_[idx].idx = UINT_MAX;
       pfds_[idx].pfd = pfds_[npfds - 1].pfd;
       pfds_[idx].idx = pfds_[npfds - 1].idx;
+      pfds_[idx].slot = pfds_[npfds - 1].slot;
       pfds_[npfds - 1].idx = UINT_MAX;
+      pfds_[npfds - 1].slot = UINT_MAX;
       pfds_[npfds - 1].pfd = NULL;
     }
   else
@@ -848,6 +1343,7 @@ EventSource::~EventSource ()
   RAPICORN_ASSERT (loop_ == NULL);
   if (pfds_)
     free (pfds_);
+  delete stats_;
 }
 
 // == DispatcherSource ==
@@ -889,15 +1385,19 @@ DispatcherSource::destroy()
 // == TimedSource ==
 TimedSource::TimedSource (const VoidSlot &slot, uint initial_interval_msecs, uint repeat_interval_msecs) :
   expiration_usecs_ (timestamp_realtime() + 1000ULL * initial_interval_msecs),
-  interval_msecs_ (repeat_interval_msecs), first_interval_ (true),
+  interval_msecs_ (repeat_interval_msecs), timer_index_ (UINT_MAX), first_interval_ (true),
   oneshot_ (true), void_slot_ (slot)
-{}
+{
+  timed_only_ = true;
+}
 
 TimedSource::TimedSource (const BoolSlot &slot, uint initial_interval_msecs, uint repeat_interval_msecs) :
   expiration_usecs_ (timestamp_realtime() + 1000ULL * initial_interval_msecs),
-  interval_msecs_ (repeat_interval_msecs), first_interval_ (true),
+  interval_msecs_ (repeat_interval_msecs), timer_index_ (UINT_MAX), first_interval_ (true),
   oneshot_ (false), bool_slot_ (slot)
-{}
+{
+  timed_only_ = true;
+}
 
 bool
 TimedSource::prepare (const LoopState &state, int64 *timeout_usecs_p)
@@ -980,6 +1480,7 @@ void
 PollFDSource::construct (const String &mode)
 {
   add_poll (&pfd_);
+  pollfd_only_ = true;  // prepare() and check() only depend on pfd_
   pfd_.events |= strchr (mode.c_str(), 'w') ? PollFD::OUT : 0;
   pfd_.events |= strchr (mode.c_str(), 'r') ? PollFD::IN : 0;
   pfd_.events |= strchr (mode.c_str(), 'p') ? PollFD::PRI : 0;
@@ -1089,6 +1590,10 @@ PollFDSource::~PollFDSource ()
   Loop integration of a Rapicorn::EventSource class:
   @li First, prepare() is called on a source, returning true here flags the source to be ready for immediate dispatching.
   @li Second, poll(2) monitors all PollFD file descriptors of the source (see Rapicorn::EventSource::add_poll()).
+  Where available, descriptors are registered persistently with epoll(7) instead, so only descriptors that cannot
+  be watched by epoll(7) need to be passed into poll(2) for each iteration. Registrations are verified after a source
+  was dispatched, a source that replaces the descriptor of a PollFD outside of dispatch() needs to call
+  Rapicorn::EventSource::remove_poll() and Rapicorn::EventSource::add_poll() for the change to be noticed.
   @li Third, check() is called for the source to check whether dispatching is needed depending on PollFD states.
   @li Fourth, the source is dispatched if it returened true from either prepare() or check(). If multiple sources are
   ready to be dispatched, the entire process may be repeated several times (after dispatching other sources),
@@ -45,6 +45,7 @@ typedef std::shared_ptr<EventLoop> EventLoopP;
 class MainLoop;
 typedef std::shared_ptr<MainLoop> MainLoopP;
 class LoopState;
+struct EventSourceStats;
 
 // === EventLoop ===
 /// Loop object, polling for events and executing callbacks in accordance.
@@ -52,11 +53,18 @@ class EventLoop : public virtual std::enable_shared_from_this<EventLoop>
 {
   class QuickPfdArray;          // pseudo vector<PollFD>
   friend class MainLoop;
+  struct TimerEntry {           // min-heap entry for pending TimedSource expirations
+    uint64        expiration;
+    TimedSource  *timer;
+    EventSourceP  source;
+  };
 protected:
   typedef std::vector<EventSourceP> SourceList;
   MainLoop     *main_loop_;
   SourceList    sources_;
   vector<EventSourceP> poll_sources_;
+  vector<TimerEntry>   timers_;
+  uint64        timers_stamp_;
   int16         dispatch_priority_;
   bool          primary_;
   explicit      EventLoop           (MainLoop&);
@@ -71,6 +79,13 @@ protected:
   bool          prepare_sources_Lm  (LoopState&, int64*, QuickPfdArray&);
   bool          check_sources_Lm    (LoopState&, const QuickPfdArray&);
   void          dispatch_source_Lm  (LoopState&);
+  void          queue_timer_L       (EventSourceP source);
+  void          unqueue_timer_L     (EventSource &source);
+  void          expire_timers_L     (uint64 now_usecs, bool need_polling);
+  void          timer_move_L        (uint to, TimerEntry &&entry);
+  void          timer_sift_L        (uint index);
+  EventSourceStats& stats_L         (EventSource &source);
+  String        stats_dump_L        ();
 public:
   typedef std::function<void (void)>             VoidSlot;
   typedef std::function<bool (void)>             BoolSlot;
@@ -96,6 +111,9 @@ public:
   bool has_primary     (void);                  ///< Indicates whether loop contains primary sources.
   bool flag_primary    (bool            on);
   MainLoop* main_loop  () const;                ///< Get the main loop for this loop.
+  void collect_stats   (bool            on);    ///< Enable dispatch statistics for all sources of the main loop.
+  vector<EventSourceStats> source_stats ();     ///< Retrieve dispatch statistics of the sources in this loop.
+  String stats_dump    ();                      ///< Describe source types, priorities and dispatch statistics.
   template<class BoolVoidFunctor>
   uint exec_now        (BoolVoidFunctor &&bvf); ///< Execute a callback as primary source with priority "now" (highest), returning true repeats callback.
   template<class BoolVoidFunctor>
@@ -119,20 +137,42 @@ class MainLoop : public EventLoop
 {
   friend                class FriendAllocator<MainLoop>;
   friend                class EventLoop;
+  friend                class EventSource;
   friend                class SlaveLoop;
+  struct PollSlot {     // persistent epoll(7) registration of a PollFD
+    EventSource        *source;
+    PollFD             *pfd;
+    int                 fd;
+    uint16              events;
+    uint8               flags;
+    uint32              stamp;
+  };
   Mutex                 mutex_;
   uint                  rr_index_;
+  uint                  dispatch_budget_;
+  uint                  dispatch_budget_usecs_;
   vector<EventLoopP>    loops_;
   EventFd               eventfd_;
+  int                   epollfd_;
+  vector<PollSlot>      poll_slots_;
+  vector<uint>          free_slots_;
   int8                  running_;
   int8                  has_quit_;
   int16                 quit_code_;
+  bool                  collect_stats_;
+  bool                  dump_stats_;
+  uint64                poll_count_;
+  uint64                poll_wait_nsecs_;
   bool                  finishable_L        ();
   void                  wakeup_poll         ();                 ///< Wakeup main loop from polling.
   void                  add_loop_L          (EventLoop &loop);  ///< Adds a slave loop to this main loop.
   void                  kill_loop_Lm        (EventLoop &loop);  ///< Destroy a slave loop and all its sources.
   void                  kill_loops_Lm       ();                 ///< Destroy this loop and all slave loops.
   bool                  iterate_loops_Lm    (LoopState&, bool b, bool d);
+  bool                  epoll_sync_L        (EventSource &source, uint n);
+  void                  epoll_release_L     (EventSource &source, uint n);
+  void                  epoll_rearm_L       (EventSource &source);
+  int                   epoll_poll_Lm       (int64 timeout_msecs);
   explicit              MainLoop            ();
 public:
   virtual   ~MainLoop        ();
@@ -143,11 +183,26 @@ public:
   bool       pending         ();                     ///< Check if iterate() needs to be called for dispatching.
   bool       iterate         (bool block);           ///< Perform one loop iteration and return whether more iterations are needed.
   void       iterate_pending (); ///< Call iterate() until no immediate dispatching is needed.
+  void       dispatch_budget (uint max_sources, uint max_usecs = 0); ///< Limit sources dispatched per iteration.
   EventLoopP create_slave    (); ///< Creates a new slave loop that is run as part of this main loop.
+  uint64     poll_wait_nsecs (); ///< Time spent waiting in poll(2) while dispatch statistics are collected.
   static MainLoopP  create   ();
   inline Mutex&     mutex    () { return mutex_; } ///< Provide access to the mutex associated with this main loop.
 };
 
+// === EventSourceStats ===
+struct EventSourceStats {               ///< Dispatch statistics of an EventSource, see EventLoop::collect_stats().
+  String        type;                   ///< Type name of the source.
+  uint          id;                     ///< Source id as returned from EventLoop::add().
+  int           priority;               ///< Source priority.
+  uint64        dispatches;             ///< Number of dispatch() calls.
+  uint64        dispatch_nsecs;         ///< Total time spent in dispatch().
+  uint64        max_dispatch_nsecs;     ///< Longest time spent in a single dispatch() call.
+  uint64        prepare_nsecs;          ///< Total time spent in prepare().
+  uint64        check_nsecs;            ///< Total time spent in check().
+  explicit      EventSourceStats ();
+};
+
 // === LoopState ===
 struct LoopState {
   enum     Phase { NONE, COLLECT, PREPARE, CHECK, DISPATCH, DESTROY };
@@ -161,13 +216,16 @@ struct LoopState {
 class EventSource /// EventLoop source for callback execution.
 {
   friend       class EventLoop;
+  friend       class MainLoop;
   RAPICORN_CLASS_NON_COPYABLE (EventSource);
 protected:
   EventLoop   *loop_;
   struct {
     PollFD    *pfd;
     uint       idx;
+    uint       slot;
   }           *pfds_;
+  EventSourceStats *stats_;
   uint         id_;
   int16        priority_;
   uint8        loop_state_;
@@ -175,6 +233,8 @@ protected:
   uint         dispatching_ : 1;
   uint         was_dispatching_ : 1;
   uint         primary_ : 1;
+  uint         pollfd_only_ : 1;  // prepare() and check() merely reflect PollFD states
+  uint         timed_only_ : 1;   // prepare() and check() merely reflect the TimedSource expiration
   uint         n_pfds      ();
   explicit     EventSource ();
   uint         source_id   () { return loop_ ? id_ : 0; }
@@ -218,10 +278,12 @@ public:
 class TimedSource : public virtual EventSource /// EventLoop source for timer execution.
 {
   friend class FriendAllocator<TimedSource>;
+  friend class EventLoop;
   typedef EventLoop::BoolSlot BoolSlot;
   typedef EventLoop::VoidSlot VoidSlot;
   uint64     expiration_usecs_;
   uint       interval_msecs_;
+  uint       timer_index_;      // position in EventLoop timer heap
   bool       first_interval_;
   const bool oneshot_;
   union {
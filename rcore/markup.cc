@@ -304,7 +304,7 @@ unescape_text_state_inside_text (UnescapeContext *ucontext,
           start = p;
         }
       else
-        p = utf8_next (p);
+        p++;    // ASCII delimiters never occur inside UTF-8 multi-byte sequences
     }
   
   if (p != start)
@@ -636,7 +636,7 @@ unescape_text (MarkupParserContext *context,
     }
   else
     {
-      *unescaped = ucontext.str;
+      unescaped->swap (ucontext.str);
       return true;
     }
 }
@@ -662,26 +662,99 @@ advance_char (MarkupParserContext *context)
   return true;
 }
 
+/* Move context->iter forward to @a target with the same line and character
+ * accounting as repeated advance_char() calls. Newlines are located with memchr(),
+ * characters only need to be counted after the last newline.
+ */
+static inline void
+advance_to (MarkupParserContext *context,
+            const char          *target)
+{
+  const char *p = context->iter, *end = context->current_text_end;
+  if (target == p)
+    return;
+  const char *last = target < end ? target : target - 1;        // last position checked for newlines
+  const char *line_start = NULL;
+  int newlines = 0;
+  for (const char *nl = (const char*) memchr (p + 1, '\n', last - p); nl; nl = (const char*) memchr (nl + 1, '\n', last - nl))
+    {
+      newlines++;
+      line_start = nl;
+    }
+  int chars = 1;                                                // landing on target
+  for (const char *c = (line_start ? line_start : p) + 1; c < target; c++)
+    chars += (*c & 0xc0) != 0x80;
+  if (line_start)
+    {
+      context->line_number += newlines;
+      context->char_number = line_start == target ? 1 : chars + 1;
+    }
+  else
+    context->char_number += chars;
+  context->line_number_after_newline = target < end && *target == '\n';
+  context->iter = target;
+}
+
+/* Validate UTF-8, leading ASCII text without NUL bytes is skipped 8 bytes at a time. */
+static bool
+validate_utf8 (const char *text,
+               const char *end)
+{
+  for (uint64 w; text + 8 <= end; text += 8)
+    {
+      memcpy (&w, text, 8);
+      if ((w | ((w - 0x0101010101010101ULL) & ~w)) & 0x8080808080808080ULL)
+        break;
+    }
+  while (text < end && uint8 (*text) - 1u < 0x7f) // 0x01..0x7f, char may be signed or unsigned
+    text++;
+  return text == end || utf8_validate (String (text, end - text));
+}
+
+/* Check if text from @a p to @a end needs unescape_text() or can be used verbatim. */
+static inline bool
+needs_unescape (const char *p,
+                const char *end,
+                bool        attribute)
+{
+  for (; p < end; p++)
+    if (*p == '&' || *p == '\r' || (attribute && (*p == '\t' || *p == '\n')))
+      return true;
+  return false;
+}
+
 static inline bool    
 xml_isspace (char c)
 {
   return c == ' ' || c == '\t' || c == '\n' || c == '\r';
 }
 
+static inline bool
+is_ascii_name_char (char c)
+{
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+         c == '.' || c == '-' || c == '_' || c == ':';
+}
+
 static void
 skip_spaces (MarkupParserContext *context)
 {
-  do
-    {
-      if (!xml_isspace (*context->iter))
-        return;
-    }
-  while (advance_char (context));
+  const char *p = context->iter;
+  while (p < context->current_text_end && xml_isspace (*p))
+    p++;
+  advance_to (context, p);
 }
 
 static void
 advance_to_name_end (MarkupParserContext *context)
 {
+  // scan ASCII name characters bytewise, non-ASCII characters need UTF-8 decoding
+  const char *p = context->iter;
+  while (p < context->current_text_end && is_ascii_name_char (*p))
+    p++;
+  advance_to (context, p);
+  if (p == context->current_text_end || !(*p & 0x80))
+    return;
   do
     {
       if (!is_name_char (context->iter))
@@ -861,7 +934,7 @@ MarkupParser::parse (const char          *text,
   /* Validate UTF8 (must be done after we find the end, since
    * we could have a trailing incomplete char)
    */
-  if (!utf8_validate (String (context->current_text, context->current_text_len)))
+  if (!validate_utf8 (context->current_text, context->current_text_end))
     {
       int  newlines = 0;
       const char  *p;
@@ -1197,12 +1270,8 @@ MarkupParser::parse (const char          *text,
 		delim = '"';
 	      }
             
-	    do
-	      {
-		if (*context->iter == delim)
-		  break;
-	      }
-	    while (advance_char (context));
+            const char *quote = (const char*) memchr (context->iter, delim, context->current_text_end - context->iter);
+            advance_to (context, quote ? quote : context->current_text_end);
 	  }
           if (context->iter == context->current_text_end)
             {
@@ -1215,18 +1284,25 @@ MarkupParser::parse (const char          *text,
             {
               /* The value has ended at the quote mark. Combine it
                * with the partial chunk if any; set it for the current
-               * attribute.
+               * attribute, values without entities are taken verbatim.
                */
-              add_to_partial (context, context->start, context->iter);
               String unescaped;
-              if (unescape_text (context,
-                                 context->partial_chunk.c_str(),
-                                 context->partial_chunk.c_str() + context->partial_chunk.size(),
-                                 &unescaped,
-                                 error))
+              bool success = true;
+              if (context->partial_chunk.empty() && !needs_unescape (context->start, context->iter, true))
+                unescaped.assign (context->start, context->iter);
+              else
+                {
+                  add_to_partial (context, context->start, context->iter);
+                  success = unescape_text (context,
+                                           context->partial_chunk.c_str(),
+                                           context->partial_chunk.c_str() + context->partial_chunk.size(),
+                                           &unescaped,
+                                           error);
+                }
+              if (success)
                 {
                   /* success, advance past quote and set state. */
-                  last_value (context) = unescaped;
+                  last_value (context).swap (unescaped);
                   advance_char (context);
                   context->state = STATE_BETWEEN_ATTRIBUTES;
                   context->start = NULL;
@@ -1238,30 +1314,37 @@ MarkupParser::parse (const char          *text,
           
         case STATE_INSIDE_TEXT:
           /* Possible next states: AFTER_OPEN_ANGLE */
-          do
+          {
+            const char *angle = (const char*) memchr (context->iter, '<', context->current_text_end - context->iter);
+            advance_to (context, angle ? angle : context->current_text_end);
+          }
+          
+          if (context->iter == context->current_text_end)
             {
-              if (*context->iter == '<')
-                break;
+              /* The text hasn't necessarily ended. Merge with
+               * partial chunk, leave state unchanged.
+               */
+              add_to_partial (context, context->start, context->iter);
             }
-          while (advance_char (context));
-          
-          /* The text hasn't necessarily ended. Merge with
-           * partial chunk, leave state unchanged.
-           */
-          
-          add_to_partial (context, context->start, context->iter);
-          
-          if (context->iter != context->current_text_end)
+          else
             {
               /* The text has ended at the open angle. Call the text
-               * callback.
+               * callback, text without entities is taken verbatim.
                */
               String unescaped;
-              if (unescape_text (context,
-                                 context->partial_chunk.c_str(),
-                                 context->partial_chunk.c_str() + context->partial_chunk.size(),
-                                 &unescaped,
-                                 error))
+              bool success = true;
+              if (context->partial_chunk.empty() && !needs_unescape (context->start, context->iter, false))
+                unescaped.assign (context->start, context->iter);
+              else
+                {
+                  add_to_partial (context, context->start, context->iter);
+                  success = unescape_text (context,
+                                           context->partial_chunk.c_str(),
+                                           context->partial_chunk.c_str() + context->partial_chunk.size(),
+                                           &unescaped,
+                                           error);
+                }
+              if (success)
                 {
                   error.line_number = context->line_number - context->line_number_after_newline;
                   error.char_number = context->char_number;
@@ -42,6 +42,7 @@ struct CPUInfo {
   uint x86_mmx : 1, x86_mmxext : 1, x86_3dnow : 1, x86_3dnowext : 1;
   uint x86_sse : 1, x86_sse2   : 1, x86_sse3  : 1, x86_ssse3    : 1;
   uint x86_cx16 : 1, x86_sse4_1 : 1, x86_sse4_2 : 1, x86_rdrand : 1;
+  uint x86_avx : 1, x86_avx2 : 1;
 };
 
 /* figure architecture name from compiler */
@@ -118,7 +119,7 @@ get_arch_name (void)
     "xchg %%ebx, %%esi"                         \
     : "=a" (eax), "=S" (ebx),                   \
       "=c" (ecx), "=d" (edx)                    \
-    : "0" (input)                               \
+    : "0" (input), "2" (0) /* subleaf */        \
     : "cc")
 #elif   defined __x86_64__ || defined __amd64__
 /* CPUID is always present on AMD64, see:
@@ -138,12 +139,19 @@ get_arch_name (void)
     "xchg %%rbx, %%rsi"                         \
     : "=a" (eax), "=S" (ebx),                   \
       "=c" (ecx), "=d" (edx)                    \
-    : "0" (input)                               \
+    : "0" (input), "2" (0) /* subleaf */        \
     : "cc")
 #else
 #  define x86_has_cpuid()                       (false)
 #  define x86_cpuid(input, eax, ebx, ecx, edx)  do {} while (0)
 #endif
+#if     defined __i386__ || defined __x86_64__ || defined __amd64__
+/* read extended control register, only valid if CPUID reports OSXSAVE */
+#  define x86_xgetbv(index, eax, edx)           \
+  __asm__ __volatile__ (".byte 0x0f, 0x01, 0xd0" : "=a" (eax), "=d" (edx) : "c" (index))
+#else
+#  define x86_xgetbv(index, eax, edx)           do { eax = edx = 0; } while (0)
+#endif
 
 
 static jmp_buf cpu_info_jmp_buf;
@@ -165,7 +173,7 @@ get_x86_cpu_features (CPUInfo *ci)
   /* query intel CPUID range */
   unsigned int eax, ebx, ecx, edx;
   x86_cpuid (0, eax, ebx, ecx, edx);
-  unsigned int v_ebx = ebx, v_ecx = ecx, v_edx = edx;
+  unsigned int v_ebx = ebx, v_ecx = ecx, v_edx = edx, max_leaf = eax;
   char *vendor = ci->cpu_vendor;
   *((unsigned int*) &vendor[0]) = ebx;
   *((unsigned int*) &vendor[4]) = edx;
@@ -201,6 +209,20 @@ get_x86_cpu_features (CPUInfo *ci)
         ci->x86_sse2 = true;
       if (edx & (1 << 28))
         ci->x86_htt = true;
+      /* AVX needs OSXSAVE and the OS saving SSE and AVX register state (XCR0 bits 1, 2) */
+      if ((ecx & (1 << 27)) && (ecx & (1 << 28)))
+        {
+          unsigned int xcr0_lo, xcr0_hi;
+          x86_xgetbv (0, xcr0_lo, xcr0_hi);
+          if ((xcr0_lo & 0x6) == 0x6)
+            ci->x86_avx = true;
+        }
+      if (ci->x86_avx && max_leaf >= 7)
+        {
+          x86_cpuid (7, eax, ebx, ecx, edx);
+          if (ebx & (1 << 5))
+            ci->x86_avx2 = true;
+        }
       /* http://www.intel.com/content/www/us/en/processors/processor-identification-cpuid-instruction-note.html
        * "Intel Processor Identification and the CPUID Instruction"
        */
@@ -258,7 +280,7 @@ get_x86_cpu_features (CPUInfo *ci)
  * a number of flag words describing CPU features plus a trailing space.
  * This allows checks for CPU features via a simple string search for
  * " FEATURE ".
- * @return Example: "4 AMD64 GenuineIntel FPU TSC HTT CMPXCHG16B MMX MMXEXT SSESYS SSE SSE2 SSE3 SSSE3 SSE4.1 SSE4.2 "
+ * @return Example: "4 AMD64 GenuineIntel FPU TSC HTT CMPXCHG16B MMX MMXEXT SSESYS SSE SSE2 SSE3 SSSE3 SSE4.1 SSE4.2 AVX AVX2 "
  */
 String
 cpu_info()
@@ -304,6 +326,10 @@ cpu_info()
       info += " SSE4.1";
     if (cpu_info.x86_sse4_2)
       info += " SSE4.2";
+    if (cpu_info.x86_avx)
+      info += " AVX";
+    if (cpu_info.x86_avx2)
+      info += " AVX2";
     if (cpu_info.x86_rdrand)
       info += " rdrand";
     // 3DNOW flags
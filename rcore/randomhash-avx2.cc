@@ -0,0 +1,63 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include "randomhash.hh"
+#ifdef RAPICORN_TARGET_AVX2
+#include <immintrin.h>
+// kernels only, inline functions from headers must not be compiled for AVX2
+#define AVX2_KERNEL     __attribute__ ((target ("avx2")))
+#endif /* RAPICORN_TARGET_AVX2 */
+
+namespace Rapicorn {
+#ifdef RAPICORN_TARGET_AVX2
+
+// AVX2 lacks 64bit rotations, so combine both shifts
+AVX2_KERNEL static inline __m256i
+rotate_4x64 (__m256i v, int offset)
+{
+  return _mm256_or_si256 (_mm256_sll_epi64 (v, _mm_cvtsi32_si128 (offset)), _mm256_srl_epi64 (v, _mm_cvtsi32_si128 (64 - offset)));
+}
+
+// 4-way Keccak-f[1600], the same steps as KeccakF1600::permute() with one state per 64bit lane
+AVX2_KERNEL bool
+Lib::KeccakF1600::permute4_avx2 (KeccakF1600 *states, uint32_t n_rounds)
+{
+  assert (n_rounds < 255);
+  __m256i S[25];
+  for (size_t i = 0; i < 25; i++)
+    S[i] = _mm256_set_epi64x (states[3].A[i], states[2].A[i], states[1].A[i], states[0].A[i]);
+  for (size_t round_index = 0; round_index < n_rounds; round_index++)
+    {
+      // theta
+      __m256i C[5], D[5], B[25];
+      for (size_t x = 0; x < 5; x++)
+        C[x] = _mm256_xor_si256 (_mm256_xor_si256 (_mm256_xor_si256 (S[x], S[x + 5]), _mm256_xor_si256 (S[x + 10], S[x + 15])), S[x + 20]);
+      for (size_t x = 0; x < 5; x++)
+        D[x] = _mm256_xor_si256 (C[(5 + x - 1) % 5], rotate_4x64 (C[(x + 1) % 5], 1));
+      // rho and pi
+      for (size_t y = 0; y < 5; y++)
+        for (size_t x = 0; x < 5; x++)
+          B[y + 5 * ((2 * x + 3 * y) % 5)] = rotate_4x64 (_mm256_xor_si256 (S[x + 5 * y], D[x]), rho_offsets_[x + 5 * y]);
+      // chi, andnot computes ~B[x+1] & B[x+2]
+      for (size_t y = 0; y < 25; y += 5)
+        for (size_t x = 0; x < 5; x++)
+          S[x + y] = _mm256_xor_si256 (B[x + y], _mm256_andnot_si256 (B[(x + 1) % 5 + y], B[(x + 2) % 5 + y]));
+      // iota
+      S[0] = _mm256_xor_si256 (S[0], _mm256_set1_epi64x (round_constants_[round_index]));
+    }
+  for (size_t i = 0; i < 25; i++)
+    {
+      uint64_t lanes[4];
+      _mm256_storeu_si256 ((__m256i*) lanes, S[i]);
+      for (size_t j = 0; j < 4; j++)
+        states[j].A[i] = lanes[j];
+    }
+  return true;
+}
+
+#else  /* !RAPICORN_TARGET_AVX2 */
+bool
+Lib::KeccakF1600::permute4_avx2 (KeccakF1600 *states, uint32_t n_rounds)
+{
+  return false;
+}
+#endif /* !RAPICORN_TARGET_AVX2 */
+} // Rapicorn
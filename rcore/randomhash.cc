@@ -17,9 +17,9 @@ Lib::KeccakF1600::reset ()
   memset4 ((uint32*) bytes, 0, sizeof (bytes) / 4);
 }
 
-static constexpr const uint8_t KECCAK_RHO_OFFSETS[25] = { 0, 1, 62, 28, 27, 36, 44, 6, 55, 20, 3, 10, 43,
-                                                          25, 39, 41, 45, 15, 21, 8, 18, 2, 61, 56, 14 };
-static constexpr const uint64_t KECCAK_ROUND_CONSTANTS[255] = {
+const uint8_t Lib::KeccakF1600::rho_offsets_[25] = { 0, 1, 62, 28, 27, 36, 44, 6, 55, 20, 3, 10, 43,
+                                                     25, 39, 41, 45, 15, 21, 8, 18, 2, 61, 56, 14 };
+const uint64_t Lib::KeccakF1600::round_constants_[255] = {
   1, 32898, 0x800000000000808a, 0x8000000080008000, 32907, 0x80000001, 0x8000000080008081, 0x8000000000008009, 138, 136, 0x80008009,
   0x8000000a, 0x8000808b, 0x800000000000008b, 0x8000000000008089, 0x8000000000008003, 0x8000000000008002, 0x8000000000000080, 32778,
   0x800000008000000a, 0x8000000080008081, 0x8000000000008080, 0x80000001, 0x8000000080008008, 0x8000000080008082, 0x800000008000800a,
@@ -64,53 +64,46 @@ bit_rotate64 (uint64_t bits, unsigned int offset)
 void
 Lib::KeccakF1600::permute (const uint32_t n_rounds)
 {
-  assert (n_rounds < 255); // adjust the KECCAK_ROUND_CONSTANTS access to lift this assertion
+  assert (n_rounds < 255); // adjust the round_constants_ access to lift this assertion
+  // the state is kept in a local copy, so the fully unrolled rounds can operate on registers
+  uint64_t S[25];
+  std::copy (&A[0], &A[25], &S[0]);
   // Keccak forward rounds
   for (size_t round_index = 0; round_index < n_rounds; round_index++)
     {
       // theta
-      uint64_t C[5];
+      uint64_t C[5], D[5], B[25];
       for (size_t x = 0; x < 5; x++)
-        {
-          C[x] = A[x];
-          for (size_t y = 1; y < 5; y++)
-            C[x] ^= A[x + 5 * y];
-        }
+        C[x] = S[x] ^ S[x + 5] ^ S[x + 10] ^ S[x + 15] ^ S[x + 20];
       for (size_t x = 0; x < 5; x++)
-        {
-          const uint64_t D = C[(5 + x - 1) % 5] ^ bit_rotate64 (C[(x + 1) % 5], 1);
-          for (size_t y = 0; y < 5; y++)
-            A[x + 5 * y] ^= D;
-        }
-      // rho
-      for (size_t y = 0; y < 25; y += 5)
-        {
-          uint64_t *const plane = &A[y];
-          for (size_t x = 0; x < 5; x++)
-            plane[x] = bit_rotate64 (plane[x], KECCAK_RHO_OFFSETS[x + y]);
-        }
-      // pi
-      const uint64_t a[25] = { A[0], A[1], A[2], A[3], A[4], A[5], A[6], A[7], A[8], A[9], A[10], A[11], A[12],
-                               A[13], A[14], A[15], A[16], A[17], A[18], A[19], A[20], A[21], A[22], A[23], A[24] };
+        D[x] = C[(5 + x - 1) % 5] ^ bit_rotate64 (C[(x + 1) % 5], 1);
+      // rho and pi: B[y, 2x+3y] = rot (A[x, y], rho[x, y])
       for (size_t y = 0; y < 5; y++)
         for (size_t x = 0; x < 5; x++)
-          {
-            const size_t X = (0 * x + 1 * y) % 5;
-            const size_t Y = (2 * x + 3 * y) % 5;
-            A[X + 5 * Y] = a[x + 5 * y];
-          }
+          B[y + 5 * ((2 * x + 3 * y) % 5)] = bit_rotate64 (S[x + 5 * y] ^ D[x], rho_offsets_[x + 5 * y]);
       // chi
       for (size_t y = 0; y < 25; y += 5)
-        {
-          uint64_t *const plane = &A[y];
-          for (size_t x = 0; x < 5; x++)
-            C[x] = plane[x] ^ (~plane[(x + 1) % 5] & plane[(x + 2) % 5]);
-          for (size_t x = 0; x < 5; x++)
-            plane[x] = C[x];
-        }
+        for (size_t x = 0; x < 5; x++)
+          S[x + y] = B[x + y] ^ (~B[(x + 1) % 5 + y] & B[(x + 2) % 5 + y]);
       // iota
-      A[0 + 5 * 0] ^= KECCAK_ROUND_CONSTANTS[round_index]; // round_index needs %255 for n_rounds>=255
+      S[0 + 5 * 0] ^= round_constants_[round_index]; // round_index needs %255 for n_rounds>=255
     }
+  std::copy (&S[0], &S[25], &A[0]);
+}
+
+/** Apply the Keccak-f[1600] permutation with @a n_rounds to 4 independent states.
+ * On CPUs with AVX2, the states are permuted in parallel, one state per 64 bit vector lane.
+ * Only random_fill() has independent states to spare, SHA3/SHAKE, KeccakRng and random_nonce()
+ * squeeze a single sponge whose permutations depend on each other and use permute().
+ */
+void
+Lib::KeccakF1600::permute4 (KeccakF1600 states[4], uint32_t n_rounds)
+{
+  static const bool cpu_avx2 = strstr (cpu_info().c_str(), " AVX2 ") != NULL;
+  if (cpu_avx2 && permute4_avx2 (states, n_rounds))
+    return;
+  for (size_t i = 0; i < 4; i++)
+    states[i].permute (n_rounds);
 }
 
 // == KeccakRng ==
@@ -122,6 +115,21 @@ KeccakRng::permute1600()
   opos_ = 0;    // fresh outputs available
 }
 
+/// Copies whole blocks of generator output, avoiding the per value checks of random().
+void
+KeccakRng::generate (uint64_t *begin, uint64_t *end)
+{
+  while (begin < end)
+    {
+      if (opos_ >= n_nums())
+        permute1600();
+      const size_t count = std::min (n_nums() - opos_, size_t (end - begin));
+      std::copy (&state_[opos_], &state_[opos_ + count], begin);
+      opos_ += count;
+      begin += count;
+    }
+}
+
 /** Discard 2^256 bits of the current generator state.
  * This makes it practically infeasible to guess previous generator states or
  * deduce generated values from the past.
@@ -204,8 +212,18 @@ protected:
   xor_state (size_t offset, const uint8_t *input, size_t n_in)
   {
     assert (offset + n_in <= byte_rate());
-    size_t i;
-    for (i = offset; i < offset + n_in; i++)
+    size_t i = offset;
+#if   __BYTE_ORDER == __LITTLE_ENDIAN
+    for (; i % 8 && i < offset + n_in; i++)
+      state_.byte (i) ^= input[i - offset];
+    for (; i + 8 <= offset + n_in; i += 8)      // whole lanes
+      {
+        uint64_t lane;
+        memcpy (&lane, input + i - offset, 8);
+        state_[i / 8] ^= lane;
+      }
+#endif
+    for (; i < offset + n_in; i++)
       state_.byte (i) ^= input[i - offset];
     return i - offset;
   }
@@ -288,8 +306,12 @@ public:
     while (n_out)
       {
         const size_t count = std::min (n_out, byte_rate() - iopos_);
+#if   __BYTE_ORDER == __LITTLE_ENDIAN
+        memcpy (output, &state_.byte (iopos_), count);
+#else
         for (size_t i = 0; i < count; i++)
           output[i] = state_.byte (iopos_ + i);
+#endif
         iopos_ += count;
         output += count;
         n_out -= count;
@@ -670,6 +692,44 @@ random_secret (uint64_t *secret_var)
     }
 }
 
+/** Fill @a values with non-deterministic, uniformly distributed 64 bit pseudo-random numbers.
+ * This function generates numbers of the same quality as random_int64(). Large requests are
+ * served by 4 independent Keccak sponges that are seeded from random_int64() and permuted
+ * together with Lib::KeccakF1600::permute4().
+ */
+void
+random_fill (uint64_t *values, size_t n_values)
+{
+  const size_t n_nums = (1600 - 256) / 64;      // 256 hidden bits and 8 rounds, like global_random64()
+  if (n_values < 4 * n_nums)
+    {
+      for (size_t i = 0; i < n_values; i++)
+        values[i] = global_random64();
+      return;
+    }
+  Lib::KeccakF1600 states[4];
+  for (size_t j = 0; j < 4; j++)
+    {
+      for (size_t i = 0; i < 4; i++)
+        states[j][i] = global_random64();       // 256 secret bits per sponge
+      states[j][4] ^= j;                        // lane separation
+      states[j][5] ^= 0x1;                      // Simple padding: pad10*
+    }
+  while (n_values)
+    {
+      Lib::KeccakF1600::permute4 (states, 8);
+      for (size_t j = 0; j < 4 && n_values; j++)
+        {
+          const size_t count = std::min (n_nums, n_values);
+          std::copy (&states[j][0], &states[j][count], values);
+          values += count;
+          n_values -= count;
+        }
+    }
+  for (size_t j = 0; j < 4; j++)
+    states[j].reset();                          // leave no trails
+}
+
 uint64_t cached_hash_secret = 0;
 
 } // Rapicorn
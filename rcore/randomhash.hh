@@ -14,6 +14,7 @@ int64_t         random_irange   (int64_t begin, int64_t end);
 double          random_float    ();
 double          random_frange   (double begin, double end);
 void            random_secret   (uint64_t *secret_var);
+void            random_fill     (uint64_t *values, size_t n_values);
 
 
 // == Hashing ==
@@ -128,12 +129,16 @@ class KeccakF1600 {
     uint8_t             bytes[200];
     // __MMX__: __m64   V[25];
   } __attribute__ ((__aligned__ (16)));
+  static const uint8_t  rho_offsets_[25];
+  static const uint64_t round_constants_[255];
+  static bool   permute4_avx2 (KeccakF1600 *states, uint32_t n_rounds);
 public:
   explicit      KeccakF1600 ();                         ///< Zero the state.
   void          reset       ();                         ///< Zero the state.
   uint64_t&     operator[]  (int      index)       { return A[index]; }
   uint64_t      operator[]  (int      index) const { return A[index]; }
   void          permute     (uint32_t n_rounds);        ///< Apply Keccak permutation with @a n_rounds.
+  static void   permute4    (KeccakF1600 states[4], uint32_t n_rounds); ///< Permute 4 independent states at once.
   inline uint8_t&
   byte (size_t state_index)                             ///< Access byte 0..199 of the state.
   {
@@ -235,6 +240,8 @@ public:
   }
   /// Generate uniformly distributed 32 bit pseudo random number.
   result_type   operator() ()   { return random(); }
+  /// Fill the range [begin, end) with whole blocks of random values, yields the same sequence as random().
+  void          generate (uint64_t *begin, uint64_t *end);
   /// Fill the range [begin, end) with random unsigned integer values.
   template<typename RandomAccessIterator> void
   generate (RandomAccessIterator begin, RandomAccessIterator end)
@@ -35,6 +35,7 @@ typedef struct {
   bool pad;
 } Config;
 static Config config_init = { 0, 0 };
+static bool   store_raw = false;    // keep data uncompressed, e.g. for bundles that are used in place
 
 static inline void
 print_uchar (Config *config,
@@ -159,7 +160,7 @@ gen_zfile (const String &file)
    * 2) using compressed data requires runtime unpacking overhead and extra dynamic memory allocation,
    *    so it should provide a *significant* benefit if it's used.
    */
-  const bool compress_resource = clen <= 0.75 * dlen && clen + 1 < dlen;
+  const bool compress_resource = !store_raw && clen <= 0.75 * dlen && clen + 1 < dlen;
   const size_t rlen = compress_resource ? clen : dlen;
   const uint8 *rdata = rlen == dlen ? &vdata[0] : &cdata[0];
 
@@ -181,11 +182,12 @@ gen_zfile (const String &file)
 static int
 help (int exitcode)
 {
-  printf ("usage: rapidres [-h] [-v] [files...]\n");
+  printf ("usage: rapidres [-h] [-v] [-r] [files...]\n");
   if (exitcode != 0)
     exit (exitcode);
   printf ("  -h, --help    Print usage information\n");
   printf ("  -v, --version Print version and file paths\n");
+  printf ("  -r, --raw     Store files uncompressed\n");
   printf ("Generate compressed C source code for each file.\n");
   exit (0);
 }
@@ -210,6 +212,8 @@ main (int argc, char *argv[])
           printf ("information are available at http://rapicorn.org/.\n");
           exit (0);
 	}
+      else if (strcmp ("-r", argv[i]) == 0 || strcmp ("--raw", argv[i]) == 0)
+        store_raw = true;
       else
 	arg_strings.push_back (argv[i]);
     }
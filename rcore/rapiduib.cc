@@ -0,0 +1,81 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include "xmlnode.hh"
+#include "resources.hh"
+#include "../configure.h"
+#include <string.h>
+#include <errno.h>
+using namespace Rapicorn;
+
+/* rapiduib - compile UI XML files into binary bundles
+ * Bundles are loaded by XmlNode::load_bundle() without markup parsing, see rapidres --raw for embedding.
+ */
+
+static int
+help (int exitcode)
+{
+  printout ("usage: rapiduib [-h] [-v] [--wrap TAG] <input.xml> <output.uib>\n");
+  if (exitcode != 0)
+    exit (exitcode);
+  printout ("  -h, --help    Print usage information\n");
+  printout ("  -v, --version Print version and file paths\n");
+  printout ("  --wrap TAG    Wrap contents into <TAG/> unless it is the toplevel element\n");
+  printout ("Compile an XML file into a binary bundle for fast loading.\n");
+  exit (0);
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::vector<String> arg_strings;
+  String wrap_tag;
+
+  for (int i = 1; i < argc; i++)
+    {
+      if (strcmp ("-h", argv[i]) == 0 || strcmp ("--help", argv[i]) == 0)
+        {
+          return help (0);
+        }
+      else if (strcmp ("-v", argv[i]) == 0 || strcmp ("--version", argv[i]) == 0)
+        {
+          printout ("rapiduib (Rapicorn utilities) %s (Build ID: %s)\n", RAPICORN_VERSION, RapicornInternal::buildid());
+          printout ("This is free software and comes with ABSOLUTELY NO WARRANTY; see\n");
+          printout ("the source for copying conditions. Sources, examples and contact\n");
+          printout ("information are available at http://rapicorn.org/.\n");
+          exit (0);
+        }
+      else if (strcmp ("--wrap", argv[i]) == 0 && i + 1 < argc)
+        wrap_tag = argv[++i];
+      else
+        arg_strings.push_back (argv[i]);
+    }
+
+  if (arg_strings.size() != 2)
+    return help (1);
+
+  const String &input = arg_strings[0], &output = arg_strings[1];
+  Blob blob = Blob::load (input);
+  if (!blob)
+    {
+      printerr ("%s: failed to load: %s\n", input, strerror (errno));
+      return 1;
+    }
+  String pseudoroot;
+  const size_t estart = MarkupParser::seek_to_element (blob.data(), blob.size());
+  if (!wrap_tag.empty() && estart + 1 < blob.size() && blob.data()[estart + 1] != '?' &&
+      strncmp (blob.data() + estart + 1, wrap_tag.c_str(), wrap_tag.size()) != 0)
+    pseudoroot = wrap_tag;
+  MarkupParser::Error perror;
+  XmlNodeP xnode = XmlNode::parse_xml (input, blob.data(), blob.size(), &perror, pseudoroot);
+  if (perror.code || !xnode)
+    {
+      printerr ("%s:%d:%d: %s\n", input, perror.line_number, perror.char_number, perror.message);
+      return 1;
+    }
+  const String bundle = xnode->xml_bundle();
+  if (!Path::memwrite (output, bundle.size(), (const uint8*) bundle.data()))
+    {
+      printerr ("%s: failed to write: %s\n", output, strerror (errno));
+      return 1;
+    }
+  return 0;
+}
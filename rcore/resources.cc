@@ -7,6 +7,7 @@
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
+#include <unordered_map>
 
 #define DEBUG(...)      RAPICORN_KEY_DEBUG ("Res", __VA_ARGS__)
 
@@ -138,32 +139,62 @@ ByteBlob<Deleter>::string ()
 
 // == ResourceEntry ==
 #ifndef DOXYGEN
-static ResourceEntry *res_head = NULL;
+/* Entries are hashed into a fixed bucket table, so lookups walk short chains without locking.
+ * Writers are serialized by res_mutex and publish with release stores, unlinked entries keep
+ * their next pointer intact for readers that are still traversing.
+ */
+enum { RES_BUCKETS = 256 };
+static ResourceEntry *res_buckets[RES_BUCKETS];
 static Mutex          res_mutex;
 
+static inline ResourceEntry**
+res_bucket (const char *res_name)
+{
+  return &res_buckets[fnv1a_consthash64 (res_name) & (RES_BUCKETS - 1)];
+}
+
+// Decompressed blobs are shared while in use, weak references avoid pinning their memory.
+struct ResBlobCache {
+  Mutex                                                                   mutex;
+  std::unordered_map<const ResourceEntry*, std::weak_ptr<BlobResource>>   blobs;
+};
+
+static ResBlobCache&
+res_blob_cache()
+{
+  static ResBlobCache *cache = new ResBlobCache();      // never destroyed, entries unregister during static dtors
+  return *cache;
+}
+
 void
 ResourceEntry::reg_add (ResourceEntry *entry)
 {
   assert_return (entry && !entry->next);
   ScopedLock<Mutex> sl (res_mutex);
-  entry->next = res_head;
-  res_head = entry;
+  ResourceEntry **bucket = res_bucket (entry->name);
+  entry->next = *bucket;
+  __atomic_store_n (bucket, entry, __ATOMIC_RELEASE);
 }
 
 ResourceEntry::~ResourceEntry()
 {
-  ScopedLock<Mutex> sl (res_mutex);
-  ResourceEntry **ptr = &res_head;
-  while (*ptr != this)
-    ptr = &(*ptr)->next;
-  *ptr = next;
+  {
+    ScopedLock<Mutex> sl (res_mutex);
+    ResourceEntry **ptr = res_bucket (name);
+    while (*ptr != this)
+      ptr = &(*ptr)->next;
+    __atomic_store_n (ptr, next, __ATOMIC_RELEASE);
+  }
+  ResBlobCache &cache = res_blob_cache();
+  ScopedLock<Mutex> sl (cache.mutex);
+  cache.blobs.erase (this);
 }
 
 const ResourceEntry*
 ResourceEntry::find_entry (const String &res_name)
 {
-  ScopedLock<Mutex> sl (res_mutex);
-  for (const ResourceEntry *e = res_head; e; e = e->next)
+  const ResourceEntry *e = __atomic_load_n (res_bucket (res_name.c_str()), __ATOMIC_ACQUIRE);
+  for (; e; e = __atomic_load_n (&e->next, __ATOMIC_ACQUIRE))
     if (res_name == e->name)
       return e;
   return NULL;
@@ -250,10 +281,25 @@ Blob::asres (const String &resource)
   // blob from compressed resources
   if (entry && entry->psize < entry->dsize)
     {
+      ResBlobCache &cache = res_blob_cache();
+      {
+        ScopedLock<Mutex> sl (cache.mutex);
+        auto it = cache.blobs.find (entry);
+        std::shared_ptr<BlobResource> blob = it != cache.blobs.end() ? it->second.lock() : nullptr;
+        if (blob)
+          return Blob (blob);
+      }
       const uint8 *u8data = zintern_decompress (entry->dsize, reinterpret_cast<const uint8*> (entry->pdata), entry->psize);
       const char *data = reinterpret_cast<const char*> (u8data);
       struct ZinternDeleter { void operator() (const char *d) { zintern_free ((uint8*) d); } };
-      return Blob (std::make_shared<ByteBlob<ZinternDeleter>> (resource, entry->dsize, data, ZinternDeleter()));
+      std::shared_ptr<BlobResource> blob = std::make_shared<ByteBlob<ZinternDeleter>> (resource, entry->dsize, data, ZinternDeleter());
+      ScopedLock<Mutex> sl (cache.mutex);
+      std::weak_ptr<BlobResource> &cached = cache.blobs[entry];
+      std::shared_ptr<BlobResource> other = cached.lock();
+      if (other)                // concurrent inflation, share the copy that was cached first
+        return Blob (other);
+      cached = blob;
+      return Blob (blob);
     }
   // handle resource errors
   return error_result (resource, ENOENT, String (entry ? "invalid" : "unknown") + " resource entry");
@@ -5,6 +5,7 @@
 
 #include <cstring>
 #include <cmath>
+#include <cfloat>
 #include <stdio.h>
 #include <stdlib.h>
 #include <libintl.h>
@@ -367,6 +368,32 @@ string_from_bool (bool value)
   return String (value ? "1" : "0");
 }
 
+// Parse up to @a max_digits decimal or hex digits without locale or errno overhead, NULL on bail out.
+static inline const char*
+parse_digits_fast (const char *p, bool hex, uint max_digits, uint64 *result)
+{
+  const char *const start = p;
+  uint64 v = 0;
+  if (hex)
+    for (;; p++)
+      {
+        const uint c = uint8 (*p), d = c - '0', x = (c | 0x20) - 'a';
+        if (d < 10)
+          v = (v << 4) + d;
+        else if (x < 6)
+          v = (v << 4) + 10 + x;
+        else
+          break;
+      }
+  else
+    for (uint d = uint8 (*p) - '0'; d < 10; d = uint8 (*++p) - '0')
+      v = v * 10 + d;
+  if (p == start || size_t (p - start) > max_digits)
+    return NULL;        // leave signs, overflow and odd syntax to strtoull/strtoll
+  *result = v;
+  return p;
+}
+
 /// Parse a string into a 64bit unsigned integer, optionally specifying the expected number base.
 uint64
 string_to_uint (const String &string, size_t *consumed, uint base)
@@ -376,23 +403,44 @@ string_to_uint (const String &string, size_t *consumed, uint base)
     p++;
   const bool hex = p[0] == '0' && (p[1] == 'X' || p[1] == 'x');
   const char *const number = hex ? p + 2 : p;
-  char *endptr = NULL;
-  const uint64 result = strtoull (number, &endptr, hex ? 16 : base);
+  uint64 result = 0;
+  const char *end = hex || base == 10 ? parse_digits_fast (number, hex, hex ? 16 : 19, &result) : NULL;
+  if (!end)
+    {
+      char *endptr = NULL;
+      result = strtoull (number, &endptr, hex ? 16 : base);
+      end = endptr;
+    }
   if (consumed)
     {
-      if (!endptr || endptr <= number)
+      if (!end || end <= number)
         *consumed = 0;
       else
-        *consumed = endptr - start;
+        *consumed = end - start;
     }
   return result;
 }
 
+// Write the decimal digits of @a value backwards, ending right before @a end.
+static inline char*
+uint_to_digits (char *end, uint64 value)
+{
+  do
+    {
+      *--end = '0' + value % 10;
+      value /= 10;
+    }
+  while (value);
+  return end;
+}
+
 /// Convert a 64bit unsigned integer into a string.
 String
 string_from_uint (uint64 value)
 {
-  return string_format ("%u", value);
+  char buffer[24], *const end = buffer + sizeof (buffer);
+  const char *const digits = uint_to_digits (end, value);
+  return String (digits, end - digits);
 }
 
 /// Checks if a string contains a digit, optionally preceeded by whitespaces.
@@ -414,14 +462,29 @@ string_to_int (const String &string, size_t *consumed, uint base)
     p++;
   const bool hex = p[0] == '0' && (p[1] == 'X' || p[1] == 'x');
   const char *const number = hex ? p + 2 : p;
-  char *endptr = NULL;
-  const int64 result = strtoll (number, &endptr, hex ? 16 : base);
+  int64 result = 0;
+  const char *end = NULL;
+  if (hex || base == 10)
+    {
+      const bool negate = !hex && number[0] == '-';
+      const char *const digits = number + (negate || (!hex && number[0] == '+'));
+      uint64 u;
+      end = parse_digits_fast (digits, hex, hex ? 15 : 18, &u);
+      if (end)
+        result = negate ? -int64 (u) : int64 (u);
+    }
+  if (!end)
+    {
+      char *endptr = NULL;
+      result = strtoll (number, &endptr, hex ? 16 : base);
+      end = endptr;
+    }
   if (consumed)
     {
-      if (!endptr || endptr <= number)
+      if (!end || end <= number)
         *consumed = 0;
       else
-        *consumed = endptr - start;
+        *consumed = end - start;
     }
   return result;
 }
@@ -430,7 +493,11 @@ string_to_int (const String &string, size_t *consumed, uint base)
 String
 string_from_int (int64 value)
 {
-  return string_format ("%d", value);
+  char buffer[24], *const end = buffer + sizeof (buffer);
+  char *digits = uint_to_digits (end, value < 0 ? -uint64 (value) : value);
+  if (value < 0)
+    *--digits = '-';
+  return String (digits, end - digits);
 }
 
 static long double
@@ -448,10 +515,94 @@ libc_strtold (const char *nptr, char **endptr)
   return result;
 }
 
+// Powers of ten that are exactly representable as long double (5^27 < 2^64) or double (5^22 < 2^53).
+static const long double exact_pow10[] = {
+  1e0L,  1e1L,  1e2L,  1e3L,  1e4L,  1e5L,  1e6L,  1e7L,  1e8L,  1e9L,  1e10L, 1e11L, 1e12L, 1e13L,
+  1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L, 1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L,
+};
+static const int    exact_pow10_max = LDBL_MANT_DIG >= 64 ? 27 : 22;
+static const uint64 exact_mantissa_max = LDBL_MANT_DIG >= 64 ? ~uint64 (0) : uint64 (1) << 53;
+
+/* Parse plain decimal numbers like "-12.5e3" without locale switching, returns NULL for anything else.
+ * Significand and power of ten are exact, so one multiplication or division yields the correctly rounded
+ * result (Clinger's fast path). Long significands, large exponents, hex, inf and nan are left to strtold.
+ */
+static const char*
+parse_decimal_fast (const char *p, long double *result)
+{
+  while (*p == ' ' || (*p >= '\t' && *p <= '\r'))
+    p++;
+  const bool negate = *p == '-';
+  p += negate || *p == '+';
+  const char *const start = p;
+  uint64 mantissa = 0;
+  int exponent = 0, n_significant = 0;
+  for (uint d = uint8 (*p) - '0'; d < 10; d = uint8 (*++p) - '0')
+    {
+      mantissa = mantissa * 10 + d;
+      n_significant += mantissa != 0;
+    }
+  const bool int_digits = p > start;
+  if (*p == '.')
+    {
+      const char *const fraction = ++p;
+      for (uint d = uint8 (*p) - '0'; d < 10; d = uint8 (*++p) - '0')
+        {
+          mantissa = mantissa * 10 + d;
+          n_significant += mantissa != 0;
+        }
+      exponent = fraction - p;
+      if (!int_digits && p == fraction)
+        return NULL;
+    }
+  else if (!int_digits)
+    return NULL;
+  else if (*p == 'x' || *p == 'X')
+    return NULL;                // hexadecimal float
+  if (n_significant > 19 || mantissa > exact_mantissa_max)
+    return NULL;
+  if (*p == 'e' || *p == 'E')
+    {
+      const char *e = p + 1;
+      const bool eneg = *e == '-';
+      e += eneg || *e == '+';
+      const char *const edigits = e;
+      int ev = 0;
+      for (uint d = uint8 (*e) - '0'; d < 10 && e - edigits < 4; d = uint8 (*++e) - '0')
+        ev = ev * 10 + d;
+      if (e - edigits >= 4 && uint8 (*e) - '0' < 10)
+        return NULL;
+      if (e > edigits)
+        {
+          exponent += eneg ? -ev : ev;
+          p = e;
+        }
+    }
+  long double v = mantissa;
+  if (mantissa == 0)
+    ;
+  else if (exponent < 0 && exponent >= -exact_pow10_max)
+    v /= exact_pow10[-exponent];
+  else if (exponent >= 0 && exponent <= exact_pow10_max)
+    v *= exact_pow10[exponent];
+  else
+    return NULL;
+  *result = negate ? -v : v;
+  return p;
+}
+
 /// Parse a double from a string ala strtod(), trying locale specific characters and POSIX/C formatting.
 long double
 posix_locale_strtold (const char *nptr, char **endptr)
 {
+  long double fast;
+  const char *fast_end = parse_decimal_fast (nptr, &fast);
+  if (fast_end)
+    {
+      if (endptr)
+        *endptr = const_cast<char*> (fast_end);
+      return fast;
+    }
   ScopedPosixLocale posix_locale_scope; // pushes POSIX/C locale for this scope
   char *fail_pos = NULL;
   const long double val = libc_strtold (nptr, &fail_pos);
@@ -507,7 +658,176 @@ string_from_float (float value)
   return string_format ("%.7g", value);
 }
 
-/// Convert a double into a string, using the POSIX/C locale.
+namespace { // Grisu2, see Florian Loitsch: "Printing Floating-Point Numbers Quickly and Accurately with Integers"
+
+struct DiyFp {
+  uint64 f;
+  int    e;
+};
+
+static inline DiyFp
+diyfp_sub (DiyFp x, DiyFp y)
+{
+  return DiyFp { x.f - y.f, x.e };
+}
+
+// Upper 64 bits of the rounded 128bit product.
+static inline DiyFp
+diyfp_mul (DiyFp x, DiyFp y)
+{
+  const uint64 xlo = x.f & 0xffffffff, xhi = x.f >> 32, ylo = y.f & 0xffffffff, yhi = y.f >> 32;
+  const uint64 p0 = xlo * ylo, p1 = xlo * yhi, p2 = xhi * ylo, p3 = xhi * yhi;
+  const uint64 mid = (p0 >> 32) + (p1 & 0xffffffff) + (p2 & 0xffffffff) + (uint64 (1) << 31);
+  return DiyFp { p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32), x.e + y.e + 64 };
+}
+
+static inline DiyFp
+diyfp_normalize (DiyFp x)
+{
+  const int shift = __builtin_clzll (x.f);
+  return DiyFp { x.f << shift, x.e - shift };
+}
+
+// Normalized 64bit approximations of 10^k for k = -300, -292, …, 324, generated with exact integer arithmetic.
+struct CachedPower {
+  uint64 f;
+  int    e, k;
+};
+static const CachedPower cached_powers[] = {
+  { 0xab70fe17c79ac6ca, -1060, -300 }, { 0xff77b1fcbebcdc4f, -1034, -292 },
+  { 0xbe5691ef416bd60c, -1007, -284 }, { 0x8dd01fad907ffc3c,  -980, -276 },
+  { 0xd3515c2831559a83,  -954, -268 }, { 0x9d71ac8fada6c9b5,  -927, -260 },
+  { 0xea9c227723ee8bcb,  -901, -252 }, { 0xaecc49914078536d,  -874, -244 },
+  { 0x823c12795db6ce57,  -847, -236 }, { 0xc21094364dfb5637,  -821, -228 },
+  { 0x9096ea6f3848984f,  -794, -220 }, { 0xd77485cb25823ac7,  -768, -212 },
+  { 0xa086cfcd97bf97f4,  -741, -204 }, { 0xef340a98172aace5,  -715, -196 },
+  { 0xb23867fb2a35b28e,  -688, -188 }, { 0x84c8d4dfd2c63f3b,  -661, -180 },
+  { 0xc5dd44271ad3cdba,  -635, -172 }, { 0x936b9fcebb25c996,  -608, -164 },
+  { 0xdbac6c247d62a584,  -582, -156 }, { 0xa3ab66580d5fdaf6,  -555, -148 },
+  { 0xf3e2f893dec3f126,  -529, -140 }, { 0xb5b5ada8aaff80b8,  -502, -132 },
+  { 0x87625f056c7c4a8b,  -475, -124 }, { 0xc9bcff6034c13053,  -449, -116 },
+  { 0x964e858c91ba2655,  -422, -108 }, { 0xdff9772470297ebd,  -396, -100 },
+  { 0xa6dfbd9fb8e5b88f,  -369,  -92 }, { 0xf8a95fcf88747d94,  -343,  -84 },
+  { 0xb94470938fa89bcf,  -316,  -76 }, { 0x8a08f0f8bf0f156b,  -289,  -68 },
+  { 0xcdb02555653131b6,  -263,  -60 }, { 0x993fe2c6d07b7fac,  -236,  -52 },
+  { 0xe45c10c42a2b3b06,  -210,  -44 }, { 0xaa242499697392d3,  -183,  -36 },
+  { 0xfd87b5f28300ca0e,  -157,  -28 }, { 0xbce5086492111aeb,  -130,  -20 },
+  { 0x8cbccc096f5088cc,  -103,  -12 }, { 0xd1b71758e219652c,   -77,   -4 },
+  { 0x9c40000000000000,   -50,    4 }, { 0xe8d4a51000000000,   -24,   12 },
+  { 0xad78ebc5ac620000,     3,   20 }, { 0x813f3978f8940984,    30,   28 },
+  { 0xc097ce7bc90715b3,    56,   36 }, { 0x8f7e32ce7bea5c70,    83,   44 },
+  { 0xd5d238a4abe98068,   109,   52 }, { 0x9f4f2726179a2245,   136,   60 },
+  { 0xed63a231d4c4fb27,   162,   68 }, { 0xb0de65388cc8ada8,   189,   76 },
+  { 0x83c7088e1aab65db,   216,   84 }, { 0xc45d1df942711d9a,   242,   92 },
+  { 0x924d692ca61be758,   269,  100 }, { 0xda01ee641a708dea,   295,  108 },
+  { 0xa26da3999aef774a,   322,  116 }, { 0xf209787bb47d6b85,   348,  124 },
+  { 0xb454e4a179dd1877,   375,  132 }, { 0x865b86925b9bc5c2,   402,  140 },
+  { 0xc83553c5c8965d3d,   428,  148 }, { 0x952ab45cfa97a0b3,   455,  156 },
+  { 0xde469fbd99a05fe3,   481,  164 }, { 0xa59bc234db398c25,   508,  172 },
+  { 0xf6c69a72a3989f5c,   534,  180 }, { 0xb7dcbf5354e9bece,   561,  188 },
+  { 0x88fcf317f22241e2,   588,  196 }, { 0xcc20ce9bd35c78a5,   614,  204 },
+  { 0x98165af37b2153df,   641,  212 }, { 0xe2a0b5dc971f303a,   667,  220 },
+  { 0xa8d9d1535ce3b396,   694,  228 }, { 0xfb9b7cd9a4a7443c,   720,  236 },
+  { 0xbb764c4ca7a44410,   747,  244 }, { 0x8bab8eefb6409c1a,   774,  252 },
+  { 0xd01fef10a657842c,   800,  260 }, { 0x9b10a4e5e9913129,   827,  268 },
+  { 0xe7109bfba19c0c9d,   853,  276 }, { 0xac2820d9623bf429,   880,  284 },
+  { 0x80444b5e7aa7cf85,   907,  292 }, { 0xbf21e44003acdd2d,   933,  300 },
+  { 0x8e679c2f5e44ff8f,   960,  308 }, { 0xd433179d9c8cb841,   986,  316 },
+  { 0x9e19db92b4e31ba9,  1013,  324 },
+};
+
+// Find c = 10^k with -60 <= e + c.e + 64 <= -32, so the scaled boundaries split into 32bit integer and fraction parts.
+static inline const CachedPower&
+cached_power_for (int e)
+{
+  const int f = -60 - e - 1;
+  const int k = (f * 78913) / (1 << 18) + (f > 0);   // ceil (f * log10 (2))
+  const int index = (300 + k + 7) / 8;
+  return cached_powers[index];
+}
+
+static inline void
+grisu2_round (char *buffer, int length, uint64 dist, uint64 delta, uint64 rest, uint64 ten_k)
+{
+  // move the last digit towards w as long as the result stays within the rounding interval
+  while (rest < dist && delta - rest >= ten_k && (rest + ten_k < dist || dist - rest > rest + ten_k - dist))
+    {
+      buffer[length - 1]--;
+      rest += ten_k;
+    }
+}
+
+// Generate the shortest digits of a value within (minus, plus) that is closest to w, returns the digit count.
+static int
+grisu2_digits (char *buffer, int *decimal_exponent, DiyFp minus, DiyFp w, DiyFp plus)
+{
+  static const uint32 pow10_32[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+  uint64 delta = diyfp_sub (plus, minus).f, dist = diyfp_sub (plus, w).f;
+  const int shift = -plus.e;
+  const uint64 one = uint64 (1) << shift;
+  uint32 p1 = plus.f >> shift;
+  uint64 p2 = plus.f & (one - 1);
+  int n = 10;
+  while (n > 1 && p1 < pow10_32[n - 1])
+    n--;
+  int length = 0;
+  while (n > 0)         // integral digits
+    {
+      const uint32 pow10 = pow10_32[--n];
+      buffer[length++] = '0' + p1 / pow10;
+      p1 %= pow10;
+      const uint64 rest = (uint64 (p1) << shift) + p2;
+      if (rest <= delta)
+        {
+          *decimal_exponent += n;
+          grisu2_round (buffer, length, dist, delta, rest, uint64 (pow10) << shift);
+          return length;
+        }
+    }
+  int m = 0;
+  do                    // fractional digits
+    {
+      p2 *= 10;
+      buffer[length++] = '0' + (p2 >> shift);
+      p2 &= one - 1;
+      m++;
+      delta *= 10;
+      dist *= 10;
+    }
+  while (p2 > delta);
+  *decimal_exponent -= m;
+  grisu2_round (buffer, length, dist, delta, p2, one);
+  return length;
+}
+
+// Shortest decimal digits of a positive finite @a value that read back correctly, @a buffer needs 17 bytes.
+static int
+double_to_shortest (char *buffer, int *decimal_exponent, double value)
+{
+  uint64 bits;
+  memcpy (&bits, &value, sizeof (bits));
+  const uint64 fraction = bits & ((uint64 (1) << 52) - 1);
+  const int biased = bits >> 52;
+  const DiyFp v = biased ? DiyFp { fraction + (uint64 (1) << 52), biased - 1075 } : DiyFp { fraction, 1 - 1075 };
+  // rounding interval boundaries, the lower one is closer at powers of two
+  const DiyFp plus = diyfp_normalize (DiyFp { 2 * v.f + 1, v.e - 1 });
+  DiyFp minus = fraction == 0 && biased > 1 ? DiyFp { 4 * v.f - 1, v.e - 2 } : DiyFp { 2 * v.f - 1, v.e - 1 };
+  minus = DiyFp { minus.f << (minus.e - plus.e), plus.e };
+  const CachedPower &cached = cached_power_for (plus.e);
+  const DiyFp c { cached.f, cached.e };
+  const DiyFp w = diyfp_mul (diyfp_normalize (v), c), wminus = diyfp_mul (minus, c), wplus = diyfp_mul (plus, c);
+  *decimal_exponent = -cached.k;
+  // shrink the interval by one unit on each side to account for the multiplication errors
+  return grisu2_digits (buffer, decimal_exponent, DiyFp { wminus.f + 1, wminus.e }, w, DiyFp { wplus.f - 1, wplus.e });
+}
+
+} // Anon
+
+/** Convert a double into a string that reads back as @a value, using the POSIX/C locale.
+ * The digits are generated with Grisu2, which yields the shortest representation for all but a few
+ * values per mille (those get one extra digit). The layout follows "%.17g", i.e. exponential notation
+ * is used for decimal exponents below -4 or above 16.
+ */
 String
 string_from_double (double value)
 {
@@ -515,7 +835,59 @@ string_from_double (double value)
     return std::signbit (value) ? "-NaN" : "+NaN";
   if (std::isinf (value))
     return std::signbit (value) ? "-Infinity" : "+Infinity";
-  return string_format ("%.17g", value);
+  char buffer[48], *p = buffer;
+  if (std::signbit (value))
+    *p++ = '-';
+  if (value == 0)
+    {
+      *p++ = '0';
+      return String (buffer, p - buffer);
+    }
+  char digits[20];
+  int k;
+  const int n = double_to_shortest (digits, &k, fabs (value));
+  const int x = n + k - 1;      // exponent in scientific notation
+  if (x < -4 || x >= 17)
+    {
+      *p++ = digits[0];
+      if (n > 1)
+        {
+          *p++ = '.';
+          memcpy (p, digits + 1, n - 1);
+          p += n - 1;
+        }
+      *p++ = 'e';
+      *p++ = x < 0 ? '-' : '+';
+      const int ax = x < 0 ? -x : x;
+      if (ax >= 100)
+        *p++ = '0' + ax / 100;
+      *p++ = '0' + ax / 10 % 10;
+      *p++ = '0' + ax % 10;
+    }
+  else if (k >= 0)              // integer
+    {
+      memcpy (p, digits, n);
+      memset (p + n, '0', k);
+      p += n + k;
+    }
+  else if (x >= 0)              // ddd.ddd
+    {
+      memcpy (p, digits, x + 1);
+      p += x + 1;
+      *p++ = '.';
+      memcpy (p, digits + x + 1, n - x - 1);
+      p += n - x - 1;
+    }
+  else                          // 0.000ddd
+    {
+      *p++ = '0';
+      *p++ = '.';
+      memset (p, '0', -x - 1);
+      p += -x - 1;
+      memcpy (p, digits, n);
+      p += n;
+    }
+  return String (buffer, p - buffer);
 }
 
 /// Parse a string into a list of doubles, expects ';' as delimiter.
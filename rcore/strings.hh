@@ -29,6 +29,8 @@ bool    		       cstring_to_bool       (const char *string, bool fallback = fals
 // == String Formatting ==
 template<class... Args> String string_format         (const char *format, const Args &...args) RAPICORN_PRINTF (1, 0);
 template<class... Args> String string_locale_format  (const char *format, const Args &...args) RAPICORN_PRINTF (1, 0);
+template<class... Args> void   string_format_append  (String &string, const char *format, const Args &...args) RAPICORN_PRINTF (2, 0);
+template<class... Args> const char* string_format_to (Lib::FormatBuffer &buffer, const char *format, const Args &...args) RAPICORN_PRINTF (2, 0);
 String                         string_vprintf        (const char *format, va_list vargs);
 String                         string_locale_vprintf (const char *format, va_list vargs);
 
@@ -190,6 +192,23 @@ string_locale_format (const char *format, const Args &...args)
   return Lib::StringFormatter::format<Lib::StringFormatter::CURRENT_LOCALE> (NULL, format, args...);
 }
 
+/// Formatted printing ala printf() appended to @a string, using the POSIX/C locale.
+template<class... Args> RAPICORN_NOINLINE void
+string_format_append (String &string, const char *format, const Args &...args)
+{
+  Lib::StackFormatBuffer<256> buffer;
+  Lib::StringFormatter::format_to (buffer, NULL, format, args...);
+  string.append (buffer.data(), buffer.size());
+}
+
+/// Formatted printing ala printf() appended to @a buffer, using the POSIX/C locale, returns buffer.c_str().
+template<class... Args> RAPICORN_NOINLINE const char*
+string_format_to (Lib::FormatBuffer &buffer, const char *format, const Args &...args)
+{
+  Lib::StringFormatter::format_to (buffer, NULL, format, args...);
+  return buffer.c_str();
+}
+
 } // Rapicorn
 
 namespace RapicornInternal {
@@ -444,4 +444,302 @@ test_bindings()
 }
 REGISTER_TEST ("Aida/Bindings", test_bindings);
 
+// == Remote reference collection ==
+enum : uint64 {
+  GC_HASH_HI = 0x7e57a1dac0de0000ULL,   // test method hashes, GC_HASH_HI + one of the following
+  GC_FETCH = 1, GC_PERSIST, GC_RESEND, GC_SIGNAL, GC_ECHO, GC_QUIT,
+};
+struct GcHandle : RemoteHandle {
+  GcHandle () : RemoteHandle() {}
+  static GcHandle down_cast (RemoteHandle rhandle) { GcHandle h; h.__aida_upgrade_from__ (rhandle); return h; }
+};
+static const char          *gc_protocol = "inproc://aida-test-gc";
+static MainLoop            *gc_server_loop = NULL;
+static std::vector<std::weak_ptr<OneIface>> gc_fetched;        // objects only kept alive by remote references
+static std::vector<OneIfaceP> gc_persistent;
+static size_t               gc_handler_id = 0;
+
+static ProtoMsg*
+gc_server_fetch (ProtoReader &fbr)
+{
+  fbr.skip_header();
+  AIDA_ASSERT (fbr.pop_instance<OneIface>() != NULL);
+  const int64 n = fbr.pop_int64();
+  ProtoMsg &rb = *ProtoMsg::renew_into_result (fbr, MSGID_CALL_RESULT, GC_HASH_HI, GC_FETCH, 1 + n);
+  rb <<= n;
+  for (int64 i = 0; i < n; i++)
+    {
+      OneIfaceP object = std::make_shared<OneIface> (gc_fetched.size());
+      gc_fetched.push_back (object);
+      rb <<= object.get();
+    }
+  return &rb;
+}
+
+static ProtoMsg*
+gc_server_persist (ProtoReader &fbr)
+{
+  fbr.skip_header();
+  AIDA_ASSERT (fbr.pop_instance<OneIface>() != NULL);
+  const int64 index = fbr.pop_int64();
+  while (gc_persistent.size() <= size_t (index))
+    gc_persistent.push_back (std::make_shared<OneIface> (-1 - gc_persistent.size()));
+  ProtoMsg &rb = *ProtoMsg::renew_into_result (fbr, MSGID_CALL_RESULT, GC_HASH_HI, GC_PERSIST, 1);
+  rb <<= gc_persistent[index].get();
+  return &rb;
+}
+
+static ProtoMsg*
+gc_server_resend (ProtoReader &fbr)     // emits a persistent object, then returns it
+{
+  ProtoMsg *rb = gc_server_persist (fbr);
+  ProtoMsg &pm = *ProtoMsg::_new (3 + 1 + 1);
+  ProtoScopeEmit1Way scope (pm, ProtoScope::current_server_connection(), GC_HASH_HI, GC_SIGNAL);
+  pm <<= gc_handler_id;
+  pm <<= gc_persistent[0].get();
+  scope.post_peer_msg (&pm);
+  return rb;
+}
+
+static ProtoMsg*
+gc_server_connect (ProtoReader &fbr)
+{
+  fbr.skip_header();
+  AIDA_ASSERT (fbr.pop_instance<OneIface>() != NULL);
+  const uint64 handler_id = fbr.pop_int64(), signal_connection = fbr.pop_int64();
+  if (handler_id)
+    gc_handler_id = handler_id;
+  else if (signal_connection)
+    gc_handler_id = 0;
+  ProtoMsg &rb = *ProtoMsg::renew_into_result (fbr, MSGID_CONNECT_RESULT, GC_HASH_HI, GC_SIGNAL, 1);
+  rb <<= uint64 (1);
+  return &rb;
+}
+
+static ProtoMsg*
+gc_server_echo (ProtoReader &fbr)       // reports whether the server resolves an orbid
+{
+  fbr.skip_header();
+  AIDA_ASSERT (fbr.pop_instance<OneIface>() != NULL);
+  const bool resolved = fbr.pop_instance<ImplicitBase>() != NULL;
+  ProtoMsg &rb = *ProtoMsg::renew_into_result (fbr, MSGID_CALL_RESULT, GC_HASH_HI, GC_ECHO, 1);
+  rb <<= resolved;
+  return &rb;
+}
+
+static ProtoMsg*
+gc_server_quit (ProtoReader &fbr)
+{
+  gc_server_loop->quit();
+  return NULL;
+}
+
+static const ServerConnection::MethodEntry gc_server_methods[] = {
+  { GC_HASH_HI, GC_FETCH,   gc_server_fetch, },
+  { GC_HASH_HI, GC_PERSIST, gc_server_persist, },
+  { GC_HASH_HI, GC_RESEND,  gc_server_resend, },
+  { GC_HASH_HI, GC_SIGNAL,  gc_server_connect, },
+  { GC_HASH_HI, GC_ECHO,    gc_server_echo, },
+  { GC_HASH_HI, GC_QUIT,    gc_server_quit, },
+};
+static ServerConnection::MethodRegistry gc_server_registry (gc_server_methods);
+
+class GcServerSource : public EventSource {
+  ServerConnection &connection_;
+  PollFD            pfd_;
+public:
+  GcServerSource (ServerConnection &connection) :
+    connection_ (connection)
+  {
+    pfd_.fd = connection_.notify_fd();
+    pfd_.events = PollFD::IN;
+    pfd_.revents = 0;
+    add_poll (&pfd_);
+  }
+  virtual bool prepare  (const LoopState &state, int64 *timeout_usecs_p) override { return connection_.pending(); }
+  virtual bool check    (const LoopState &state) override                         { return connection_.pending(); }
+  virtual bool dispatch (const LoopState &state) override                         { connection_.dispatch(); return true; }
+};
+
+static void
+gc_server_thread (AsyncBlockingQueue<String> *notify_queue)
+{
+  MainLoopP loop = MainLoop::create();
+  gc_server_loop = loop.get();
+  ServerConnectionP connection = ServerConnection::bind<OneIface> (gc_protocol, std::make_shared<OneIface> (0));
+  TASSERT (connection != NULL);
+  loop->add (std::make_shared<GcServerSource> (*connection));
+  loop->exec_now ([notify_queue] () { notify_queue->push ("OK"); });
+  loop->run();
+  new ServerConnectionP (connection);   // leak, ~ServerConnection is unsupported
+  gc_server_loop = NULL;
+  loop->destroy_loop();
+}
+
+static std::vector<GcHandle>
+gc_fetch (const GcHandle &origin, uint method, int64 n, int64 n_pop)
+{
+  ProtoMsg &fb = *ProtoMsg::_new (3 + 1 + 1);
+  ProtoScopeCall2Way scope (fb, origin, GC_HASH_HI, method);
+  fb <<= n;
+  ProtoMsg *fr = scope.invoke (&fb);
+  ProtoReader frr (*fr);
+  frr.skip_header();
+  if (method == GC_FETCH)
+    TCMP (frr.pop_int64(), ==, n);
+  std::vector<GcHandle> handles (n_pop);
+  for (int64 i = 0; i < n_pop; i++)
+    frr >>= handles[i];         // ids that are not popped never reach a RemoteHandle
+  delete fr;
+  return handles;
+}
+
+static bool
+gc_echo (const GcHandle &origin, uint64 orbid)
+{
+  ProtoMsg &fb = *ProtoMsg::_new (3 + 1 + 1);
+  ProtoScopeCall2Way scope (fb, origin, GC_HASH_HI, GC_ECHO);
+  fb.add_orbid (orbid);
+  ProtoMsg *fr = scope.invoke (&fb);
+  ProtoReader frr (*fr);
+  frr.skip_header();
+  const bool resolved = frr.pop_bool();
+  delete fr;
+  return resolved;
+}
+
+static void
+gc_sync (ClientConnection &connection, const GcHandle &origin)
+{
+  gc_echo (origin, origin.__aida_orbid__());    // flushes releases, the server handles them before replying
+  while (connection.pending())
+    connection.dispatch();                      // emissions and sweeps
+}
+
+static ProtoMsg*
+gc_signal_handler (const ProtoMsg *fb, void *data)
+{
+  if (!fb)
+    return NULL;                                // handler deletion hook
+  ProtoReader fbr (*fb);
+  fbr.skip_header();
+  fbr.skip();                                   // handler id
+  GcHandle handle;
+  fbr >>= handle;
+  ((std::vector<GcHandle>*) data)->push_back (handle);
+  return NULL;
+}
+
+static uint64
+gc_persist_orbid (const GcHandle &origin, int64 index)
+{
+  return gc_fetch (origin, GC_PERSIST, index, 1)[0].__aida_orbid__();
+}
+
+static void
+test_remote_gc()
+{
+  AsyncBlockingQueue<String> notify_queue;
+  std::thread sthread (gc_server_thread, &notify_queue);
+  TCMP (notify_queue.pop(), ==, "OK");
+  ClientConnectionP connection = ClientConnection::connect (gc_protocol);
+  TASSERT (connection != NULL);
+  GcHandle origin = connection->remote_origin<GcHandle>();
+  TASSERT (origin != NULL);
+  // purge: released handles free server objects
+  std::vector<GcHandle> handles = gc_fetch (origin, GC_FETCH, 3, 3);
+  TASSERT (handles[0] != NULL && handles[0] != handles[1] && handles[1] != handles[2]);
+  TASSERT (!gc_fetched[0].expired() && !gc_fetched[1].expired() && !gc_fetched[2].expired());
+  handles.resize (1);
+  gc_sync (*connection, origin);
+  TASSERT (!gc_fetched[0].expired() && gc_fetched[1].expired() && gc_fetched[2].expired());
+  handles.clear();
+  gc_sync (*connection, origin);
+  TASSERT (gc_fetched[0].expired());
+  // retain: an emitted copy is still in transit while the returned copy is released
+  std::vector<GcHandle> emitted;
+  const size_t handler_id = connection->signal_connect (GC_HASH_HI, GC_SIGNAL, origin, gc_signal_handler, &emitted);
+  TASSERT (handler_id > 0);
+  uint64 orbid;
+  {
+    std::vector<GcHandle> resent = gc_fetch (origin, GC_RESEND, 0, 1);  // emission is queued before the result
+    orbid = resent[0].__aida_orbid__();
+    TASSERT (connection->pending());
+  }
+  TCMP (gc_persist_orbid (origin, 0), ==, orbid);       // retained, so the orbid remains valid
+  // late release: the emitted copy is released after the returned copies
+  while (connection->pending())
+    connection->dispatch();
+  TCMP (emitted.size(), ==, 1);
+  TCMP (emitted[0].__aida_orbid__(), ==, orbid);
+  emitted.clear();
+  const uint64 orbid2 = gc_persist_orbid (origin, 0);   // purged before, so a new orbid is assigned
+  TCMP (orbid2, !=, orbid);
+  gc_sync (*connection, origin);
+  // sweep: ids that the client never popped are expired, claimed ids are kept
+  GcHandle held = gc_fetch (origin, GC_PERSIST, 0, 1)[0];
+  const size_t n_fetched = gc_fetched.size(), n_lost = 1500;
+  handles = gc_fetch (origin, GC_FETCH, n_lost, 1);     // exceeds the sweep threshold
+  for (size_t i = n_fetched; i < gc_fetched.size(); i++)
+    TASSERT (!gc_fetched[i].expired());
+  gc_sync (*connection, origin);                        // receives the sweep and replies
+  gc_sync (*connection, origin);                        // server has handled the claims
+  TASSERT (!gc_fetched[n_fetched].expired());
+  for (size_t i = n_fetched + 1; i < gc_fetched.size(); i++)
+    TASSERT (gc_fetched[i].expired());
+  TCMP (gc_persist_orbid (origin, 0), ==, held.__aida_orbid__());      // claimed copies are kept
+  handles.clear();
+  gc_sync (*connection, origin);
+  TASSERT (gc_fetched[n_fetched].expired());
+  const uint64 held_orbid = held.__aida_orbid__();
+  held = GcHandle();
+  gc_sync (*connection, origin);
+  TCMP (gc_persist_orbid (origin, 0), !=, held_orbid);  // claim and release counts balanced
+  // sweep in transit: handles received between the sweep and the claim are not claimed
+  held = gc_fetch (origin, GC_PERSIST, 0, 1)[0];
+  handles = gc_fetch (origin, GC_FETCH, n_lost, 0);     // sweep is posted after the result
+  {
+    std::vector<GcHandle> resent = gc_fetch (origin, GC_RESEND, 0, 1);  // receives sweep, emission, result
+    TCMP (resent[0].__aida_orbid__(), ==, held.__aida_orbid__());
+  }
+  gc_sync (*connection, origin);
+  TCMP (emitted.size(), ==, 1);
+  TCMP (emitted[0].__aida_orbid__(), ==, held.__aida_orbid__());
+  emitted.clear();
+  TCMP (gc_persist_orbid (origin, 0), ==, held.__aida_orbid__());      // kept by the claim
+  const uint64 resent_orbid = held.__aida_orbid__();
+  held = GcHandle();
+  gc_sync (*connection, origin);
+  TCMP (gc_persist_orbid (origin, 0), !=, resent_orbid);       // claimed counts exclude copies sent after the sweep
+  // stale orbids: slots released and reused later carry a new generation
+  handles = gc_fetch (origin, GC_FETCH, 64, 64);
+  std::vector<uint64> stale;
+  std::set<uint32> stale_slots;
+  for (const GcHandle &h : handles)
+    {
+      TASSERT (gc_echo (origin, h.__aida_orbid__()));
+      stale.push_back (h.__aida_orbid__());
+      stale_slots.insert (h.__aida_orbid__());          // counter bits of the orbid index the slot
+    }
+  handles.clear();
+  gc_sync (*connection, origin);
+  handles = gc_fetch (origin, GC_FETCH, 2048, 2048);    // drains the free list
+  size_t reused = 0;
+  for (const GcHandle &h : handles)
+    reused += stale_slots.count (h.__aida_orbid__());
+  TCMP (reused, >, 0);
+  for (uint64 stale_orbid : stale)
+    TASSERT (!gc_echo (origin, stale_orbid));           // must not resolve to the new slot contents
+  handles.clear();
+  gc_sync (*connection, origin);
+  // shutdown
+  connection->signal_disconnect (handler_id);
+  ProtoMsg &fb = *ProtoMsg::_new (3 + 1);
+  ProtoScopeCall1Way scope (fb, origin, GC_HASH_HI, GC_QUIT);
+  scope.invoke (&fb);
+  sthread.join();
+  new ClientConnectionP (connection);   // leak, ~ClientConnection is unsupported
+}
+REGISTER_TEST ("Aida/Remote Reference Collection", test_remote_gc);
+
 } // Anon
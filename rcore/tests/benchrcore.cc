@@ -3,6 +3,7 @@
 #include <rcore/randomhash.hh>
 #include <random>
 #include <array>
+#include <algorithm>
 
 using namespace Rapicorn;
 
@@ -274,6 +275,34 @@ random_hash_benchmarks()
   bench_time = timer.benchmark (kc);
   TPASS ("KeccakCryptoRng # size=%-4zd timing: fastest=%fs throughput=%.1fMB/s\n", sizeof (kc), bench_time, kc.bytes_per_run() / bench_time / 1048576.);
 
+  constexpr int N_PERMUTES = 1024, STATE_BYTES = 200;
+  Lib::KeccakF1600 kstates[4];
+  auto keccak_permute = [&kstates] () {
+    for (size_t j = 0; j < N_PERMUTES; j++)
+      kstates[j & 3].permute (24);
+  };
+  bench_time = timer.benchmark (keccak_permute);
+  TPASS ("KeccakF1600     # size=%-4zd timing: fastest=%fs throughput=%.2fGB/s\n", sizeof (kstates[0]), bench_time, N_PERMUTES * STATE_BYTES / bench_time / 1073741824.);
+  auto keccak_permute4 = [&kstates] () {
+    for (size_t j = 0; j < N_PERMUTES; j += 4)
+      Lib::KeccakF1600::permute4 (kstates, 24);
+  };
+  bench_time = timer.benchmark (keccak_permute4);
+  TPASS ("KeccakF1600 x4  # size=%-4zd timing: fastest=%fs throughput=%.2fGB/s\n", sizeof (kstates), bench_time, N_PERMUTES * STATE_BYTES / bench_time / 1073741824.);
+  std::vector<uint64_t> fillbuffer (65536);
+  const size_t fill_bytes = fillbuffer.size() * sizeof (fillbuffer[0]);
+  KeccakFastRng kfr;
+  auto keccak_fast_generate = [&fillbuffer, &kfr] () {
+    kfr.generate (fillbuffer.data(), fillbuffer.data() + fillbuffer.size());
+  };
+  bench_time = timer.benchmark (keccak_fast_generate);
+  TPASS ("KeccakFast bulk # size=%-4zd timing: fastest=%fs throughput=%.2fGB/s\n", sizeof (KeccakFastRng), bench_time, fill_bytes / bench_time / 1073741824.);
+  auto random_fill_bench = [&fillbuffer] () {
+    random_fill (fillbuffer.data(), fillbuffer.size());
+  };
+  bench_time = timer.benchmark (random_fill_bench);
+  TPASS ("random_fill()   # size=%-4zd timing: fastest=%fs throughput=%.2fGB/s\n", fill_bytes, bench_time, fill_bytes / bench_time / 1073741824.);
+
   constexpr int N_RUNS = 1000, BLOCK = 256, N_BYTES = N_RUNS * BLOCK * sizeof (uint32_t) * 2; // * 2 counts bytes in + out
   const uint32_t mixinput[BLOCK] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, };
   uint32_t mixoutput[BLOCK];
@@ -427,6 +456,206 @@ test_keccak_prng()
 }
 REGISTER_TEST ("RandomGenerator/KeccakRng", test_keccak_prng);
 
+static void
+test_keccak_permute4()
+{
+  // permute4() must match 4 independent permute() calls, AVX2 or not
+  for (uint32_t n_rounds : { 1, 8, 13, 24 })
+    {
+      Lib::KeccakF1600 states[4], refs[4];
+      for (size_t j = 0; j < 4; j++)
+        for (size_t i = 0; i < 25; i++)
+          refs[j][i] = states[j][i] = random_int64();
+      Lib::KeccakF1600::permute4 (states, n_rounds);
+      for (size_t j = 0; j < 4; j++)
+        {
+          refs[j].permute (n_rounds);
+          for (size_t i = 0; i < 25; i++)
+            TCMP (states[j][i], ==, refs[j][i]);
+        }
+    }
+  // bulk generate() yields the random() sequence, also across block boundaries
+  KeccakGoodRng krandom1, krandom2;
+  krandom1.seed (0x5eed);
+  krandom2.seed (0x5eed);
+  krandom1();
+  krandom2();
+  uint64_t values[333];
+  krandom1.generate (&values[0], &values[ARRAY_SIZE (values)]);
+  for (size_t i = 0; i < ARRAY_SIZE (values); i++)
+    TCMP (values[i], ==, krandom2());
+  TASSERT (krandom1 == krandom2 && krandom1() == krandom2());
+  // random_fill() for short and multi-state lengths
+  for (size_t n_values : { 3, 83, 84, 1000 })
+    {
+      std::vector<uint64_t> fill (n_values, 0);
+      random_fill (fill.data(), fill.size());
+      std::sort (fill.begin(), fill.end());
+      TASSERT (fill[0] != 0 && std::adjacent_find (fill.begin(), fill.end()) == fill.end());
+    }
+}
+REGISTER_TEST ("RandomGenerator/KeccakF1600 x4", test_keccak_permute4);
+
+static void
+markup_parser_benchmark()
+{
+  String doc = "<interfaces>\n";
+  for (uint i = 0; doc.size() < 4 * 1024 * 1024; i++)
+    doc += string_format ("  <Frame id=\"frame%u\" hexpand=\"1\" tooltip=\"Frame &amp; Label %u\">\n"
+                          "    <Label markup-text=\"Item %u\" plain-text='some &lt;quoted&gt; text'/>\n"
+                          "    <!-- comment %u -->\n"
+                          "    Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor.\n"
+                          "  </Frame>\n", i, i, i, i);
+  doc += "</interfaces>\n";
+  for (size_t chunk : { doc.size(), size_t (4096) })
+    {
+      auto parse_doc = [&doc, chunk] () {
+        MarkupParser *parser = MarkupParser::create_parser ("benchmark");
+        MarkupParser::Error error;
+        for (size_t i = 0; i < doc.size() && !error.code; i += chunk)
+          parser->parse (doc.data() + i, std::min (chunk, doc.size() - i), &error);
+        if (!error.code)
+          parser->end_parse (&error);
+        TASSERT (error.code == MarkupParser::NONE);
+        delete parser;
+      };
+      Test::Timer timer (0.5); // maximum seconds
+      const double bench_time = timer.benchmark (parse_doc);
+      TPASS ("MarkupParser    # size=%zuKB chunk=%-7zu timing: fastest=%fs throughput=%.1fMB/s\n",
+             doc.size() / 1024, chunk, bench_time, doc.size() / bench_time / 1048576.);
+    }
+}
+REGISTER_TEST ("Markup/~ Benchmark", markup_parser_benchmark);
+
+static void
+xml_bundle_benchmark()
+{
+  String doc = "<interfaces>\n";
+  for (uint i = 0; doc.size() < 1024 * 1024; i++)
+    doc += string_format ("  <Frame id=\"frame%u\" hexpand=\"1\" tooltip=\"Frame &amp; Label %u\">\n"
+                          "    <Label markup-text=\"Item %u\" plain-text='some text'/>\n"
+                          "  </Frame>\n", i, i, i);
+  doc += "</interfaces>\n";
+  MarkupParser::Error error;
+  const String bundle = XmlNode::parse_xml ("benchmark", doc.data(), doc.size(), &error)->xml_bundle();
+  TASSERT (error.code == MarkupParser::NONE);
+  Test::Timer timer (0.5); // maximum seconds
+  const double parse_time = timer.benchmark ([&doc] () {
+      MarkupParser::Error error;
+      TASSERT (XmlNode::parse_xml ("benchmark", doc.data(), doc.size(), &error) != NULL);
+    });
+  const double load_time = timer.benchmark ([&bundle] () {
+      TASSERT (XmlNode::load_bundle (bundle.data(), bundle.size()) != NULL);
+    });
+  TPASS ("XmlNode         # size=%zuKB bundle=%zuKB timing: parse_xml=%fs load_bundle=%fs speedup=%.1f\n",
+         doc.size() / 1024, bundle.size() / 1024, parse_time, load_time, parse_time / load_time);
+}
+REGISTER_TEST ("XmlNode/~ Bundle Benchmark", xml_bundle_benchmark);
+
+static void
+resource_lookup_benchmark()
+{
+  const uint runs = 1000;
+  Blob keep = Res ("@res Rapicorn/foundation.xml"); // keep the inflated copy alive
+  Test::Timer timer (0.5); // maximum seconds
+  const double bench_time = timer.benchmark ([] () {
+      for (uint i = 0; i < runs; i++)
+        {
+          Blob blob = Res ("@res Rapicorn/foundation.xml");
+          TASSERT (blob.size() > 0);
+        }
+    });
+  TPASS ("Res<Blob>       # timing: fastest=%fs lookups=%.1f/ms\n", bench_time, runs / bench_time / 1000.);
+}
+REGISTER_TEST ("Resource/~ Lookup Benchmark", resource_lookup_benchmark);
+
+static void
+inifile_lookup_benchmark()
+{
+  const uint runs = 1000;
+  String ini;
+  for (uint i = 0; i < 40; i++)    // resembles a stock file with a few dozen elements
+    ini += string_format ("[element-%u]\n  label = \"Element %u\"\n  tooltip = Tip %u\n  icon = icons/%u.svg\n"
+                          "  label[de] = Element %u\n", i, i, i, i, i);
+  IniFile inifile ("bench.ini", ini);
+  StringVector dotpaths;
+  for (uint i = 0; i < runs; i++)
+    dotpaths.push_back (string_format ("element-%u.%s", i % 41, i & 1 ? "icon" : "label[de]"));
+  String value;
+  size_t found = 0;
+  Test::Timer timer (0.5); // maximum seconds
+  const double bench_time = timer.benchmark ([&] () {
+      for (uint i = 0; i < runs; i++)
+        found += inifile.has_value (dotpaths[i], &value);
+    });
+  TASSERT (found > 0);
+  TPASS ("IniFile::has_value # timing: fastest=%fs lookups=%.1f/ms\n", bench_time, runs / bench_time / 1000.);
+}
+REGISTER_TEST ("IniFile/~ Lookup Benchmark", inifile_lookup_benchmark);
+
+static void
+string_format_benchmark()
+{
+  const uint runs = 1000;
+  Test::Timer timer (0.5); // maximum seconds
+  size_t length = 0;
+  const double format_time = timer.benchmark ([&length] () {
+      for (uint i = 0; i < runs; i++)
+        length += string_format ("%s: id=%d size=%ux%u scale=%.2f", "Frame", i, 640 + i, 480, i * 0.01).size();
+    });
+  Lib::StackFormatBuffer<128> buffer;
+  const double buffer_time = timer.benchmark ([&length, &buffer] () {
+      for (uint i = 0; i < runs; i++)
+        {
+          buffer.clear();
+          length += strlen (string_format_to (buffer, "%s: id=%d size=%ux%u scale=%.2f", "Frame", i, 640 + i, 480, i * 0.01));
+        }
+    });
+  TASSERT (length > 0);
+  TPASS ("string_format   # timing: fastest=%fs calls=%.1f/ms\n", format_time, runs / format_time / 1000.);
+  TPASS ("string_format_to# timing: fastest=%fs calls=%.1f/ms\n", buffer_time, runs / buffer_time / 1000.);
+}
+REGISTER_TEST ("Strings/~ Format Benchmark", string_format_benchmark);
+
+static void
+string_numeric_benchmark()
+{
+  const uint runs = 1000;
+  StringVector dstrings, istrings;
+  vector<double> doubles;
+  for (uint i = 0; i < runs; i++)
+    {
+      doubles.push_back (i & 1 ? i * 0.25 + 0.5 : 1.0 / (i + 3)); // spacings and ratios
+      dstrings.push_back (string_format ("%.*f", i % 7, doubles.back()));
+      istrings.push_back (string_format ("%d", int (i * 7919) - 2500000));
+    }
+  Test::Timer timer (0.5); // maximum seconds
+  double dsum = 0;
+  int64 isum = 0;
+  size_t length = 0;
+  const double to_double = timer.benchmark ([&] () {
+      for (uint i = 0; i < runs; i++)
+        dsum += string_to_double (dstrings[i]);
+    });
+  const double from_double = timer.benchmark ([&] () {
+      for (uint i = 0; i < runs; i++)
+        length += string_from_double (doubles[i]).size();
+    });
+  const double to_int = timer.benchmark ([&] () {
+      for (uint i = 0; i < runs; i++)
+        isum += string_to_int (istrings[i]);
+    });
+  const double from_int = timer.benchmark ([&] () {
+      for (uint i = 0; i < runs; i++)
+        length += string_from_int (i * 7919).size();
+    });
+  TASSERT (dsum != 0 && isum != 0 && length > 0);
+  TPASS ("string_to_double   # timing: fastest=%fs calls=%.1f/ms\n", to_double, runs / to_double / 1000.);
+  TPASS ("string_from_double # timing: fastest=%fs calls=%.1f/ms\n", from_double, runs / from_double / 1000.);
+  TPASS ("string_to_int      # timing: fastest=%fs calls=%.1f/ms\n", to_int, runs / to_int / 1000.);
+  TPASS ("string_from_int    # timing: fastest=%fs calls=%.1f/ms\n", from_int, runs / from_int / 1000.);
+}
+REGISTER_TEST ("Strings/~ Numeric Benchmark", string_numeric_benchmark);
 
 int
 main (int   argc,
@@ -1,6 +1,7 @@
 // This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
 #include <rcore/testutils.hh>
 #include <errno.h>
+#include <fcntl.h>
 #include <unistd.h>
 
 namespace {
@@ -108,6 +109,134 @@ test_loop_basics()
 }
 REGISTER_TEST ("Loops/Test Basics", test_loop_basics);
 
+// === test_many_io_sources ===
+static void
+test_many_io_sources()
+{
+  MainLoopP loop = MainLoop::create();
+  TASSERT (loop);
+  loop->iterate_pending();
+  // watch lots of pipes, only the written ones may be dispatched
+  const uint n_pipes = 257;
+  int pipe_fds[n_pipes][2];
+  uint counters[n_pipes] = { 0, };
+  for (uint i = 0; i < n_pipes; i++)
+    {
+      int err = pipe (pipe_fds[i]);
+      TASSERT (err == 0);
+      uint *counter = &counters[i];
+      loop->exec_io_handler ([counter] (PollFD &pfd) {
+          char c;
+          if (read (pfd.fd, &c, 1) == 1)
+            *counter += 1;
+          return true;
+        }, pipe_fds[i][0], "rB");
+    }
+  loop->iterate_pending();
+  for (uint i = 0; i < n_pipes; i += 7)
+    TASSERT (write (pipe_fds[i][1], "x", 1) == 1);
+  loop->iterate_pending();
+  for (uint i = 0; i < n_pipes; i++)
+    TCMP (counters[i], ==, (i % 7 == 0 ? 1 : 0));
+  // a descriptor watched by two sources must be dispatched for both
+  uint shared_counter = 0;
+  loop->exec_io_handler ([&shared_counter] (PollFD &pfd) {
+      char c;
+      if (read (pfd.fd, &c, 1) == 1)
+        shared_counter++;
+      return true;
+    }, pipe_fds[1][0], "rC");
+  TASSERT (write (pipe_fds[1][1], "yz", 2) == 2);
+  loop->iterate_pending();
+  TCMP (counters[1] + shared_counter, ==, 2);
+  TCMP (shared_counter, ==, 1);
+  // descriptors that epoll(7) cannot watch, like /dev/null, must be dispatched as well
+  uint null_counter = 0;
+  const int null_fd = open ("/dev/null", O_RDONLY);
+  TASSERT (null_fd >= 0);
+  loop->exec_io_handler ([&null_counter] (PollFD &pfd) { null_counter++; return false; }, null_fd, "r");
+  loop->iterate_pending();
+  TCMP (null_counter, ==, 1);
+  TASSERT (close (null_fd) == -1);      // auto-closed by PollFDSource
+  // a descriptor closed and reopened under the same number during dispatch must be watched again
+  int reuse_fds[2];
+  TASSERT (pipe (reuse_fds) == 0);
+  uint reuse_counter = 0;
+  int reuse_writer = -1;
+  loop->exec_io_handler ([&reuse_counter, &reuse_writer] (PollFD &pfd) {
+      char c;
+      if (read (pfd.fd, &c, 1) == 1)
+        reuse_counter++;
+      if (reuse_counter == 1)
+        {
+          const int old_fd = pfd.fd;
+          close (pfd.fd);
+          int fds[2];
+          TASSERT (pipe (fds) == 0);
+          TCMP (fds[0], ==, old_fd);    // lowest free descriptor number is reused
+          reuse_writer = fds[1];
+        }
+      return true;
+    }, reuse_fds[0], "r");
+  TASSERT (write (reuse_fds[1], "a", 1) == 1);
+  loop->iterate_pending();
+  TCMP (reuse_counter, ==, 1);
+  close (reuse_fds[1]);
+  TASSERT (reuse_writer >= 0 && write (reuse_writer, "b", 1) == 1);
+  loop->iterate_pending();
+  TCMP (reuse_counter, ==, 2);
+  close (reuse_writer);
+  loop->iterate_pending();              // hangup auto-closes the reopened reader
+  // hangups must auto-close all readers
+  for (uint i = 0; i < n_pipes; i++)
+    close (pipe_fds[i][1]);
+  loop->iterate_pending();
+  for (uint i = 0; i < n_pipes; i++)
+    TASSERT (close (pipe_fds[i][0]) == -1);
+  loop->destroy_loop();
+}
+REGISTER_TEST ("Loops/Test Many IO Sources", test_many_io_sources);
+
+// === test_timer_expiration ===
+static void
+test_timer_expiration()
+{
+  MainLoopP loop = MainLoop::create();
+  const uint n_timers = 61;
+  const uint64 start = timestamp_realtime();
+  uint fired = 0;
+  vector<uint> ids;
+  // queue oneshot timers in scrambled order, none may fire before its deadline
+  for (uint i = 0; i < n_timers; i++)
+    {
+      const uint delay = (i * 37) % n_timers;
+      auto oneshot = [&fired, start, delay] () {
+        TCMP (timestamp_realtime(), >=, start + delay * 1000ULL);
+        fired++;
+      };
+      ids.push_back (loop->exec_timer (oneshot, delay));
+    }
+  // removing pending timers must unqueue them
+  TASSERT (loop->try_remove (ids[3]));
+  TASSERT (loop->try_remove (ids[17]));
+  TASSERT (loop->try_remove (ids[n_timers - 1]));
+  uint repeats = 0;
+  loop->exec_timer ([&repeats] () { return ++repeats < 5; }, 0, 7);
+  while (fired < n_timers - 3 || repeats < 5)
+    loop->iterate (true);
+  TCMP (timestamp_realtime(), >=, start + (n_timers - 1) * 1000ULL);
+  TCMP (fired, ==, n_timers - 3);
+  TCMP (repeats, ==, 5);
+  loop->iterate_pending();
+  TCMP (fired, ==, n_timers - 3);
+  TCMP (repeats, ==, 5);
+  // pending timers must not keep the loop busy
+  loop->exec_timer ([] () { TASSERT (!"reached"); }, 60 * 1000);
+  TASSERT (loop->pending() == false);
+  loop->destroy_loop();
+}
+REGISTER_TEST ("Loops/Test Timer Expiration", test_timer_expiration);
+
 // === test_event_loop_sources ===
 static uint         check_source_counter = 0;
 static uint         check_source_destroyed_counter = 0;
@@ -318,6 +447,97 @@ test_loop_round_robin (void)
 }
 REGISTER_TEST ("Loops/Test Round Robin Looping", test_loop_round_robin);
 
+static void
+test_dispatch_budget (void)
+{
+  MainLoopP loop = MainLoop::create();
+  uint counters[5] = { 0, }, lowcounter = 0;
+  uint ids[5];
+  for (uint i = 0; i < ARRAY_SIZE (counters); i++)
+    ids[i] = loop->exec_callback ([&counters, i] () { counters[i]++; return true; }, EventLoop::PRIORITY_NEXT);
+  const uint lowid = loop->exec_idle ([&lowcounter] () { lowcounter++; return true; });
+  // by default, a single source is dispatched per iteration
+  loop->iterate (false);
+  TCMP (counters[0] + counters[1] + counters[2] + counters[3] + counters[4], ==, 1);
+  // drain all sources at the winning priority per iteration
+  loop->dispatch_budget (ARRAY_SIZE (counters));
+  for (uint i = 0; i < ARRAY_SIZE (counters); i++)
+    counters[i] = 0;
+  for (uint j = 0; j < 7; j++)
+    loop->iterate (false);
+  for (uint i = 0; i < ARRAY_SIZE (counters); i++)
+    TCMP (counters[i], >=, 6);
+  TCMP (lowcounter, ==, 0);     // lower priority sources still starve
+  // the count budget limits dispatching
+  loop->dispatch_budget (2);
+  for (uint i = 0; i < ARRAY_SIZE (counters); i++)
+    counters[i] = 0;
+  loop->iterate (false);
+  TCMP (counters[0] + counters[1] + counters[2] + counters[3] + counters[4], ==, 2);
+  // the time budget limits dispatching, nothing is dispatched after a 2ms sleeper exceeded 1ms
+  loop->dispatch_budget (99, 1000);
+  for (uint i = 0; i < ARRAY_SIZE (counters); i++)
+    loop->remove (ids[i]);
+  uint sleeper_counter = 0, sleeper_total = 0, dispatched_before_sleeper = 0;
+  auto sum_counters = [&counters] () { return counters[0] + counters[1] + counters[2] + counters[3] + counters[4]; };
+  const uint sid = loop->exec_callback ([&] () {
+      usleep (2000);
+      sleeper_counter++;
+      dispatched_before_sleeper = sum_counters();
+      return true;
+    }, EventLoop::PRIORITY_NEXT);
+  for (uint i = 0; i < ARRAY_SIZE (counters); i++)      // queue after the sleeper in poll order
+    ids[i] = loop->exec_callback ([&counters, i] () { counters[i]++; return true; }, EventLoop::PRIORITY_NEXT);
+  for (uint j = 0; j < 7; j++)
+    {
+      for (uint i = 0; i < ARRAY_SIZE (counters); i++)
+        counters[i] = 0;
+      sleeper_counter = 0;
+      loop->iterate (false);
+      if (sleeper_counter)
+        TCMP (sum_counters(), ==, dispatched_before_sleeper);
+      sleeper_total += sleeper_counter;
+    }
+  TCMP (sleeper_total, >=, 3);
+  loop->remove (sid);
+  for (uint i = 0; i < ARRAY_SIZE (counters); i++)
+    loop->remove (ids[i]);
+  loop->iterate (false);
+  TCMP (lowcounter, ==, 1);
+  loop->remove (lowid);
+  loop->destroy_loop();
+}
+REGISTER_TEST ("Loops/Test Dispatch Budget", test_dispatch_budget);
+
+static void
+test_loop_stats (void)
+{
+  MainLoopP loop = MainLoop::create();
+  uint counter = 0;
+  const uint id1 = loop->exec_callback ([&counter] () { return ++counter < 7; }, EventLoop::PRIORITY_NEXT);
+  loop->iterate (false);
+  loop->collect_stats (true);
+  const uint id2 = loop->exec_dispatcher ([] (const LoopState &state) { return state.phase == state.DISPATCH; },
+                                          EventLoop::PRIORITY_UPDATE + 3);
+  loop->iterate_pending();
+  TCMP (counter, ==, 7);
+  vector<EventSourceStats> svector = loop->source_stats();
+  TCMP (svector.size(), ==, 1); // exec_callback source is gone
+  TCMP (svector[0].id, ==, id2);
+  TCMP (svector[0].priority, ==, EventLoop::PRIORITY_UPDATE + 3);
+  TASSERT (svector[0].type.find ("DispatcherSource") != String::npos);
+  TCMP (svector[0].dispatches, ==, 0);
+  TCMP (svector[0].prepare_nsecs, >, 0);
+  loop->collect_stats (false);
+  String dump = loop->stats_dump();
+  TASSERT (dump.find ("MainLoop") != String::npos);
+  TASSERT (dump.find ("priority=UPDATE+3") != String::npos);
+  TCMP (loop->poll_wait_nsecs(), >, 0);
+  TASSERT (id1 != id2);
+  loop->destroy_loop();
+}
+REGISTER_TEST ("Loops/Test Loop Statistics", test_loop_stats);
+
 static String loop_breadcrumbs = "";
 static MainLoopP breadcrumb_loop = NULL;
 static void handler_d();
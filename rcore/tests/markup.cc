@@ -70,6 +70,67 @@ rapicorn_markup_parser_test()
 }
 REGISTER_TEST ("Markup/RapicornMarkupParser", rapicorn_markup_parser_test);
 
+struct RecordingMarkupParser : MarkupParser {
+  StringVector events;
+  RecordingMarkupParser() : MarkupParser ("-") {}
+  String
+  position ()
+  {
+    int line, col;
+    get_position (&line, &col);
+    return string_format ("%d:%d:", line, col);
+  }
+  virtual void
+  start_element (const String &element_name, ConstStrings &attribute_names, ConstStrings &attribute_values, Error &error)
+  {
+    String s = position() + "<" + element_name;
+    for (size_t i = 0; i < attribute_names.size(); i++)
+      s += " " + attribute_names[i] + "=[" + attribute_values[i] + "]";
+    events.push_back (s + ">");
+  }
+  virtual void
+  end_element (const String &element_name, Error &error)
+  {
+    events.push_back (position() + "</" + element_name + ">");
+  }
+  virtual void
+  text (const String &text, Error &error)
+  {
+    events.push_back (position() + "[" + text + "]");
+  }
+};
+
+static void
+markup_parser_scanning()
+{
+  const String input = "<a x=\"1&amp;2\" y='tab\tnl\nend'>\n"
+                       "  pl\xc3\xa4in\n"
+                       "  <b z=\"verbatim\"/>&lt;&#65;&#x42;&gt;\r\n"
+                       "</a>";
+  const char *expected[] = {
+    "2:1:<a x=[1&2] y=[tab nl end]>", "4:4:[\n  pl\xc3\xa4in\n  ]", "4:20:<b z=[verbatim]>", "4:20:</b>",
+    "5:2:[<AB>\n]", "5:6:</a>",
+  };
+  // parsing in one go and piecewise must produce the same events and positions
+  for (size_t chunk : { input.size(), size_t (1), size_t (5) })
+    {
+      RecordingMarkupParser parser;
+      MarkupParser::Error error;
+      for (size_t i = 0; i < input.size() && !error.code; i += chunk)
+        parser.parse (input.data() + i, std::min (chunk, input.size() - i), &error);
+      if (!error.code)
+        parser.end_parse (&error);
+      TCMP (error.code, ==, MarkupParser::NONE);
+      TCMP (parser.events.size(), ==, ARRAY_SIZE (expected));
+      for (size_t i = 0; i < parser.events.size() && i < ARRAY_SIZE (expected); i++)
+        if (chunk == input.size()) // chunk boundaries shift positions
+          TCMP (parser.events[i], ==, expected[i]);
+        else
+          TCMP (parser.events[i].substr (parser.events[i].find (':', 2)), ==, String (expected[i]).substr (String (expected[i]).find (':', 2)));
+    }
+}
+REGISTER_TEST ("Markup/Scanning", markup_parser_scanning);
+
 static void
 markup_string_escaping()
 {
@@ -168,6 +168,53 @@ test_debug_config ()
 }
 REGISTER_TEST ("General/Debug Configuration", test_debug_config);
 
+static void
+test_binary_tracing ()
+{
+  setenv ("RAPICORN_TRACE", "TraceTest:TraceLoop", 1);
+  _rapicorn_trace_check_cache = true;
+  const String sval = "string";
+  for (int i = 0; i < 3; i++)
+    RAPICORN_KEY_DEBUG ("TraceTest", "i=%d u=%u f=%.2f s=%s c=%s x=%x %%", -i, 7u, 0.25 * i, sval, "cstr", 0xbeef);
+  RAPICORN_KEY_DEBUG ("TraceOff", "disabled %d", 1);
+  std::thread ([] () { RAPICORN_KEY_DEBUG ("TraceTest", "thread %s %c", "other", 'T'); }).join();
+  RAPICORN_KEY_DEBUG ("TraceTest", "long %s", String (4096, 'x'));
+  auto dump = [] () {
+    FILE *file = tmpfile();
+    TASSERT (file != NULL);
+    TASSERT (trace_dump (fileno (file)));
+    String data (lseek (fileno (file), 0, SEEK_END), 0);
+    TCMP (pread (fileno (file), &data[0], data.size(), 0), ==, ssize_t (data.size()));
+    fclose (file);
+    vector<TraceEvent> events;
+    String error;
+    TASSERT (trace_decode (data, [&] (const TraceEvent &event) { events.push_back (event); }, &error));
+    TCMP (error, ==, "");
+    TASSERT (!trace_decode (data.substr (0, data.size() - 1), [] (const TraceEvent&) {}, &error));
+    TASSERT (error.empty() == false);
+    return events;
+  };
+  vector<TraceEvent> events = dump();
+  TCMP (events.size(), ==, 5);
+  TCMP (events[0].message, ==, "i=0 u=7 f=0.00 s=string c=cstr x=beef %");
+  TCMP (events[2].message, ==, "i=-2 u=7 f=0.50 s=string c=cstr x=beef %");
+  TCMP (events[2].key, ==, String ("TraceTest"));
+  TCMP (events[2].tid, ==, ThisThread::thread_pid());
+  TASSERT (events[0].stamp <= events[2].stamp && events[2].line == events[0].line);
+  TASSERT (events[3].message.compare (0, 5, "long ") == 0 && events[3].message.size() < 1024);
+  TCMP (events[4].message, ==, "thread other T");
+  TCMP (events[4].tid, !=, events[0].tid);
+  TCMP (dump().size(), ==, 0);  // records are consumed
+  for (size_t i = 0; i < 8192; i++)
+    RAPICORN_KEY_DEBUG ("TraceLoop", "iteration %u", i);
+  events = dump();
+  TCMP (events.size(), <, 8192 + 1);
+  TCMP (events.back().dropped + events.size() - 1, ==, 8192);
+  TCMP (events.back().key, ==, (const char*) NULL);
+  unsetenv ("RAPICORN_TRACE");
+}
+REGISTER_TEST ("General/Binary Tracing", test_binary_tracing);
+
 static void
 test_paths()
 {
@@ -648,6 +695,15 @@ test_builtin_resources()
   assert (blob && blob.size() > 0);
   blob = Res ("@res Rapicorn/icons/broken-image.svg");
   assert (blob && blob.size() > 0);
+  // concurrent users share decompressed resources
+  Blob xml1 = Res ("@res Rapicorn/foundation.xml");
+  Blob xml2 = Res ("@res Rapicorn/foundation.xml");
+  assert (xml1 && xml1.data() == xml2.data());
+  const String xml_string = xml1.string();
+  xml1 = xml2 = Blob();
+  xml1 = Res ("@res Rapicorn/foundation.xml");
+  assert (xml1.string() == xml_string);
+  assert (!Res ("@res Rapicorn/nonexisting-resource.xml").as<Blob>());
 }
 REGISTER_TEST ("Resource/Builtin Tests", test_builtin_resources);
 
@@ -319,6 +319,68 @@ string_conversions (void)
 }
 REGISTER_TEST ("Strings/conversions", string_conversions);
 
+static void
+numeric_conversions()
+{
+  TCMP (string_from_double (0.1), ==, "0.1");
+  TCMP (string_from_double (-2.5), ==, "-2.5");
+  TCMP (string_from_double (123.456), ==, "123.456");
+  TCMP (string_from_double (0.1 + 0.2), ==, "0.30000000000000004");
+  TCMP (string_from_double (1.0 / 3), ==, "0.3333333333333333");
+  TCMP (string_from_double (0.0001), ==, "0.0001");
+  TCMP (string_from_double (1e-05), ==, "1e-05");
+  TCMP (string_from_double (1e+20), ==, "1e+20");
+  TCMP (string_from_double (9007199254740991.0), ==, "9007199254740991");
+  TCMP (string_from_double (0), ==, "0");
+  TCMP (string_from_double (-0.0), ==, "-0");
+  TCMP (string_from_int (-9223372036854775807LL - 1), ==, "-9223372036854775808");
+  TCMP (string_from_uint (18446744073709551615ULL), ==, "18446744073709551615");
+  TCMP (string_from_int (0), ==, "0");
+  size_t consumed;
+  TCMP (string_to_int (" -42x", &consumed), ==, -42);
+  TCMP (consumed, ==, 4);
+  TCMP (string_to_int ("0x7fffffffffffffff"), ==, 9223372036854775807LL);
+  TCMP (string_to_uint ("18446744073709551615"), ==, 18446744073709551615ULL);
+  TCMP (string_to_int ("+", &consumed), ==, 0);
+  TCMP (consumed, ==, 0);
+  TCMP (string_to_int ("0777", NULL, 8), ==, 511);
+  const char *endptr;
+  TCMP (string_to_double ("  -1.5e3xyz", &endptr), ==, -1500);
+  TCMP (endptr[0], ==, 'x');
+  TCMP (string_to_double ("1e", &endptr), ==, 1);
+  TCMP (endptr[0], ==, 'e');
+  TCMP (string_to_double ("0x10"), ==, 16);
+  TCMP (string_to_double ("1e400"), ==, INFINITY);
+  TCMP (string_to_double ("123456789012345678901234"), ==, 123456789012345678901234.0);
+  // compare fast paths against the C library and check round trips
+  const double scales[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000 };
+  for (uint i = 0; i < 200000; i++)
+    {
+      const int64 ival = Test::random_int64() >> (Test::random_int64() & 63);
+      const String istr = string_format ("%d", ival);
+      TCMP (string_from_int (ival), ==, istr);
+      TCMP (string_to_int (istr), ==, ival);
+      const uint64 uval = Test::random_int64();
+      TCMP (string_to_uint (string_format ("0x%x", uval)), ==, uval);
+      double dval;
+      if (i & 1)        // short decimals
+        dval = (Test::random_int64() % 100000000) / scales[Test::random_int64() & 7];
+      else              // random bit patterns
+        {
+          const uint64 bits = Test::random_int64();
+          memcpy (&dval, &bits, sizeof (dval));
+          if (!std::isfinite (dval))
+            continue;
+        }
+      const String dstr = string_from_double (dval);
+      TCMP (string_to_double (dstr), ==, dval);
+      TASSERT (dstr.size() <= string_format ("%.17g", dval).size() || dstr.find ('e') != String::npos);
+      const String rstr = string_format ("%.*e", int (Test::random_int64() & 15), dval);
+      TCMP (string_to_double (rstr), ==, (double) strtold (rstr.c_str(), NULL));
+    }
+}
+REGISTER_TEST ("Strings/Numeric Conversions", numeric_conversions);
+
 static void
 split_string_tests (void)
 {
@@ -560,6 +622,68 @@ test_cxxprintf()
 }
 REGISTER_TEST ("Strings/CxxPrintf", test_cxxprintf);
 
+static void
+test_cxxprintf_fast_paths()
+{
+  // integer, string and fixed point conversions bypass snprintf, compare against it
+  char cbuf[256];
+  const char *iformats[] = { "%d", "%i", "%u", "%x", "%X", "%o", "%+d", "% d", "%7d", "%-7d|", "%07d", "%-07x|", "%+08i", "%3u" };
+  const char *fformats[] = { "%f", "%.0f", "%.1f", "%.2f", "%.3f", "%.9f", "%12.4f", "%-12.4f|", "%012.3f", "%+.2f", "% .5f", "%F" };
+  for (size_t i = 0; i < 2000; i++)
+    {
+      const int64 r = Test::random_int64();
+      const int64 value = i < 20 ? int64 (i) - 10 : r >> (r & 63);
+      for (const char *f : iformats)
+        {
+          snprintf (cbuf, sizeof (cbuf), f, int (value));
+          TCMP (string_format (f, int (value)), ==, cbuf);
+          snprintf (cbuf, sizeof (cbuf), String (f).insert (strlen (f) - (f[strlen (f) - 1] == '|' ? 2 : 1), "ll").c_str(), (long long) value);
+          TCMP (string_format (f, (long long) value), ==, cbuf);
+          snprintf (cbuf, sizeof (cbuf), String (f).insert (strlen (f) - (f[strlen (f) - 1] == '|' ? 2 : 1), "hh").c_str(), (signed char) value);
+          TCMP (string_format (f, (signed char) value), ==, cbuf);
+        }
+      const double d = i < 40 ? (int (i) - 20) / 8.0 : Test::random_frange (-1, 1) * pow (10, Test::random_irange (-6, 14));
+      for (const char *f : fformats)
+        {
+          snprintf (cbuf, sizeof (cbuf), f, d);
+          TCMP (string_format (f, d), ==, cbuf);
+        }
+    }
+  TCMP (string_format ("%.2f %.1f %.0f %.0f", 0.125, 0.25, 0.5, 1.5), ==, "0.12 0.2 0 2"); // ties round to even
+  TCMP (string_format ("%.2f %f", -0.001, 1e300 * 1e300), ==, "-0.00 inf");
+  TCMP (string_format ("|%5s|%-5s|%.2s|%*s|", "ab", "ab", "abc", -4, "x"), ==, "|   ab|ab   |ab|x   |");
+  // negative '*' widths left-align, in the fast paths and in the snprintf fallbacks
+  for (int w : { -12, -3, -1, 0, 1, 3, 12 })
+    {
+      void *ptr = &cbuf[0];
+      snprintf (cbuf, sizeof (cbuf), "|%*d|%*x|%*s|%-*u|%*.2f|", w, -17, w, 0xbeef, w, "ab", w, 7, w, 2.5);
+      TCMP (string_format ("|%*d|%*x|%*s|%-*u|%*.2f|", w, -17, w, 0xbeef, w, "ab", w, 7, w, 2.5), ==, cbuf);
+      snprintf (cbuf, sizeof (cbuf), "|%*c|%*p|%*e|%0*d|%-*c|", w, 'c', w, ptr, w, 0.5, w, 42, w, 'z');
+      TCMP (string_format ("|%*c|%*p|%*e|%0*d|%-*c|", w, 'c', w, ptr, w, 0.5, w, 42, w, 'z'), ==, cbuf);
+    }
+  // buffers
+  String s = "A";
+  string_format_append (s, "%d%s", 1, "B");
+  string_format_append (s, "%s", String (1000, 'c'));
+  TCMP (s.size(), ==, 1003);
+  TCMP (s.substr (0, 5), ==, "A1Bcc");
+  char mem[8];
+  Lib::FormatBuffer buffer (mem, sizeof (mem));
+  TCMP (string_format_to (buffer, "%u", 1234567), ==, String ("1234567"));
+  TASSERT (buffer.data() == mem);
+  TCMP (string_format_to (buffer, "-%s-", "grows"), ==, String ("1234567-grows-"));
+  TASSERT (buffer.data() != mem);
+  buffer.clear();
+  TCMP (string_format_to (buffer, "%d", -1), ==, String ("-1"));
+  // format pointers are reused with different contents
+  char format[8];
+  strcpy (format, "%d+");
+  TCMP (string_format (format, 5), ==, "5+");
+  strcpy (format, "%x-");
+  TCMP (string_format (format, 255), ==, "ff-");
+}
+REGISTER_TEST ("Strings/CxxPrintf Fast Paths", test_cxxprintf_fast_paths);
+
 #define cxxoutput_printf(fmt,...)       fputs (string_format (fmt, __VA_ARGS__).c_str(), stdout)
 
 static void
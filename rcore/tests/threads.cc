@@ -728,4 +728,54 @@ test_ring_buffer ()
 }
 REGISTER_TEST ("Threads/AsyncRingBuffer", test_ring_buffer);
 
+// == TaskPool ==
+static void
+test_task_pool()
+{
+  TaskPool pool (3);
+  TCMP (pool.n_workers(), ==, 3);
+  // parallel_for covers the range exactly once
+  const size_t n = 100003;
+  vector<uint8> touched (n, 0);
+  volatile size_t sum = 0;
+  pool.parallel_for (0, n, 997, [&touched, &sum] (size_t b, size_t e) {
+      TASSERT (e > b && e - b <= 997);
+      size_t s = 0;
+      for (size_t i = b; i < e; i++)
+        {
+          touched[i]++;
+          s += i;
+        }
+      atomic_fetch_add (&sum, s);
+    });
+  TCMP (sum, ==, n * (n - 1) / 2);
+  for (size_t i = 0; i < n; i++)
+    if (touched[i] != 1)
+      TCMP (touched[i], ==, 1);
+  // futures deliver results from worker threads
+  vector<std::future<int>> futures;
+  for (int i = 0; i < 99; i++)
+    futures.push_back (pool.async ([i] () { return i * i; }));
+  for (int i = 0; i < 99; i++)
+    TCMP (futures[i].get(), ==, i * i);
+  // nested parallel_for from within tasks, submitted tasks are stolen by idle workers
+  volatile uint nested = 0;
+  pool.parallel_for (0, 16, 1, [&pool, &nested] (size_t, size_t) {
+      pool.parallel_for (0, 64, 3, [&nested] (size_t b, size_t e) { atomic_fetch_add (&nested, uint (e - b)); });
+    });
+  TCMP (nested, ==, 16 * 64);
+  volatile uint counter = 0;
+  for (uint i = 0; i < 777; i++)
+    pool.submit ([&counter] () { atomic_fetch_add (&counter, 1U); });
+  while (pool.run_task())
+    ;
+  std::future<uint> last = pool.async ([] () { return 17U; });
+  TCMP (last.get(), ==, 17);
+  while (atomic_load (&counter) < 777)
+    ThisThread::yield();
+  TCMP (counter, ==, 777);
+  TASSERT (TaskPool::the().n_workers() >= 1);
+}
+REGISTER_TEST ("Threads/TaskPool", test_task_pool);
+
 } // Anon
@@ -89,4 +89,36 @@ test_ini_files()
 }
 REGISTER_OUTPUT_TEST ("IniFiles/Parsing", test_ini_files);
 
+static void
+test_ini_lookups()
+{
+  IniFile inifile (Blob::from (ini_testfile));
+  TCMP (string_join (",", inifile.sections()), ==, "Section With Spaces And Comment,simple-section");
+  TASSERT (inifile.has_section ("simple-section") && !inifile.has_section ("simple") && !inifile.has_section (""));
+  TCMP (inifile.attributes ("simple-section").size(), ==, 8);
+  TASSERT (inifile.has_attribute ("simple-section", "name[de]") && !inifile.has_attribute ("simple-section", "name"));
+  TCMP (inifile.value_as_string ("simple-section.string-key"), ==, "string with # Hash");
+  TCMP (inifile.raw_value ("simple-section.string-key"), ==, "string 'with # Hash'");
+  TCMP (inifile.value_as_string ("simple-section.name[de]"), ==, "DE localized key");
+  TCMP (inifile.value_as_string ("Section With Spaces And Comment.longvalue1"), ==, "value contains line continuation");
+  String value = "unchanged";
+  TASSERT (inifile.has_value ("simple-section.empty", &value) && value == "");
+  TASSERT (!inifile.has_value ("simple-section.missing", &value) && value == "");
+  TASSERT (!inifile.has_value ("key1") && !inifile.has_value ("simple-section.") && !inifile.has_value (".key1"));
+  IniFile dups ("dups", "[a.b]\nx = 1\n[c]\ny = 2\n[a.b]\nx = 3\nz = '4'\n");
+  TCMP (dups.value_as_string ("a.b.x"), ==, "1");       // first definition wins
+  TCMP (dups.value_as_string ("a.b.z"), ==, "4");
+  TCMP (string_join (",", dups.attributes ("a.b")), ==, "x,x,z");
+  IniFile copy (dups);
+  TCMP (copy.value_as_string ("c.y"), ==, "2");
+  String many;
+  for (uint i = 0; i < 1000; i++)
+    many += string_format ("[s%u]\nk%u = %u\n", i % 17, i, i);
+  IniFile big ("big", many);
+  for (uint i = 0; i < 1000; i++)
+    TCMP (big.value_as_string (string_format ("s%u.k%u", i % 17, i)), ==, string_from_uint (i));
+  TASSERT (!big.has_value ("s1.k0"));
+}
+REGISTER_TEST ("IniFiles/Lookups", test_ini_lookups);
+
 } // Anon
@@ -75,9 +75,83 @@ xml_tree_test (void)
   TCMP (oa[3], ==, "foofoo");
   TCMP (oa[4], ==, "coffee");
   TCMP (oa[5], ==, "last");
+  const XmlNode::AttributeNames names = cnode->list_attributes(); // view, no copies
+  TCMP (names.size(), ==, oa.size());
+  for (size_t i = 0; i < names.size(); i++)
+    TASSERT (&names[i] == cnode->attribute_atom (i));
 }
 REGISTER_TEST ("XML-Tests/Test XmlNode", xml_tree_test);
 
+static void
+xml_atom_test (void)
+{
+  MarkupParser::Error error;
+  XmlNodeP xnode = XmlNode::parse_xml ("testdata", xml_data1, strlen (xml_data1), &error);
+  TCMP (error.code, ==, 0);
+  // names and input files are interned
+  TCMP (XmlNode::atom ("child1"), ==, XmlNode::atom (String ("child") + "1"));
+  TCMP (XmlNode::lookup_atom ("randomFOObarCOOB-nonexisting-atom"), ==, nullptr);
+  const XmlNodeP child1 = xnode->find_child ("child1");
+  TCMP (child1, !=, nullptr);
+  TCMP (child1->name_atom(), ==, XmlNode::atom ("child1"));
+  TCMP (&child1->parsed_file(), ==, &xnode->parsed_file());
+  // attribute lookups by atom
+  const XmlAtom battr = XmlNode::atom ("b");
+  TCMP (child1->get_attribute (battr), ==, "1234b");
+  TCMP (child1->has_attribute (XmlNode::atom ("A")), ==, false);
+  TCMP (child1->has_attribute ("B", true), ==, true);
+  TCMP (child1->del_attribute ("b"), ==, true);
+  TCMP (child1->has_attribute (battr), ==, false);
+  // arena nodes outlive the parse and can be mixed with heap nodes
+  XmlNodeP extra = child1->create_child ("extra", 1, 1, "");
+  extra->set_attribute ("b", "x");
+  TCMP (extra->get_attribute (battr), ==, "x");
+  XmlNodeP child2 = xnode->find_child ("child2");
+  xnode = NULL;
+  TCMP (child2->find_child ("child3")->name(), ==, "child3");
+}
+REGISTER_TEST ("XML-Tests/Test XmlNode atoms", xml_atom_test);
+
+static void
+xml_bundle_test (void)
+{
+  MarkupParser::Error error;
+  XmlNodeP xnode = XmlNode::parse_xml ("testdata", xml_data1, strlen (xml_data1), &error);
+  TCMP (error.code, ==, 0);
+  const String bundle = xnode->xml_bundle();
+  TCMP (XmlNode::is_bundle (bundle.data(), bundle.size()), ==, true);
+  TCMP (XmlNode::is_bundle (xml_data1, strlen (xml_data1)), ==, false);
+  // loading reproduces the tree, including source positions
+  String errmsg;
+  XmlNodeP bnode = XmlNode::load_bundle (bundle.data(), bundle.size(), &errmsg);
+  TCMP (errmsg, ==, "");
+  TCMP (bnode, !=, nullptr);
+  TCMP (bnode->xml_string(), ==, xnode->xml_string());
+  TCMP (bnode->parsed_file(), ==, "testdata");
+  const XmlNodeP child1 = bnode->find_child ("child1");
+  TCMP (child1, !=, nullptr);
+  TCMP (child1->parsed_line(), ==, xnode->find_child ("child1")->parsed_line());
+  TCMP (child1->name_atom(), ==, XmlNode::atom ("child1"));
+  TCMP (child1->get_attribute (XmlNode::atom ("b")), ==, "1234b");
+  TCMP (child1->parent(), ==, bnode.get());
+  // unaligned input is accepted
+  const String unaligned = "x" + bundle;
+  bnode = XmlNode::load_bundle (unaligned.data() + 1, bundle.size());
+  TCMP (bnode->xml_string(), ==, xnode->xml_string());
+  // damaged bundles are rejected
+  TCMP (XmlNode::load_bundle (bundle.data(), bundle.size() - 1, &errmsg), ==, nullptr);
+  TCMP (errmsg, ==, "truncated bundle");
+  String broken = bundle;
+  broken[8] ^= 0x7f; // version
+  TCMP (XmlNode::load_bundle (broken.data(), broken.size(), &errmsg), ==, nullptr);
+  TCMP (errmsg, ==, "unsupported bundle version");
+  broken = bundle;
+  broken[broken.size() - 1] ^= 0x7f; // last attribute value index
+  TCMP (XmlNode::load_bundle (broken.data(), broken.size(), &errmsg), ==, nullptr);
+  TCMP (errmsg, ==, "corrupt bundle attribute");
+}
+REGISTER_TEST ("XML-Tests/Test XmlNode bundles", xml_bundle_test);
+
 static const String expected_xmlarray =
   "<Array>\n"
   "  <row><int>0</int></row>\n"
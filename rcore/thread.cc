@@ -8,6 +8,7 @@
 #include <algorithm>
 #include <sys/syscall.h>        // SYS_gettid
 #include <list>
+#include <deque>
 
 #define TDEBUG(...)     RAPICORN_KEY_DEBUG ("Threading", __VA_ARGS__)
 
@@ -299,6 +300,191 @@ process_pid ()
 
 } // ThisThread
 
+// == TaskPool ==
+struct TaskPool::Worker {
+  Spinlock         lock;
+  std::deque<Task> tasks;
+  std::thread      thread;
+};
+
+static __thread TaskPool *current_task_pool = NULL;
+static __thread uint      current_task_worker = 0;
+
+/** Create a TaskPool with @a n_workers threads, the number of online CPUs is used if 0.
+ * If @a pin_workers is true, the worker threads are distributed across the CPUs via ThisThread::affinity().
+ */
+TaskPool::TaskPool (uint n_workers, bool pin_workers) :
+  n_queued_ (0), n_sleeping_ (0), rr_index_ (0), quit_ (false)
+{
+  const uint n_cpus = MAX (1, ThisThread::online_cpus());
+  if (!n_workers)
+    n_workers = n_cpus;
+  for (uint i = 0; i < n_workers; i++)
+    workers_.push_back (new Worker());
+  for (uint i = 0; i < n_workers; i++)
+    workers_[i]->thread = std::thread (&TaskPool::worker_loop, this, i, pin_workers ? int (i % n_cpus) : -1);
+}
+
+TaskPool::~TaskPool ()
+{
+  assert_return (current_task_pool != this);
+  mutex_.lock();
+  quit_ = true;
+  cond_.broadcast();
+  mutex_.unlock();
+  for (auto worker : workers_)
+    {
+      worker->thread.join();
+      delete worker;
+    }
+  workers_.clear();
+}
+
+TaskPool&
+TaskPool::the ()
+{
+  static TaskPool *shared_pool = new TaskPool();
+  return *shared_pool;
+}
+
+uint
+TaskPool::worker_index ()
+{
+  if (current_task_pool == this)
+    return current_task_worker;
+  return atomic_fetch_add (&rr_index_, 1U) % workers_.size();
+}
+
+void
+TaskPool::submit (const Task &task)
+{
+  Worker &worker = *workers_[worker_index()];
+  worker.lock.lock();
+  worker.tasks.push_back (task);
+  worker.lock.unlock();
+  atomic_fetch_add (&n_queued_, 1U);
+  if (atomic_load (&n_sleeping_))       // full barrier above orders n_queued_ before n_sleeping_
+    {
+      ScopedLock<Mutex> locker (mutex_);
+      cond_.signal();
+    }
+}
+
+bool
+TaskPool::pop_task (uint index, Task &task)
+{
+  if (!atomic_load (&n_queued_))
+    return false;
+  const uint n = workers_.size();
+  for (uint i = 0; i < n; i++)
+    {
+      Worker &worker = *workers_[(index + i) % n];
+      worker.lock.lock();
+      if (!worker.tasks.empty())
+        {
+          if (i == 0)                   // own tasks are processed LIFO, for cache locality
+            {
+              task = std::move (worker.tasks.back());
+              worker.tasks.pop_back();
+            }
+          else                          // steal the oldest task from other workers
+            {
+              task = std::move (worker.tasks.front());
+              worker.tasks.pop_front();
+            }
+          worker.lock.unlock();
+          atomic_fetch_add (&n_queued_, uint (-1));
+          return true;
+        }
+      worker.lock.unlock();
+    }
+  return false;
+}
+
+void
+TaskPool::worker_loop (uint index, int cpu)
+{
+  current_task_pool = this;
+  current_task_worker = index;
+  ThreadInfo::self().name (string_format ("TaskPool-%u", index));
+  if (cpu >= 0)
+    ThisThread::affinity (cpu);
+  Task task;
+  for (;;)
+    {
+      if (pop_task (index, task))
+        {
+          task();
+          task = NULL;
+          continue;
+        }
+      ScopedLock<Mutex> locker (mutex_);
+      if (quit_ && !atomic_load (&n_queued_))
+        break;
+      atomic_fetch_add (&n_sleeping_, 1U);
+      if (!quit_ && !atomic_load (&n_queued_))
+        cond_.wait (mutex_);
+      atomic_fetch_add (&n_sleeping_, uint (-1));
+    }
+  current_task_pool = NULL;
+}
+
+/// Execute a queued task in the calling thread, returns false if no task was queued.
+bool
+TaskPool::run_task ()
+{
+  Task task;
+  if (!pop_task (worker_index(), task))
+    return false;
+  task();
+  return true;
+}
+
+/** Call @a range_task for consecutive sub ranges of [@a begin, @a end) in parallel.
+ * Each sub range passed into @a range_task spans at most @a grain elements.
+ * The calling thread executes sub ranges and other queued tasks until all of the
+ * range has been processed, so parallel_for() may also be called from within tasks.
+ */
+void
+TaskPool::parallel_for (size_t begin, size_t end, size_t grain, const RangeTask &range_task)
+{
+  if (end <= begin)
+    return;
+  grain = MAX (1, grain);
+  const size_t n_chunks = (end - begin + grain - 1) / grain;
+  if (n_chunks == 1 || workers_.size() < 1)
+    {
+      for (size_t i = begin; i < end; i += grain)
+        range_task (i, MIN (end, i + grain));
+      return;
+    }
+  struct Range {
+    RangeTask         range_task;
+    size_t            begin, end, grain, n_chunks;
+    volatile size_t   next_chunk, done_chunks;
+    void
+    process()
+    {
+      size_t chunk;
+      while ((chunk = atomic_fetch_add (&next_chunk, size_t (1))) < n_chunks)
+        {
+          const size_t b = begin + chunk * grain;
+          range_task (b, MIN (end, b + grain));
+          atomic_fetch_add (&done_chunks, size_t (1));
+        }
+    }
+  };
+  // helpers may start after completion, so they hold a reference to the range
+  auto range = std::make_shared<Range> (Range { range_task, begin, end, grain, n_chunks, 0, 0 });
+  const size_t n_helpers = MIN (n_chunks - 1, workers_.size());
+  for (size_t i = 0; i < n_helpers; i++)
+    submit ([range] () { range->process(); });
+  range->process();
+  while (atomic_load (&range->done_chunks) < n_chunks)
+    if (!run_task())
+      ThisThread::yield();
+}
+
 namespace Lib {
 
 struct OnceData {
@@ -5,6 +5,7 @@
 #include <rcore/utilities.hh>
 #include <rcore/threadlib.hh>
 #include <thread>
+#include <future>
 #include <list>
 
 namespace Rapicorn {
@@ -273,6 +274,50 @@ public:
   uint          write           (uint length, const T *data, bool partial = true); ///< Write (possibly partial) data to ring buffer.
 };
 
+// == TaskPool ==
+/**
+ * This is a work-stealing pool of worker threads for the parallel execution of tasks.
+ * Each worker owns a task deque, tasks submitted from within a worker are queued on its
+ * own deque and executed in LIFO order, idle workers steal the oldest tasks of other workers.
+ * Threads waiting for parallel_for() completion help executing queued tasks.
+ */
+class TaskPool {
+public:
+  typedef std::function<void()>               Task;
+  typedef std::function<void (size_t, size_t)> RangeTask;
+private:
+  struct Worker;
+  std::vector<Worker*> workers_;
+  Mutex                mutex_;
+  Cond                 cond_;
+  volatile uint        n_queued_, n_sleeping_, rr_index_;
+  bool                 quit_;
+  RAPICORN_CLASS_NON_COPYABLE (TaskPool);
+  void          worker_loop     (uint index, int cpu);
+  bool          pop_task        (uint index, Task &task);
+  uint          worker_index    ();
+public:
+  explicit      TaskPool        (uint n_workers = 0, bool pin_workers = false);
+  /*dtor*/     ~TaskPool        ();                     ///< Executes remaining tasks and joins all worker threads.
+  uint          n_workers       () const { return workers_.size(); } ///< Number of worker threads.
+  void          submit          (const Task &task);     ///< Queue @a task for asynchronous execution.
+  bool          run_task        ();                     ///< Execute one queued task in the calling thread if any.
+  void          parallel_for    (size_t begin, size_t end, size_t grain, const RangeTask &range_task);
+  template<class Func>
+  std::future<typename std::result_of<Func()>::type>
+  async                         (Func &&func);          ///< Queue @a func for execution, its result is provided by a future.
+  static TaskPool& the          ();                     ///< Shared TaskPool, using online_cpus() worker threads.
+};
+
+template<class Func> std::future<typename std::result_of<Func()>::type>
+TaskPool::async (Func &&func)
+{
+  typedef typename std::result_of<Func()>::type Result;
+  auto ptask = std::make_shared<std::packaged_task<Result()>> (std::forward<Func> (func));
+  submit ([ptask] () { (*ptask) (); });
+  return ptask->get_future();
+}
+
 // == Implementation Bits ==
 template<typename T>
 AsyncRingBuffer<T>::AsyncRingBuffer (uint buffer_size) :
@@ -1,15 +1,49 @@
 // This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
 #include "xmlnode.hh"
 #include "strings.hh"
+#include "thread.hh"
 #include <string.h>
 #include <algorithm>
+#include <unordered_set>
+#include <unordered_map>
 
 namespace Rapicorn {
 
-XmlNode::XmlNode (const String &element_name,
-                  uint          line,
-                  uint          _char,
-                  const String &file) :
+struct XmlAtomTable {
+  Mutex                      mutex;
+  std::unordered_set<String> atoms;     // element pointers remain valid across rehashing
+};
+
+static XmlAtomTable&
+xml_atom_table()
+{
+  static XmlAtomTable *table = new XmlAtomTable();      // never destroyed, atoms outlive static dtors
+  return *table;
+}
+
+/// Intern @a string and return a unique pointer for it that is valid for the rest of the program.
+XmlAtom
+XmlNode::atom (const String &string)
+{
+  XmlAtomTable &table = xml_atom_table();
+  ScopedLock<Mutex> locker (table.mutex);
+  return &*table.atoms.insert (string).first;
+}
+
+/// Find the XmlAtom for @a string if one was interned before, returns NULL otherwise.
+XmlAtom
+XmlNode::lookup_atom (const String &string)
+{
+  XmlAtomTable &table = xml_atom_table();
+  ScopedLock<Mutex> locker (table.mutex);
+  auto it = table.atoms.find (string);
+  return it != table.atoms.end() ? &*it : NULL;
+}
+
+XmlNode::XmlNode (XmlAtom element_name,
+                  uint    line,
+                  uint    _char,
+                  XmlAtom file) :
   name_ (element_name),
   parent_ (NULL), file_ (file),
   line_ (line), char_ (_char)
@@ -21,21 +55,22 @@ XmlNode::~XmlNode ()
   assert (parent_ == NULL);
 }
 
-static inline vector<String>::const_iterator
-find_attribute (const vector<String> &attribute_names,
-                const String         &name,
-                bool                  case_insensitive)
+ssize_t
+XmlNode::find_attribute (XmlAtom name) const
 {
-  if (case_insensitive)
-    {
-      const char *cname = name.c_str();
-      for (vector<String>::const_iterator it = attribute_names.begin(); it != attribute_names.end(); it++)
-        if (strcasecmp (cname, it->c_str()) == 0)
-          return it;
-      return attribute_names.end();
-    }
-  else
-    return find (attribute_names.begin(), attribute_names.end(), name);
+  for (size_t i = 0; i < attribute_names_.size(); i++)
+    if (attribute_names_[i] == name)
+      return i;
+  return -1;
+}
+
+XmlNode::AttributeNames::operator StringVector () const
+{
+  StringVector names;
+  names.reserve (atoms_.size());
+  for (XmlAtom a : atoms_)
+    names.push_back (*a);
+  return names;
 }
 
 bool
@@ -43,16 +78,17 @@ XmlNode::set_attribute (const String &name,
                         const String &value,
                         bool          replace)
 {
-  vector<String>::const_iterator it = find_attribute (attribute_names_, name, false);
-  if (it == attribute_names_.end())
+  const XmlAtom aname = atom (name);
+  const ssize_t nth = find_attribute (aname);
+  if (nth < 0)
     {
-      attribute_names_.push_back (name);
+      attribute_names_.push_back (aname);
       attribute_values_.push_back (value);
       return true;
     }
   else if (replace)
     {
-      attribute_values_[it - attribute_names_.begin()] = value;
+      attribute_values_[nth] = value;
       return true;
     }
   else
@@ -73,20 +109,47 @@ XmlNode::has_attribute (const String &name,
                         bool          case_insensitive,
                         String       *valuep) const
 {
-  vector<String>::const_iterator it = find_attribute (attribute_names_, name, case_insensitive);
-  const bool has_attr = it != attribute_names_.end();
-  if (has_attr && valuep)
-    *valuep = attribute_values_[it - attribute_names_.begin()];
-  return has_attr;
+  if (!case_insensitive)
+    {
+      const XmlAtom aname = lookup_atom (name); // unknown atoms cannot be attribute names
+      return aname && has_attribute (aname, valuep);
+    }
+  const char *cname = name.c_str();
+  for (size_t i = 0; i < attribute_names_.size(); i++)
+    if (strcasecmp (cname, attribute_names_[i]->c_str()) == 0)
+      {
+        if (valuep)
+          *valuep = attribute_values_[i];
+        return true;
+      }
+  return false;
+}
+
+/// Retrieve attribute value by comparing attribute name atoms.
+String
+XmlNode::get_attribute (XmlAtom name) const
+{
+  const ssize_t nth = find_attribute (name);
+  return nth >= 0 ? attribute_values_[nth] : String();
+}
+
+/// Check for an attribute by comparing attribute name atoms.
+bool
+XmlNode::has_attribute (XmlAtom name, String *valuep) const
+{
+  const ssize_t nth = find_attribute (name);
+  if (nth >= 0 && valuep)
+    *valuep = attribute_values_[nth];
+  return nth >= 0;
 }
 
 bool
 XmlNode::del_attribute (const String &name)
 {
-  vector<String>::const_iterator c_it = find_attribute (attribute_names_, name, false);
-  if (c_it == attribute_names_.end())
+  const XmlAtom aname = lookup_atom (name);
+  const ssize_t nth = aname ? find_attribute (aname) : -1;
+  if (nth < 0)
     return false;
-  const size_t nth = c_it - attribute_names_.begin();
   attribute_names_.erase (attribute_names_.begin() + nth);
   attribute_values_.erase (attribute_values_.begin() + nth);
   return true;
@@ -128,6 +191,53 @@ XmlNode::steal_children (XmlNode &parent)
 namespace { // Anon
 using namespace Rapicorn;
 
+/* Bump allocator for the nodes of one parse_xml() call, nodes and their shared_ptr
+ * control blocks are carved out of large blocks, released with the last node.
+ */
+class XmlArena {
+  enum { BLOCK_SIZE = 32 * 1024, ALIGNMENT = 16 };
+  vector<char*>         blocks_;
+  char                 *current_;
+  size_t                left_;
+public:
+  explicit              XmlArena        () : current_ (NULL), left_ (0) {}
+  /*dtor*/             ~XmlArena        () { for (char *block : blocks_) free (block); }
+  void*
+  allocate (size_t size)
+  {
+    size = (size + ALIGNMENT - 1) & ~size_t (ALIGNMENT - 1);
+    if (size > BLOCK_SIZE / 4)  // large chunks get a block of their own
+      {
+        blocks_.push_back ((char*) malloc (size));
+        return blocks_.back();
+      }
+    if (size > left_)
+      {
+        current_ = (char*) malloc (BLOCK_SIZE);
+        blocks_.push_back (current_);
+        left_ = BLOCK_SIZE;
+      }
+    void *mem = current_;
+    current_ += size;
+    left_ -= size;
+    return mem;
+  }
+};
+typedef std::shared_ptr<XmlArena> XmlArenaP;
+
+// Allocator for std::allocate_shared() that keeps its arena alive
+template<class T>
+struct XmlArenaAllocator : FriendAllocator<T> {
+  typedef T value_type;
+  template<class U> struct rebind { typedef XmlArenaAllocator<U> other; };
+  XmlArenaP arena;
+  explicit XmlArenaAllocator (const XmlArenaP &a) : arena (a) {}
+  template<class U>
+  XmlArenaAllocator (const XmlArenaAllocator<U> &other) : arena (other.arena) {}
+  T*   allocate   (size_t n)            { return (T*) arena->allocate (n * sizeof (T)); }
+  void deallocate (T *p, size_t n)      {} // memory is reclaimed by ~XmlArena()
+};
+
 class XmlNodeText : public virtual XmlNode {
   friend class FriendAllocator<XmlNodeText>;
   String                text_;
@@ -141,9 +251,15 @@ public:
   XmlNodeText (const String &utf8text,
                uint          line,
                uint          _char,
-               const String &file) :
-    XmlNode ("", line, _char, file), text_ (utf8text)
+               XmlAtom       file) :
+    XmlNode (empty_atom(), line, _char, file), text_ (utf8text)
   {}
+  static XmlAtom
+  empty_atom ()
+  {
+    static const XmlAtom empty = atom ("");
+    return empty;
+  }
 };
 
 class XmlNodeParent : public virtual XmlNode {
@@ -191,10 +307,10 @@ class XmlNodeParent : public virtual XmlNode {
       del_child (*children_[children_.size() - 1]);
   }
 public:
-  XmlNodeParent (const String &element_name,
-                 uint          line,
-                 uint          _char,
-                 const String &file) :
+  XmlNodeParent (XmlAtom element_name,
+                 uint    line,
+                 uint    _char,
+                 XmlAtom file) :
     XmlNode (element_name, line, _char, file)
   {}
 };
@@ -202,8 +318,10 @@ public:
 class XmlNodeParser : public Rapicorn::MarkupParser {
   vector<XmlNodeP> node_stack_;
   XmlNodeP         first_;
+  XmlArenaP        arena_;
+  const XmlAtom    file_;
   XmlNodeParser (const String &input_name) :
-    MarkupParser (input_name), first_ (NULL)
+    MarkupParser (input_name), first_ (NULL), arena_ (std::make_shared<XmlArena>()), file_ (XmlNode::atom (input_name))
   {}
   virtual
   ~XmlNodeParser()
@@ -219,7 +337,8 @@ class XmlNodeParser : public Rapicorn::MarkupParser {
       error.set (INVALID_ELEMENT, String() + "invalid element name: <" + escape_text (element_name) + "/>");
     int xline, xchar;
     get_position (&xline, &xchar);
-    XmlNodeP xnode = XmlNode::create_parent (element_name, xline, xchar, input_name());
+    XmlNodeP xnode = std::allocate_shared<XmlNodeParent> (XmlArenaAllocator<XmlNodeParent> (arena_),
+                                                          XmlNode::atom (element_name), xline, xchar, file_);
     for (uint i = 0; i < attribute_names.size(); i++)
       xnode->set_attribute (attribute_names[i], attribute_values[i]);
     if (current)
@@ -249,7 +368,7 @@ class XmlNodeParser : public Rapicorn::MarkupParser {
     XmlNodeP current = node_stack_.size() ? node_stack_[node_stack_.size() - 1] : NULL;
     int xline, xchar;
     get_position (&xline, &xchar);
-    XmlNodeP xnode = XmlNode::create_text (text, xline, xchar, input_name());
+    XmlNodeP xnode = std::allocate_shared<XmlNodeText> (XmlArenaAllocator<XmlNodeText> (arena_), text, xline, xchar, file_);
     if (current)
       current->add_child (*xnode);
     else
@@ -297,7 +416,7 @@ XmlNode::create_text (const String &utf8text,
                       uint          _char,
                       const String &file)
 {
-  return FriendAllocator<XmlNodeText>::make_shared (utf8text, line, _char, file);
+  return FriendAllocator<XmlNodeText>::make_shared (utf8text, line, _char, atom (file));
 }
 
 XmlNodeP
@@ -306,7 +425,7 @@ XmlNode::create_parent (const String &element_name,
                         uint          _char,
                         const String &file)
 {
-  return FriendAllocator<XmlNodeParent>::make_shared (element_name, line, _char, file);
+  return FriendAllocator<XmlNodeParent>::make_shared (atom (element_name), line, _char, atom (file));
 }
 
 XmlNodeP
@@ -384,9 +503,9 @@ node_xml_string (const XmlNode &node, size_t indent, bool include_outer, size_t
   if (include_outer)
     {
       s += "<" + node.xml_escape (node.name());
-      const StringVector &keys = node.list_attributes(), &values = node.list_values();
-      for (size_t i = 0; i < keys.size(); i++)
-        s += " " + node.xml_escape (keys[i]) + "=\"" + escape_xml<ALL-SQ> (values[i]) + "\"";
+      const StringVector &values = node.list_values();
+      for (size_t i = 0; i < values.size(); i++)
+        s += " " + node.xml_escape (*node.attribute_atom (i)) + "=\"" + escape_xml<ALL-SQ> (values[i]) + "\"";
     }
   XmlNode::ConstNodes &cl = node.children();
   if (!cl.empty())
@@ -423,4 +542,202 @@ XmlNode::xml_string (size_t indent, bool include_outer, size_t recursion_depth,
   return node_xml_string (*this, indent, include_outer, recursion_depth, wrapper, wrap_outer);
 }
 
+// == Binary Bundles ==
+/* A bundle is a flattened XmlNode tree that can be used in place, e.g. from an mmap-ed file
+ * or an embedded resource. All fields are native endian uint32 words, layout:
+ * XmlBundleHeader, uint32 string_offsets[n_strings + 1], char strings[string_bytes] (0-terminated),
+ * padding to 4 bytes, XmlBundleNode nodes[n_nodes] (preorder), XmlBundleAttribute attributes[n_attributes].
+ * String 0 is always "", text nodes have an empty name.
+ */
+static const char xml_bundle_magic[8] = { '\211', 'R', 'U', 'I', 'B', '\r', '\n', '\032' };
+enum { XML_BUNDLE_VERSION = 1, XML_BUNDLE_BYTE_ORDER = 0x01020304 };
+
+struct XmlBundleHeader {
+  char   magic[8];
+  uint32 version, byte_order, file;
+  uint32 n_strings, string_bytes, n_nodes, n_attributes;
+};
+struct XmlBundleNode {
+  uint32 name, text, line, chr;
+  uint32 n_children, attributes, n_attributes;
+};
+struct XmlBundleAttribute {
+  uint32 name, value;
+};
+
+static inline size_t
+xml_bundle_align4 (size_t n)
+{
+  return (n + 3) & ~size_t (3);
+}
+
+namespace { // Anon
+class XmlBundleWriter {
+  std::unordered_map<String,uint32> string_ids_;
+  vector<uint32>                    string_offsets_;
+  String                            string_data_;
+public:
+  vector<XmlBundleNode>             nodes;
+  vector<XmlBundleAttribute>        attributes;
+  uint32
+  string_id (const String &string)
+  {
+    auto it = string_ids_.find (string);
+    if (it != string_ids_.end())
+      return it->second;
+    const uint32 id = string_offsets_.size();
+    string_ids_[string] = id;
+    string_offsets_.push_back (string_data_.size());
+    string_data_.append (string.c_str(), string.size() + 1);
+    return id;
+  }
+  void
+  add_node (const XmlNode &node)
+  {
+    XmlBundleNode bnode = { 0, 0, node.parsed_line(), node.parsed_char(), 0, uint32 (attributes.size()), 0 };
+    if (node.istext())
+      bnode.text = string_id (node.text());
+    else
+      {
+        bnode.name = string_id (node.name());
+        const StringVector &values = node.list_values();
+        for (size_t i = 0; i < values.size(); i++)
+          attributes.push_back (XmlBundleAttribute { string_id (*node.attribute_atom (i)), string_id (values[i]) });
+        bnode.n_attributes = values.size();
+        bnode.n_children = node.children().size();
+      }
+    nodes.push_back (bnode);
+    if (!node.istext())
+      for (const XmlNodeP &child : node.children())
+        add_node (*child);
+  }
+  String
+  bundle (uint32 file)
+  {
+    const uint32 n_strings = string_offsets_.size();
+    string_offsets_.push_back (string_data_.size());
+    XmlBundleHeader header = { { 0, }, XML_BUNDLE_VERSION, XML_BUNDLE_BYTE_ORDER, file,
+                               n_strings, uint32 (string_data_.size()), uint32 (nodes.size()), uint32 (attributes.size()) };
+    memcpy (header.magic, xml_bundle_magic, sizeof (header.magic));
+    String result ((const char*) &header, sizeof (header));
+    result.append ((const char*) string_offsets_.data(), string_offsets_.size() * sizeof (uint32));
+    result.append (string_data_);
+    result.resize (xml_bundle_align4 (result.size()));
+    result.append ((const char*) nodes.data(), nodes.size() * sizeof (nodes[0]));
+    result.append ((const char*) attributes.data(), attributes.size() * sizeof (attributes[0]));
+    return result;
+  }
+};
+} // Anon
+
+/// Flatten the tree rooted at this node into a binary bundle for XmlNode::load_bundle().
+String
+XmlNode::xml_bundle () const
+{
+  XmlBundleWriter writer;
+  writer.string_id ("");
+  const uint32 file = writer.string_id (parsed_file());
+  writer.add_node (*this);
+  return writer.bundle (file);
+}
+
+/// Check if @a data starts with the signature of a binary bundle.
+bool
+XmlNode::is_bundle (const char *data, size_t length)
+{
+  return data && length >= sizeof (XmlBundleHeader) && memcmp (data, xml_bundle_magic, sizeof (xml_bundle_magic)) == 0;
+}
+
+/// Reconstruct an XmlNode tree from a bundle created by xml_bundle(), without any markup parsing.
+XmlNodeP
+XmlNode::load_bundle (const char *data, size_t length, String *errorp)
+{
+  vector<uint32> aligned_copy;
+  if (uintptr_t (data) & 3)
+    {
+      aligned_copy.resize ((length + 3) / 4);
+      memcpy (aligned_copy.data(), data, length);
+      data = (const char*) aligned_copy.data();
+    }
+  auto error = [errorp] (const char *message) -> XmlNodeP {
+    if (errorp)
+      *errorp = message;
+    return NULL;
+  };
+  if (!is_bundle (data, length))
+    return error ("invalid bundle signature");
+  const XmlBundleHeader &header = *(const XmlBundleHeader*) data;
+  if (header.byte_order != XML_BUNDLE_BYTE_ORDER)
+    return error ("unsupported bundle byte order");
+  if (header.version != XML_BUNDLE_VERSION)
+    return error ("unsupported bundle version");
+  // validate section sizes
+  const uint64 string_data_offset = sizeof (header) + (header.n_strings + uint64 (1)) * sizeof (uint32);
+  const uint64 nodes_offset = xml_bundle_align4 (string_data_offset + header.string_bytes);
+  const uint64 attributes_offset = nodes_offset + header.n_nodes * uint64 (sizeof (XmlBundleNode));
+  if (attributes_offset + header.n_attributes * uint64 (sizeof (XmlBundleAttribute)) > length ||
+      header.n_strings < 1 || header.n_nodes < 1 || header.file >= header.n_strings)
+    return error ("truncated bundle");
+  const uint32 *string_offsets = (const uint32*) (data + sizeof (header));
+  const char *string_data = data + string_data_offset;
+  if (string_offsets[0] != 0 || string_offsets[header.n_strings] != header.string_bytes)
+    return error ("corrupt bundle string table");
+  for (uint32 i = 0; i < header.n_strings; i++)
+    if (string_offsets[i] >= string_offsets[i + 1] || string_data[string_offsets[i + 1] - 1] != 0)
+      return error ("corrupt bundle string table");
+  auto string_length = [string_offsets] (uint32 id) { return string_offsets[id + 1] - string_offsets[id] - 1; };
+  auto string_at = [&] (uint32 id) { return String (string_data + string_offsets[id], string_length (id)); };
+  vector<XmlAtom> atoms (header.n_strings, NULL);       // each bundle string is interned at most once
+  auto atom_at = [&] (uint32 id) { return atoms[id] ? atoms[id] : (atoms[id] = atom (string_at (id))); };
+  const XmlBundleNode *nodes = (const XmlBundleNode*) (data + nodes_offset);
+  const XmlBundleAttribute *attributes = (const XmlBundleAttribute*) (data + attributes_offset);
+  // rebuild preorder tree
+  const XmlAtom file = atom_at (header.file);
+  XmlArenaP arena = std::make_shared<XmlArena>();
+  vector<std::pair<XmlNode*,uint32>> parents;           // node and number of children still missing
+  XmlNodeP root;
+  for (uint32 n = 0; n < header.n_nodes; n++)
+    {
+      const XmlBundleNode &bnode = nodes[n];
+      if (bnode.name >= header.n_strings || bnode.text >= header.n_strings ||
+          bnode.attributes > header.n_attributes || bnode.n_attributes > header.n_attributes - bnode.attributes)
+        return error ("corrupt bundle node");
+      if (n && parents.empty())
+        return error ("multiple toplevel nodes in bundle");
+      XmlNodeP xnode;
+      if (string_length (bnode.name) == 0)
+        {
+          if (bnode.n_children || bnode.n_attributes)
+            return error ("corrupt bundle text node");
+          xnode = std::allocate_shared<XmlNodeText> (XmlArenaAllocator<XmlNodeText> (arena), string_at (bnode.text), bnode.line, bnode.chr, file);
+        }
+      else
+        {
+          xnode = std::allocate_shared<XmlNodeParent> (XmlArenaAllocator<XmlNodeParent> (arena), atom_at (bnode.name), bnode.line, bnode.chr, file);
+          xnode->attribute_names_.reserve (bnode.n_attributes);
+          xnode->attribute_values_.reserve (bnode.n_attributes);
+          for (uint32 i = bnode.attributes; i < bnode.attributes + bnode.n_attributes; i++)
+            {
+              if (attributes[i].name >= header.n_strings || attributes[i].value >= header.n_strings)
+                return error ("corrupt bundle attribute");
+              xnode->attribute_names_.push_back (atom_at (attributes[i].name));
+              xnode->attribute_values_.push_back (string_at (attributes[i].value));
+            }
+        }
+      if (parents.empty())
+        root = xnode;
+      else
+        {
+          parents.back().first->add_child (*xnode);
+          if (--parents.back().second == 0)
+            parents.pop_back();
+        }
+      if (bnode.n_children)
+        parents.push_back (std::make_pair (xnode.get(), bnode.n_children));
+    }
+  if (!parents.empty())
+    return error ("truncated bundle tree");
+  return root;
+}
+
 } // Rapicorn
@@ -9,28 +9,50 @@ namespace Rapicorn {
 class XmlNode;
 typedef std::shared_ptr<XmlNode> XmlNodeP;
 typedef std::weak_ptr  <XmlNode> XmlNodeW;
+/** Interned string, equal XmlAtom strings have equal pointers.
+ * Atoms live in a process wide table that only grows and is guarded by a mutex, XmlNode::atom(),
+ * XmlNode::lookup_atom() and the String variants of set_attribute(), has_attribute(), get_attribute()
+ * and del_attribute() lock it on every call. Hot paths should look up XmlAtom values once and use the
+ * XmlAtom overloads, and dynamically generated attribute names should be avoided, they are never freed.
+ */
+typedef const String*            XmlAtom;
 
 /** Simple XML tree representation.
  * @DISCOURAGED: Nonpublic API, data structure used internally.
  */
 class XmlNode : public virtual DataListContainer, public virtual std::enable_shared_from_this<XmlNode> {
-  String                name_; // element name
+  XmlAtom               name_; // element name
   XmlNode              *parent_;
-  StringVector          attribute_names_;
+  vector<XmlAtom>       attribute_names_;
   StringVector          attribute_values_;
-  String                file_;
+  XmlAtom               file_;
   uint                  line_, char_;
+  ssize_t               find_attribute  (XmlAtom name) const;
 protected:
-  explicit              XmlNode         (const String&, uint, uint, const String&);
+  explicit              XmlNode         (XmlAtom, uint, uint, XmlAtom);
   virtual              ~XmlNode         ();
   static void           set_parent      (XmlNode *c, XmlNode *p);
 public:
   typedef const vector<XmlNodeP>     ConstNodes;
   typedef ConstNodes::const_iterator ConstChildIter;
-  String                name            () const                { return name_; }
+  /// Read-only view of the attribute names of a node, valid while the node's attributes are unchanged.
+  class AttributeNames {
+    const vector<XmlAtom> &atoms_;
+  public:
+    explicit      AttributeNames (const vector<XmlAtom> &atoms) : atoms_ (atoms) {}
+    size_t        size           () const                { return atoms_.size(); }
+    bool          empty          () const                { return atoms_.empty(); }
+    const String& operator[]     (size_t nth) const      { return *atoms_[nth]; }
+    operator      StringVector   () const;               ///< Copy the names, e.g. to extend the list.
+  };
+  static XmlAtom        atom            (const String &string);
+  static XmlAtom        lookup_atom     (const String &string);
+  const String&         name            () const                { return *name_; }
+  XmlAtom               name_atom       () const                { return name_; }
   XmlNode*              parent          () const                { return parent_; }
-  const StringVector&   list_attributes () const                { return attribute_names_; }
+  AttributeNames        list_attributes () const                { return AttributeNames (attribute_names_); }
   const StringVector&   list_values     () const                { return attribute_values_; }
+  XmlAtom               attribute_atom  (size_t nth) const      { return attribute_names_[nth]; }
   bool                  set_attribute   (const String   &name,
                                          const String   &value,
                                          bool            replace = true);
@@ -39,13 +61,16 @@ public:
   bool                  has_attribute   (const String   &name,
                                          bool            case_insensitive = false,
                                          String         *valuep = NULL) const;
+  String                get_attribute   (XmlAtom         name) const;
+  bool                  has_attribute   (XmlAtom         name,
+                                         String         *valuep = NULL) const;
   bool                  del_attribute   (const String   &name);
-  String                parsed_file     () const                { return file_; }
+  const String&         parsed_file     () const                { return *file_; }
   uint                  parsed_line     () const                { return line_; }
   uint                  parsed_char     () const                { return char_; }
   // Text Nodes
   virtual String        text            () const = 0;
-  bool                  istext          () const                { return name_.size() == 0; }
+  bool                  istext          () const                { return name_->size() == 0; }
   // Container Nodes
   virtual ConstNodes&   children        () const = 0;
   ConstChildIter        children_begin  () const { return children().begin(); }
@@ -76,6 +101,13 @@ public:
                                          const String   &roottag = "");
   static String         xml_escape      (const String   &input);
   static String         strip_xml_tags  (const String   &input);
+  // Binary Bundles
+  String                xml_bundle      () const;
+  static bool           is_bundle       (const char     *data,
+                                         size_t          length);
+  static XmlNodeP       load_bundle     (const char     *data,
+                                         size_t          length,
+                                         String         *errorp = NULL);
 };
 
 } // Rapicorn
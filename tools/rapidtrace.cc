@@ -0,0 +1,94 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include <rapicorn.hh>
+
+#include <string.h>
+#include <errno.h>
+
+namespace {
+using namespace Rapicorn;
+
+static void
+help_usage (bool usage_error)
+{
+  const char *usage = "Usage: rapidtrace [OPTIONS] <TraceFile>...";
+  if (usage_error)
+    {
+      printerr ("%s\n", usage);
+      printerr ("Try 'rapidtrace --help' for more information.\n");
+      exit (1);
+    }
+  printout ("%s\n", usage);
+  /*         12345678901234567890123456789012345678901234567890123456789012345678901234567890 */
+  printout ("Convert binary trace files into debugging messages.\n");
+  printout ("Trace files are recorded for the debugging keys listed in $RAPICORN_TRACE,\n");
+  printout ("e.g. RAPICORN_TRACE=aida:loop:XEvents:tracefile=/tmp/app.trace\n");
+  printout ("\n");
+  printout ("Options:\n");
+  printout ("  --absolute                    Print absolute instead of relative timestamps.\n");
+  printout ("  --location                    Print source locations of the trace sites.\n");
+  printout ("  -h, --help                    Display this help and exit.\n");
+  printout ("  -v, --version                 Display version and exit.\n");
+}
+
+static bool absolute_stamps = false;
+static bool print_location = false;
+
+} // anon
+
+int
+main (int argc, char *argv[])
+{
+  vector<String> files;
+  for (int i = 1; i < argc; i++)
+    if (strcmp (argv[i], "--absolute") == 0)
+      absolute_stamps = true;
+    else if (strcmp (argv[i], "--location") == 0)
+      print_location = true;
+    else if (strcmp (argv[i], "-h") == 0 || strcmp (argv[i], "--help") == 0)
+      {
+        help_usage (false);
+        exit (0);
+      }
+    else if (strcmp (argv[i], "-v") == 0 || strcmp (argv[i], "--version") == 0)
+      {
+        printout ("rapidtrace (Rapicorn utilities) %s (Build ID: %s)\n", rapicorn_version().c_str(), rapicorn_buildid().c_str());
+        exit (0);
+      }
+    else if (argv[i][0] == '-' && argv[i][1])
+      help_usage (true);
+    else
+      files.push_back (argv[i]);
+  if (files.empty())
+    help_usage (true);
+  int exitcode = 0;
+  for (const String &file : files)
+    {
+      Blob blob = Blob::load (file);
+      if (!blob)
+        {
+          printerr ("%s: failed to load: %s\n", file, strerror (errno));
+          exitcode = 1;
+          continue;
+        }
+      uint64 start = 0;
+      String error;
+      const bool valid = trace_decode (String (blob.data(), blob.size()), [&] (const TraceEvent &event) {
+          if (!event.key)
+            {
+              printout ("[%u]: %u trace records dropped\n", event.tid, event.dropped);
+              return;
+            }
+          start = start ? start : event.stamp;
+          const String stamp = absolute_stamps ? string_format ("%.6f", event.stamp / 1000000.0) :
+                               timestamp_format (max (event.stamp, start) - start);
+          const String location = print_location ? string_format ("%s:%d: ", event.file, event.line) : "";
+          printout ("[%s] [%u] %s%s: %s\n", stamp, event.tid, location, event.key, event.message);
+        }, &error);
+      if (!valid)
+        {
+          printerr ("%s: %s\n", file, error);
+          exitcode = 1;
+        }
+    }
+  return exitcode;
+}
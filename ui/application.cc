@@ -89,16 +89,12 @@ ApplicationImpl::auto_load (const String &file_name, const String &binary_path,
 {
   String fullname = auto_path (file_name, binary_path, true);
   StringSeq definitions;
-  size_t flen = 0;
   String errors;
-  char *fdata = Path::memread (fullname, &flen);
-  if (!fdata)
+  Blob blob = Blob::load (fullname); // large files, e.g. rapiduib bundles, are mmap-ed
+  if (!blob)
     errors = strerror (errno ? errno : ENOENT);
   else
-    {
-      errors = Factory::parse_ui_data (fullname, flen, fdata, i18n_domain, NULL, &definitions);
-      Path::memfree (fdata);
-    }
+    errors = Factory::parse_ui_data (fullname, blob.size(), blob.data(), i18n_domain, NULL, &definitions);
   if (!errors.empty())
     fatal ("%s: %s", fullname.c_str(), errors.c_str());
   return definitions;
@@ -9,7 +9,9 @@ ArrangementImpl::ArrangementImpl() :
   origin_hanchor_ (0.5),
   origin_vanchor_ (0.5),
   child_area_()
-{}
+{
+  set_flag (CONCURRENT_RENDER); // paints nothing, only places its children
+}
 
 ArrangementImpl::~ArrangementImpl()
 {}
@@ -1,49 +1,113 @@
 // This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
 #include "binding.hh"
 #include "application.hh"
+#include "uithread.hh"
 #include <algorithm>
 
 namespace Rapicorn {
 
 // == BindableRelayImpl ==
-BindableRelayImpl::Request::Request (Type t, uint64 n, const String &p, const Any &a) :
-  type (t), nonce (n), path (p), any (a)
+BindableRelayImpl::Request::Request (Type t, const String &p) :
+  type (t), path (p)
 {
-  assert_return (nonce > 0);
   assert_return (path.empty() == false);
 }
 
-BindableRelayImpl::BindableRelayImpl ()
+BindableRelayImpl::BindableRelayImpl () :
+  last_nonce_ (random_nonce()), flush_id_ (0)
 {}
 
 BindableRelayImpl::~BindableRelayImpl ()
 {}
 
+uint64
+BindableRelayImpl::next_nonce ()
+{
+  // nonces only need to be unique per relay, a random start avoids confusion with stale replies
+  last_nonce_ += 1;
+  if (last_nonce_ == 0 || int64 (last_nonce_) < 0)
+    last_nonce_ = 1;
+  return last_nonce_;
+}
+
+void
+BindableRelayImpl::queue_flush ()
+{
+  return_unless (flush_id_ == 0);
+  MainLoopP loop = uithread_main_loop();
+  if (!loop)
+    return flush_requests();
+  std::shared_ptr<BindableRelayImpl> thisp = shared_ptr_cast<BindableRelayImpl> (this);
+  flush_id_ = loop->exec_callback ([thisp] () { thisp->flush_requests(); }, EventLoop::PRIORITY_UPDATE);
+}
+
+void
+BindableRelayImpl::flush_requests ()
+{
+  flush_id_ = 0;
+  vector<PathValue> sets;
+  sets.swap (queued_sets_);
+  queued_set_index_.clear();
+  for (const auto &pv : sets)
+    {
+      const uint64 nonce = next_nonce();
+      requests_.emplace (nonce, Request (Request::SET, pv.first));
+      sig_relay_set.emit (pv.first, nonce, pv.second);
+    }
+  vector<String> notifies;
+  notifies.swap (queued_notifies_);
+  queued_notify_set_.clear();
+  for (const auto &path : notifies)
+    bindable_notify (path);
+}
+
+void
+BindableRelayImpl::invalidate_cache (const String &prefix)
+{
+  // erase prefix and all paths below it, e.g. "a" covers "a" and "a.b" but not "ab"
+  auto it = cache_.lower_bound (prefix);
+  while (it != cache_.end() && it->first.compare (0, prefix.size(), prefix) == 0)
+    if (it->first.size() == prefix.size() || it->first[prefix.size()] == '.')
+      it = cache_.erase (it);
+    else
+      ++it;
+}
+
 void
 BindableRelayImpl::bindable_set (const String &bpath, const Any &any)
 {
-  const Request req (Request::SET, random_nonce(), bpath);
-  requests_.push_back (req);
-  sig_relay_set.emit (req.path, req.nonce, any);
+  return_unless (bpath.empty() == false);
+  cache_.erase (bpath);
+  pending_gets_.erase (bpath); // results of earlier GETs predate this SET
+  auto it = queued_set_index_.find (bpath);
+  if (it != queued_set_index_.end())
+    queued_sets_[it->second].second = any; // coalesce with unflushed SET
+  else
+    {
+      queued_set_index_[bpath] = queued_sets_.size();
+      queued_sets_.push_back (PathValue (bpath, any));
+    }
+  queue_flush();
 }
 
 void
 BindableRelayImpl::bindable_get (const String &bpath, Any &any)
 {
-  auto it = std::find_if (requests_.begin(), requests_.end(),
-                          [&bpath] (const Request &req) {
-                            return req.type == Request::CACHE && req.path == bpath;
-                          });
-  if (it != requests_.end()) // result provided from previous property read out
+  auto it = cache_.find (bpath);
+  if (it != cache_.end()) // result provided from previous property read out
     {
-      Request &req = *it;
-      any = req.any;
-      requests_.erase (it);
+      any = it->second;
+      cache_.erase (it);
       return;
     }
-  const Request req (Request::GET, random_nonce(), bpath);
-  requests_.push_back (req);
-  sig_relay_get.emit (req.path, req.nonce);
+  if (pending_gets_.count (bpath))
+    return; // coalesce with outstanding GET
+  if (!queued_sets_.empty())
+    flush_requests(); // preserve SET before GET ordering
+  const uint64 nonce = next_nonce();
+  requests_.emplace (nonce, Request (Request::GET, bpath));
+  pending_gets_[bpath] = nonce;
+  sig_relay_get.emit (bpath, nonce);
   // we're not immediately returning a value,
   // once the remote result is in, we'll notify about change
 }
@@ -51,32 +115,42 @@ BindableRelayImpl::bindable_get (const String &bpath, Any &any)
 void
 BindableRelayImpl::report_result (int64 nonce, const Any &result, const String &error)
 {
-  auto it = std::find_if (requests_.begin(), requests_.end(), [nonce] (const Request &req) { return req.nonce == uint64 (nonce); });
+  auto it = requests_.find (nonce);
   if (it == requests_.end())
     {
       RAPICORN_DIAG ("Rapicorn::BindableRelayImpl::report_result: discarding unsolicited result (nonce=0x%016x)", nonce);
       return;
     }
-  Request &req = *it;
-  if (req.type == Request::GET && error.empty())
+  const Request req = it->second;
+  requests_.erase (it);
+  if (req.type == Request::GET)
     {
-      // mutate this request into a cached value for a future bindable_get call
-      req.type = Request::CACHE;
-      req.nonce = 0;
-      req.any = result;
-      // cause another bindable_get call to fetch this new value
-      bindable_notify (req.path);
-      return; // preserve request
+      auto pit = pending_gets_.find (req.path);
+      const bool current = pit != pending_gets_.end() && pit->second == uint64 (nonce);
+      if (current)
+        pending_gets_.erase (pit);
+      if (error.empty())
+        {
+          if (!current)
+            return; // superseded by a later SET, the value is stale
+          // keep result as cached value for a future bindable_get call
+          cache_[req.path] = result;
+          // cause another bindable_get call to fetch this new value
+          bindable_notify (req.path);
+          return;
+        }
     }
   if (!error.empty())
     critical ("BindableRelayImpl: error from remote: %s", error.empty() ? "unknown" : error);
-  requests_.erase (it);
 }
 
 void
 BindableRelayImpl::report_notify (const String &bpath)
 {
-  bindable_notify (bpath);
+  invalidate_cache (bpath);
+  if (queued_notify_set_.insert (bpath).second)
+    queued_notifies_.push_back (bpath);
+  queue_flush();
 }
 
 BindableRelayIfaceP
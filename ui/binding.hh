@@ -3,6 +3,8 @@
 #define __RAPICORN_BINDING_HH__
 
 #include <ui/widget.hh>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace Rapicorn {
 
@@ -11,14 +13,25 @@ typedef std::shared_ptr<Binding> BindingP; ///< Pointer type to manage Binding o
 
 class BindableRelayImpl : public virtual BindableRelayIface, public virtual BindableIface {
   struct Request {
-    enum Type { NONE, SET, GET, CACHE };
+    enum Type { NONE, SET, GET };
     Type         type;
-    uint64       nonce;
     String       path;
-    Any          any;
-    explicit     Request (Type t, uint64 n, const String &p, const Any &a = Any());
+    explicit     Request (Type t, const String &p);
   };
-  vector<Request> requests_;
+  typedef std::pair<String, Any> PathValue;
+  std::unordered_map<uint64, Request> requests_;        // outstanding remote requests by nonce
+  std::unordered_map<String, uint64>  pending_gets_;    // path -> nonce of outstanding GET
+  std::map<String, Any>               cache_;           // remote results by path, ordered for prefix invalidation
+  vector<PathValue>                   queued_sets_;     // SETs awaiting flush, one per path
+  std::unordered_map<String, size_t>  queued_set_index_;
+  vector<String>                      queued_notifies_; // notifications awaiting flush, one per path
+  std::unordered_set<String>          queued_notify_set_;
+  uint64                              last_nonce_;
+  uint                                flush_id_;
+  uint64        next_nonce              ();
+  void          queue_flush             ();
+  void          flush_requests          ();
+  void          invalidate_cache        (const String &prefix);
 protected:
   explicit      BindableRelayImpl       ();
   virtual      ~BindableRelayImpl       ();
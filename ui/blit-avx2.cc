@@ -0,0 +1,153 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include "blitfuncs.hh"
+#ifdef RAPICORN_TARGET_AVX2
+#include <immintrin.h>
+// kernels only, inline functions from headers must not be compiled for AVX2
+#define AVX2_KERNEL     __attribute__ ((target ("avx2")))
+#endif /* RAPICORN_TARGET_AVX2 */
+
+namespace Rapicorn {
+namespace Blit {
+#ifdef RAPICORN_TARGET_AVX2
+
+// IMUL for 16 words: (v * alpha * 0x0101 + 0x8080) >> 16 == (t + 0x80 + ((t + 0x80) >> 8)) >> 8, t = v * alpha
+AVX2_KERNEL static inline __m256i
+imul_16x16 (__m256i v, __m256i alpha)
+{
+  __m256i t = _mm256_add_epi16 (_mm256_mullo_epi16 (v, alpha), _mm256_set1_epi16 (0x80));
+  return _mm256_srli_epi16 (_mm256_add_epi16 (t, _mm256_srli_epi16 (t, 8)), 8);
+}
+
+// broadcast the alpha word of each pixel in a 16x16 vector
+AVX2_KERNEL static inline __m256i
+alpha_16x16 (__m256i v)
+{
+  v = _mm256_shufflelo_epi16 (v, _MM_SHUFFLE (3, 3, 3, 3));
+  return _mm256_shufflehi_epi16 (v, _MM_SHUFFLE (3, 3, 3, 3));
+}
+
+// unpack/pack operate within 128bit lanes, so pixel order is preserved across unpack, compute, pack
+AVX2_KERNEL static void
+avx2_combine_over (uint32 *dst, const uint32 *src, uint span)
+{
+  const __m256i zero = _mm256_setzero_si256(), mff = _mm256_set1_epi16 (0xff);
+  uint i = 0;
+  for (; i + 8 <= span; i += 8)
+    {
+      const __m256i s = _mm256_loadu_si256 ((const __m256i*) (src + i));
+      const __m256i d = _mm256_loadu_si256 ((const __m256i*) (dst + i));
+      const __m256i slo = _mm256_unpacklo_epi8 (s, zero), shi = _mm256_unpackhi_epi8 (s, zero);
+      const __m256i ilo = _mm256_sub_epi16 (mff, alpha_16x16 (slo)), ihi = _mm256_sub_epi16 (mff, alpha_16x16 (shi));
+      const __m256i dlo = imul_16x16 (_mm256_unpacklo_epi8 (d, zero), ilo);
+      const __m256i dhi = imul_16x16 (_mm256_unpackhi_epi8 (d, zero), ihi);
+      _mm256_storeu_si256 ((__m256i*) (dst + i), _mm256_add_epi8 (s, _mm256_packus_epi16 (dlo, dhi)));
+    }
+  for (; i < span; i++)
+    dst[i] = pixel_combine_over (dst[i], src[i]);
+}
+
+AVX2_KERNEL static void
+avx2_fill (uint32 *dst, uint32 pixel, uint span)
+{
+  const __m256i p = _mm256_set1_epi32 (pixel);
+  uint i = 0;
+  for (; i + 8 <= span; i += 8)
+    _mm256_storeu_si256 ((__m256i*) (dst + i), p);
+  for (; i < span; i++)
+    dst[i] = pixel;
+}
+
+// RGBA words into premultiplied BGRA words, IMUL (a, 0xff) == a keeps alpha
+AVX2_KERNEL static inline __m256i
+premultiply_rgba_16x16 (__m256i v)
+{
+  const __m256i keep_alpha = _mm256_set1_epi64x (0x00ff000000000000LL);
+  const __m256i rgb_mask = _mm256_set1_epi64x (0x0000ffffffffffffLL);
+  const __m256i alpha = _mm256_or_si256 (_mm256_and_si256 (alpha_16x16 (v), rgb_mask), keep_alpha);
+  v = imul_16x16 (v, alpha);
+  v = _mm256_shufflelo_epi16 (v, _MM_SHUFFLE (3, 0, 1, 2));
+  return _mm256_shufflehi_epi16 (v, _MM_SHUFFLE (3, 0, 1, 2));
+}
+
+AVX2_KERNEL static void
+avx2_premultiply_rgba (uint32 *dst, const uint8 *rgba, uint span)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  uint i = 0;
+  for (; i + 8 <= span; i += 8)
+    {
+      const __m256i v = _mm256_loadu_si256 ((const __m256i*) (rgba + 4 * i));
+      const __m256i lo = premultiply_rgba_16x16 (_mm256_unpacklo_epi8 (v, zero));
+      const __m256i hi = premultiply_rgba_16x16 (_mm256_unpackhi_epi8 (v, zero));
+      _mm256_storeu_si256 ((__m256i*) (dst + i), _mm256_packus_epi16 (lo, hi));
+    }
+  for (; i < span; i++)
+    dst[i] = pixel_premultiply_rgba (rgba + 4 * i);
+}
+
+// (0xff * v + (alpha >> 1)) / alpha, numerators < 2^16 make the truncated float quotient exact
+AVX2_KERNEL static inline __m256i
+idiv_8x32 (__m256i v, __m256 fa, __m256i half, __m256i nonzero)
+{
+  const __m256 num = _mm256_add_ps (_mm256_mul_ps (_mm256_cvtepi32_ps (v), _mm256_set1_ps (255)), _mm256_cvtepi32_ps (half));
+  const __m256i q = _mm256_cvttps_epi32 (_mm256_div_ps (num, fa));
+  return _mm256_and_si256 (_mm256_and_si256 (q, _mm256_set1_epi32 (0xff)), nonzero);
+}
+
+AVX2_KERNEL static void
+avx2_unpremultiply_rgba (uint8 *rgba, const uint32 *src, uint span)
+{
+  const __m256i m8 = _mm256_set1_epi32 (0xff), zero = _mm256_setzero_si256();
+  uint i = 0;
+  for (; i + 8 <= span; i += 8)
+    {
+      const __m256i p = _mm256_loadu_si256 ((const __m256i*) (src + i));
+      const __m256i a = _mm256_srli_epi32 (p, 24), half = _mm256_srli_epi32 (a, 1);
+      const __m256i nonzero = _mm256_xor_si256 (_mm256_cmpeq_epi32 (a, zero), _mm256_set1_epi32 (-1));
+      const __m256 fa = _mm256_cvtepi32_ps (a);
+      const __m256i r = idiv_8x32 (_mm256_and_si256 (_mm256_srli_epi32 (p, 16), m8), fa, half, nonzero);
+      const __m256i g = idiv_8x32 (_mm256_and_si256 (_mm256_srli_epi32 (p, 8), m8), fa, half, nonzero);
+      const __m256i b = idiv_8x32 (_mm256_and_si256 (p, m8), fa, half, nonzero);
+      const __m256i bytes = _mm256_or_si256 (_mm256_or_si256 (r, _mm256_slli_epi32 (g, 8)),
+                                             _mm256_or_si256 (_mm256_slli_epi32 (b, 16), _mm256_slli_epi32 (a, 24)));
+      _mm256_storeu_si256 ((__m256i*) (rgba + 4 * i), bytes);
+    }
+  for (; i < span; i++)
+    pixel_unpremultiply_rgba (rgba + 4 * i, src[i]);
+}
+
+AVX2_KERNEL static uint
+avx2_find_mismatch (const uint32 *pixels1, const uint32 *pixels2, uint span)
+{
+  uint i = 0;
+  for (; i + 8 <= span; i += 8)
+    {
+      const __m256i a = _mm256_loadu_si256 ((const __m256i*) (pixels1 + i));
+      const __m256i b = _mm256_loadu_si256 ((const __m256i*) (pixels2 + i));
+      const uint equal = _mm256_movemask_epi8 (_mm256_cmpeq_epi32 (a, b));
+      if (equal != 0xffffffff)
+        return i + __builtin_ctz (~equal) / 4;
+    }
+  for (; i < span; i++)
+    if (pixels1[i] != pixels2[i])
+      break;
+  return i;
+}
+
+void
+render_optimize_avx2 (RenderTable *render_table)
+{
+  render_table->combine_over = avx2_combine_over;
+  render_table->fill = avx2_fill;
+  render_table->premultiply_rgba = avx2_premultiply_rgba;
+  render_table->unpremultiply_rgba = avx2_unpremultiply_rgba;
+  render_table->find_mismatch = avx2_find_mismatch;
+}
+
+#else  /* !RAPICORN_TARGET_AVX2 */
+void
+render_optimize_avx2 (RenderTable *render_table)
+{}
+#endif /* !RAPICORN_TARGET_AVX2 */
+} // Blit
+} // Rapicorn
@@ -0,0 +1,153 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include "blitfuncs.hh"
+#ifdef RAPICORN_TARGET_SSE2
+#include <emmintrin.h>
+// kernels only, inline functions from headers must not be compiled for SSE2
+#define SSE2_KERNEL     __attribute__ ((target ("sse2")))
+#endif /* RAPICORN_TARGET_SSE2 */
+
+namespace Rapicorn {
+namespace Blit {
+#ifdef RAPICORN_TARGET_SSE2
+
+// IMUL for 8 words: (v * alpha * 0x0101 + 0x8080) >> 16 == (t + 0x80 + ((t + 0x80) >> 8)) >> 8, t = v * alpha
+SSE2_KERNEL static inline __m128i
+imul_8x16 (__m128i v, __m128i alpha)
+{
+  __m128i t = _mm_add_epi16 (_mm_mullo_epi16 (v, alpha), _mm_set1_epi16 (0x80));
+  return _mm_srli_epi16 (_mm_add_epi16 (t, _mm_srli_epi16 (t, 8)), 8);
+}
+
+// broadcast the alpha word of each of the two pixels in a 8x16 vector
+SSE2_KERNEL static inline __m128i
+alpha_8x16 (__m128i v)
+{
+  v = _mm_shufflelo_epi16 (v, _MM_SHUFFLE (3, 3, 3, 3));
+  return _mm_shufflehi_epi16 (v, _MM_SHUFFLE (3, 3, 3, 3));
+}
+
+SSE2_KERNEL static void
+sse2_combine_over (uint32 *dst, const uint32 *src, uint span)
+{
+  const __m128i zero = _mm_setzero_si128(), mff = _mm_set1_epi16 (0xff);
+  uint i = 0;
+  for (; i + 4 <= span; i += 4)
+    {
+      const __m128i s = _mm_loadu_si128 ((const __m128i*) (src + i));
+      const __m128i d = _mm_loadu_si128 ((const __m128i*) (dst + i));
+      const __m128i slo = _mm_unpacklo_epi8 (s, zero), shi = _mm_unpackhi_epi8 (s, zero);
+      const __m128i ilo = _mm_sub_epi16 (mff, alpha_8x16 (slo)), ihi = _mm_sub_epi16 (mff, alpha_8x16 (shi));
+      const __m128i dlo = imul_8x16 (_mm_unpacklo_epi8 (d, zero), ilo);
+      const __m128i dhi = imul_8x16 (_mm_unpackhi_epi8 (d, zero), ihi);
+      // 8bit wrapping addition, like the ALU variant
+      _mm_storeu_si128 ((__m128i*) (dst + i), _mm_add_epi8 (s, _mm_packus_epi16 (dlo, dhi)));
+    }
+  for (; i < span; i++)
+    dst[i] = pixel_combine_over (dst[i], src[i]);
+}
+
+SSE2_KERNEL static void
+sse2_fill (uint32 *dst, uint32 pixel, uint span)
+{
+  const __m128i p = _mm_set1_epi32 (pixel);
+  uint i = 0;
+  for (; i + 4 <= span; i += 4)
+    _mm_storeu_si128 ((__m128i*) (dst + i), p);
+  for (; i < span; i++)
+    dst[i] = pixel;
+}
+
+// premultiply 2 pixels of RGBA words and reorder into BGRA words, i.e. native endian ARGB
+SSE2_KERNEL static inline __m128i
+premultiply_rgba_8x16 (__m128i v)
+{
+  const __m128i keep_alpha = _mm_set_epi16 (0xff, 0, 0, 0, 0xff, 0, 0, 0);
+  const __m128i rgb_mask = _mm_set_epi16 (0, -1, -1, -1, 0, -1, -1, -1);
+  const __m128i alpha = _mm_or_si128 (_mm_and_si128 (alpha_8x16 (v), rgb_mask), keep_alpha); // IMUL (a, 0xff) == a
+  v = imul_8x16 (v, alpha);
+  v = _mm_shufflelo_epi16 (v, _MM_SHUFFLE (3, 0, 1, 2));
+  return _mm_shufflehi_epi16 (v, _MM_SHUFFLE (3, 0, 1, 2));
+}
+
+SSE2_KERNEL static void
+sse2_premultiply_rgba (uint32 *dst, const uint8 *rgba, uint span)
+{
+  const __m128i zero = _mm_setzero_si128();
+  uint i = 0;
+  for (; i + 4 <= span; i += 4)
+    {
+      const __m128i v = _mm_loadu_si128 ((const __m128i*) (rgba + 4 * i));
+      const __m128i lo = premultiply_rgba_8x16 (_mm_unpacklo_epi8 (v, zero));
+      const __m128i hi = premultiply_rgba_8x16 (_mm_unpackhi_epi8 (v, zero));
+      _mm_storeu_si128 ((__m128i*) (dst + i), _mm_packus_epi16 (lo, hi));
+    }
+  for (; i < span; i++)
+    dst[i] = pixel_premultiply_rgba (rgba + 4 * i);
+}
+
+// (0xff * v + (alpha >> 1)) / alpha, numerators < 2^16 make the truncated float quotient exact
+SSE2_KERNEL static inline __m128i
+idiv_4x32 (__m128i v, __m128 fa, __m128i half, __m128i nonzero)
+{
+  const __m128 num = _mm_add_ps (_mm_mul_ps (_mm_cvtepi32_ps (v), _mm_set1_ps (255)), _mm_cvtepi32_ps (half));
+  const __m128i q = _mm_cvttps_epi32 (_mm_div_ps (num, fa));
+  return _mm_and_si128 (_mm_and_si128 (q, _mm_set1_epi32 (0xff)), nonzero);
+}
+
+SSE2_KERNEL static void
+sse2_unpremultiply_rgba (uint8 *rgba, const uint32 *src, uint span)
+{
+  const __m128i m8 = _mm_set1_epi32 (0xff), zero = _mm_setzero_si128();
+  uint i = 0;
+  for (; i + 4 <= span; i += 4)
+    {
+      const __m128i p = _mm_loadu_si128 ((const __m128i*) (src + i));
+      const __m128i a = _mm_srli_epi32 (p, 24), half = _mm_srli_epi32 (a, 1);
+      const __m128i nonzero = _mm_xor_si128 (_mm_cmpeq_epi32 (a, zero), _mm_set1_epi32 (-1));
+      const __m128 fa = _mm_cvtepi32_ps (a);
+      const __m128i r = idiv_4x32 (_mm_and_si128 (_mm_srli_epi32 (p, 16), m8), fa, half, nonzero);
+      const __m128i g = idiv_4x32 (_mm_and_si128 (_mm_srli_epi32 (p, 8), m8), fa, half, nonzero);
+      const __m128i b = idiv_4x32 (_mm_and_si128 (p, m8), fa, half, nonzero);
+      const __m128i bytes = _mm_or_si128 (_mm_or_si128 (r, _mm_slli_epi32 (g, 8)),
+                                          _mm_or_si128 (_mm_slli_epi32 (b, 16), _mm_slli_epi32 (a, 24)));
+      _mm_storeu_si128 ((__m128i*) (rgba + 4 * i), bytes);
+    }
+  for (; i < span; i++)
+    pixel_unpremultiply_rgba (rgba + 4 * i, src[i]);
+}
+
+SSE2_KERNEL static uint
+sse2_find_mismatch (const uint32 *pixels1, const uint32 *pixels2, uint span)
+{
+  uint i = 0;
+  for (; i + 4 <= span; i += 4)
+    {
+      const __m128i a = _mm_loadu_si128 ((const __m128i*) (pixels1 + i));
+      const __m128i b = _mm_loadu_si128 ((const __m128i*) (pixels2 + i));
+      const uint equal = _mm_movemask_epi8 (_mm_cmpeq_epi32 (a, b));
+      if (equal != 0xffff)
+        return i + __builtin_ctz (~equal) / 4;
+    }
+  for (; i < span; i++)
+    if (pixels1[i] != pixels2[i])
+      break;
+  return i;
+}
+
+void
+render_optimize_sse2 (RenderTable *render_table)
+{
+  render_table->combine_over = sse2_combine_over;
+  render_table->fill = sse2_fill;
+  render_table->premultiply_rgba = sse2_premultiply_rgba;
+  render_table->unpremultiply_rgba = sse2_unpremultiply_rgba;
+  render_table->find_mismatch = sse2_find_mismatch;
+}
+
+#else  /* !RAPICORN_TARGET_SSE2 */
+void
+render_optimize_sse2 (RenderTable *render_table)
+{}
+#endif /* !RAPICORN_TARGET_SSE2 */
+} // Blit
+} // Rapicorn
@@ -0,0 +1,41 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include "blitfuncs.hh"
+#ifdef RAPICORN_TARGET_SSSE3
+#include <tmmintrin.h>
+// kernels only, inline functions from headers must not be compiled for SSSE3
+#define SSSE3_KERNEL     __attribute__ ((target ("ssse3")))
+#endif /* RAPICORN_TARGET_SSSE3 */
+
+namespace Rapicorn {
+namespace Blit {
+#ifdef RAPICORN_TARGET_SSSE3
+
+SSSE3_KERNEL static void
+ssse3_expand_rgb (uint32 *dst, const uint8 *rgb, uint span)
+{
+  // RGB byte triples into BGRA bytes (native endian ARGB), -1 yields zero bytes that are filled with alpha
+  const __m128i shuffle = _mm_setr_epi8 (2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+  const __m128i alpha = _mm_set1_epi32 (0xff000000);
+  uint i = 0;
+  for (; i + 6 <= span; i += 4) // 16 byte loads need 4 bytes beyond the 4 pixels consumed
+    {
+      const __m128i v = _mm_loadu_si128 ((const __m128i*) (rgb + 3 * i));
+      _mm_storeu_si128 ((__m128i*) (dst + i), _mm_or_si128 (_mm_shuffle_epi8 (v, shuffle), alpha));
+    }
+  for (; i < span; i++)
+    dst[i] = COL_ARGB (0xffU, rgb[3 * i], rgb[3 * i + 1], rgb[3 * i + 2]);
+}
+
+void
+render_optimize_ssse3 (RenderTable *render_table)
+{
+  render_table->expand_rgb = ssse3_expand_rgb;
+}
+
+#else  /* !RAPICORN_TARGET_SSSE3 */
+void
+render_optimize_ssse3 (RenderTable *render_table)
+{}
+#endif /* !RAPICORN_TARGET_SSSE3 */
+} // Blit
+} // Rapicorn
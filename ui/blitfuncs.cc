@@ -1,5 +1,6 @@
 // This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
 #include "blitfuncs.hh"
+#include <algorithm>
 
 namespace Rapicorn {
 namespace Blit {
@@ -49,41 +50,109 @@ alu_combine_over (uint32 *dst, const uint32 *src, uint span)
   const uint32 *limit = dst + span;
   while (dst < limit)
     {
-      /* extract alpha, red, green, blue */
-      uint32 Aa = COLA (*src), Ar = COLR (*src), Ag = COLG (*src), Ab = COLB (*src);
-      uint32 Ba = COLA (*dst), Br = COLR (*dst), Bg = COLG (*dst), Bb = COLB (*dst);
       /* A over B = colorA + colorB * (1 - alphaA) */
-      uint32 Ai = 255 - Aa;
-      uint8 Dr = Ar + Color::IMUL (Br, Ai);
-      uint8 Dg = Ag + Color::IMUL (Bg, Ai);
-      uint8 Db = Ab + Color::IMUL (Bb, Ai);
-      uint8 Da = Aa + Color::IMUL (Ba, Ai);
-      /* assign */
-      *dst++ = COL_ARGB (Da, Dr, Dg, Db);
+      *dst = pixel_combine_over (*dst, *src);
+      dst++;
       src++;
     }
 }
 
+static void
+alu_fill (uint32 *dst, uint32 pixel, uint span)
+{
+  std::fill (dst, dst + span, pixel);
+}
+
+static void
+alu_premultiply_rgba (uint32 *dst, const uint8 *rgba, uint span)
+{
+  for (uint i = 0; i < span; i++)
+    dst[i] = pixel_premultiply_rgba (rgba + 4 * i);
+}
+
+static void
+alu_expand_rgb (uint32 *dst, const uint8 *rgb, uint span)
+{
+  for (uint i = 0; i < span; i++, rgb += 3)
+    dst[i] = COL_ARGB (0xffU, rgb[0], rgb[1], rgb[2]);  // premultiplication with alpha=0xff is the identity
+}
+
+static void
+alu_unpremultiply_rgba (uint8 *rgba, const uint32 *src, uint span)
+{
+  for (uint i = 0; i < span; i++)
+    pixel_unpremultiply_rgba (rgba + 4 * i, src[i]);
+}
+
+static uint
+alu_find_mismatch (const uint32 *pixels1, const uint32 *pixels2, uint span)
+{
+  return std::mismatch (pixels1, pixels1 + span, pixels2).first - pixels1;
+}
+
 static void
 nop_clear_fpu (void)
 {
   /* clear render state for FPU use */
 }
 
-static const RenderTable&
-get_render_table()
+const char*
+render_level_name (RenderLevel level)
+{
+  switch (level)
+    {
+    case RENDER_ALU:    return "ALU";
+    case RENDER_MMX:    return "MMX";
+    case RENDER_SSE2:   return "SSE2";
+    case RENDER_SSSE3:  return "SSSE3";
+    case RENDER_AVX2:   return "AVX2";
+    }
+  return "<unknown>";
+}
+
+bool
+render_table_setup (RenderTable *table, RenderLevel level)
+{
+  assert_return (table != NULL, false);
+  const RenderTable alu_table = {
+    nop_clear_fpu,
+    alu_combine_over,
+    alu_gradient_line,
+    alu_fill,
+    alu_premultiply_rgba,
+    alu_expand_rgb,
+    alu_unpremultiply_rgba,
+    alu_find_mismatch,
+  };
+  *table = alu_table;
+  const String cpu = cpu_info();
+  const char *features[] = { "", " MMX ", " SSE2 ", " SSSE3 ", " AVX2 " };
+  for (int l = RENDER_MMX; l <= level; l++)
+    if (!strstr (cpu.c_str(), features[l]))
+      return false;
+  // each level extends the kernels of its predecessor
+  if (level >= RENDER_MMX)
+    render_optimize_mmx (table);
+  if (level >= RENDER_SSE2)
+    render_optimize_sse2 (table);
+  if (level >= RENDER_SSSE3)
+    render_optimize_ssse3 (table);
+  if (level >= RENDER_AVX2)
+    render_optimize_avx2 (table);
+  return true;
+}
+
+const RenderTable&
+render_table()
 {
-  static RenderTable render_table = []() {
-    RenderTable render_table = {
-      nop_clear_fpu,
-      alu_combine_over,
-      alu_gradient_line,
-    };
-    if (strstr (cpu_info().c_str(), " MMX "))
-      Blit::render_optimize_mmx (&render_table);
-    return render_table;
+  static const RenderTable best_table = []() {
+    RenderTable table;
+    for (int level = RENDER_AVX2; level >= RENDER_ALU; level--)
+      if (render_table_setup (&table, RenderLevel (level)))
+        break;
+    return table;
   } ();
-  return render_table;
+  return best_table;
 }
 
 } // Blit
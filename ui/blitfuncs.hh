@@ -25,6 +25,45 @@ namespace Blit {
 #endif
 #define COL_ARGB(a,r,g,b)       (((a) << 24) | ((r) << 16) | ((g) << 8) | (b))
 
+/// Multiply 8bit color value @a v with @a alpha, rounding like Color::IMUL().
+static inline uint8  pixel_imul  (uint8 v, uint8 alpha)         { return (v * alpha * 0x0101 + 0x8080) >> 16; }
+/// Divide 8bit color value @a v by @a alpha for unpremultiplication, @a alpha must be non-zero.
+static inline uint8  pixel_idiv  (uint8 v, uint8 alpha)         { return (0xff * v + (alpha >> 1)) / alpha; }
+
+/// Combine premultiplied ARGB pixels: src over dst.
+static inline uint32
+pixel_combine_over (uint32 dst, uint32 src)
+{
+  const uint8 Ai = 255 - COLA (src);
+  return COL_ARGB (uint32 (uint8 (COLA (src) + pixel_imul (COLA (dst), Ai))), uint8 (COLR (src) + pixel_imul (COLR (dst), Ai)),
+                   uint8 (COLG (src) + pixel_imul (COLG (dst), Ai)), uint8 (COLB (src) + pixel_imul (COLB (dst), Ai)));
+}
+
+/// Convert RGBA bytes into a premultiplied ARGB pixel.
+static inline uint32
+pixel_premultiply_rgba (const uint8 *rgba)
+{
+  const uint8 alpha = rgba[3];
+  return COL_ARGB (uint32 (alpha), pixel_imul (rgba[0], alpha), pixel_imul (rgba[1], alpha), pixel_imul (rgba[2], alpha));
+}
+
+/// Convert a premultiplied ARGB pixel into RGBA bytes.
+static inline void
+pixel_unpremultiply_rgba (uint8 *rgba, uint32 argb)
+{
+  const uint8 alpha = argb >> 24;
+  if (alpha == 0)
+    rgba[0] = rgba[1] = rgba[2] = 0;
+  else
+    {
+      rgba[0] = pixel_idiv (argb >> 16, alpha);
+      rgba[1] = pixel_idiv (argb >> 8, alpha);
+      rgba[2] = pixel_idiv (argb, alpha);
+    }
+  rgba[3] = alpha;
+}
+
+/// Pixel kernels operating on spans of native endian, premultiplied ARGB pixels.
 struct RenderTable {
   void  (*clear_fpu)            (void);
   void  (*combine_over)         (uint32       *dst,
@@ -40,9 +79,34 @@ struct RenderTable {
                                  uint32        red2pre16,
                                  uint32        green2pre16,
                                  uint32        blue2pre16);
+  void  (*fill)                 (uint32       *dst,
+                                 uint32        pixel,
+                                 uint          span);
+  void  (*premultiply_rgba)     (uint32       *dst,     // may alias rgba
+                                 const uint8  *rgba,
+                                 uint          span);
+  void  (*expand_rgb)           (uint32       *dst,     // opaque pixels, must not alias rgb
+                                 const uint8  *rgb,
+                                 uint          span);
+  void  (*unpremultiply_rgba)   (uint8        *rgba,    // may alias src
+                                 const uint32 *src,
+                                 uint          span);
+  uint  (*find_mismatch)        (const uint32 *pixels1, // returns index of first differing pixel or span
+                                 const uint32 *pixels2,
+                                 uint          span);
 };
 
+/// Kernel sets in ascending order of instruction set requirements.
+enum RenderLevel { RENDER_ALU, RENDER_MMX, RENDER_SSE2, RENDER_SSSE3, RENDER_AVX2, };
+
+const RenderTable&      render_table            ();                                     ///< Kernels for the running CPU.
+bool                    render_table_setup      (RenderTable *table, RenderLevel level); ///< Setup kernels up to @a level if the CPU supports it.
+const char*             render_level_name       (RenderLevel level);
+
 void    render_optimize_mmx     (RenderTable*);
+void    render_optimize_sse2    (RenderTable*);
+void    render_optimize_ssse3   (RenderTable*);
+void    render_optimize_avx2    (RenderTable*);
 
 
 } // Blit
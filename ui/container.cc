@@ -645,13 +645,13 @@ ContainerImpl::change_unviewable (WidgetImpl &child, bool b)
 void
 ContainerImpl::point_children (Point p, std::vector<WidgetImplP> &stack)
 {
-  for (auto childp : *this)
+  for (const WidgetImplP *iter = begin(), *last = end(); iter < last; iter++)
     {
-      WidgetImpl &child = *childp;
+      WidgetImpl &child = **iter;
       Point cp = child_affine (child).point (p);
       if (child.point (cp))
         {
-          stack.push_back (shared_ptr_cast<WidgetImpl> (&child));
+          stack.push_back (*iter);
           ContainerImpl *cc = child.as_container_impl();
           if (cc)
             cc->point_children (cp, stack);
@@ -683,6 +683,26 @@ ContainerImpl::render_recursive (RenderContext &rcontext)
     }
 }
 
+bool
+ContainerImpl::render_concurrently (const Region &region)
+{
+  return WidgetImpl::render_concurrently (region) && render_children_concurrently (region);
+}
+
+/// Check all children that render_recursive() would render for render_concurrently().
+bool
+ContainerImpl::render_children_concurrently (const Region &region)
+{
+  for (auto childp : *this)
+    {
+      WidgetImpl &child = *childp;
+      if (child.drawable() && region.contains (child.clipped_allocation()) != Region::OUTSIDE &&
+          !child.render_concurrently (region))
+        return false;
+    }
+  return true;
+}
+
 void
 ContainerImpl::debug_tree (String indent)
 {
@@ -962,9 +982,106 @@ ResizeContainerImpl::invalidate_parent ()
   SingleContainerImpl::invalidate_parent();
 }
 
-MultiContainerImpl::MultiContainerImpl ()
+/// Uniform grid over the clipped child allocations of a MultiContainerImpl, used to speed up point_children().
+struct MultiContainerImpl::PointGrid {
+  enum { MIN_CHILDREN = 32, MAX_DIM = 256 };
+  bool          dirty, usable;  // usable is false for non-identity child affines
+  Rect          extent;         // union of all non-empty child areas
+  uint          cols, rows;
+  vector<uint>  offsets;        // cols * rows + 1 offsets into indices
+  vector<uint>  indices;        // child indices per cell, in stacking order
+  PointGrid() : dirty (true), usable (false), cols (0), rows (0) {}
+  uint col (double x) const     { return CLAMP (int ((x - extent.x) * cols / extent.width), 0, int (cols) - 1); }
+  uint row (double y) const     { return CLAMP (int ((y - extent.y) * rows / extent.height), 0, int (rows) - 1); }
+};
+
+MultiContainerImpl::MultiContainerImpl () :
+  point_grid_ (NULL)
 {}
 
+void
+MultiContainerImpl::invalidate_point_index ()
+{
+  if (point_grid_)
+    point_grid_->dirty = true;
+}
+
+void
+MultiContainerImpl::update_point_grid ()
+{
+  PointGrid &grid = *point_grid_;
+  grid.dirty = false;
+  grid.usable = false;
+  grid.cols = grid.rows = 0;
+  grid.offsets.clear();
+  grid.indices.clear();
+  const uint n_widgets = widgets.size();
+  vector<Rect> areas (n_widgets);
+  bool have_area = false;
+  for (uint i = 0; i < n_widgets; i++)
+    {
+      WidgetImpl &child = *widgets[i];
+      if (!child_affine (child).is_identity())
+        return; // hit testing needs per child transformations
+      areas[i] = child.clipped_allocation();
+      if (areas[i].width <= 0 || areas[i].height <= 0)
+        continue; // never contains a point
+      if (!have_area)
+        grid.extent = areas[i];
+      else
+        grid.extent.rect_union (areas[i]);
+      have_area = true;
+    }
+  grid.usable = true;
+  if (!have_area)
+    return;
+  grid.cols = grid.rows = CLAMP (uint (sqrt (n_widgets)), 1, uint (PointGrid::MAX_DIM));
+  // count cell entries, then distribute child indices
+  grid.offsets.resize (grid.cols * grid.rows + 1, 0);
+  for (uint i = 0; i < n_widgets; i++)
+    if (areas[i].width > 0 && areas[i].height > 0)
+      for (uint r = grid.row (areas[i].y), r1 = grid.row (areas[i].upper_y()); r <= r1; r++)
+        for (uint c = grid.col (areas[i].x), c1 = grid.col (areas[i].upper_x()); c <= c1; c++)
+          grid.offsets[1 + r * grid.cols + c] += 1;
+  for (uint k = 1; k < grid.offsets.size(); k++)
+    grid.offsets[k] += grid.offsets[k - 1];
+  grid.indices.resize (grid.offsets.back());
+  vector<uint> fill (grid.offsets.begin(), grid.offsets.end() - 1);
+  for (uint i = 0; i < n_widgets; i++)
+    if (areas[i].width > 0 && areas[i].height > 0)
+      for (uint r = grid.row (areas[i].y), r1 = grid.row (areas[i].upper_y()); r <= r1; r++)
+        for (uint c = grid.col (areas[i].x), c1 = grid.col (areas[i].upper_x()); c <= c1; c++)
+          grid.indices[fill[r * grid.cols + c]++] = i;
+}
+
+void
+MultiContainerImpl::point_children (Point p, std::vector<WidgetImplP> &stack)
+{
+  if (widgets.size() < PointGrid::MIN_CHILDREN)
+    return ContainerImpl::point_children (p, stack);
+  if (!point_grid_)
+    point_grid_ = new PointGrid();
+  if (point_grid_->dirty)
+    update_point_grid();
+  const PointGrid &grid = *point_grid_;
+  if (!grid.usable)
+    return ContainerImpl::point_children (p, stack);
+  if (grid.cols == 0 || p.x < grid.extent.x || p.y < grid.extent.y || p.x >= grid.extent.upper_x() || p.y >= grid.extent.upper_y())
+    return;
+  const uint cell = grid.row (p.y) * grid.cols + grid.col (p.x);
+  for (uint k = grid.offsets[cell]; k < grid.offsets[cell + 1]; k++)
+    {
+      const WidgetImplP &childp = widgets[grid.indices[k]];
+      if (childp->point (p)) // identity child affine
+        {
+          stack.push_back (childp);
+          ContainerImpl *cc = childp->as_container_impl();
+          if (cc)
+            cc->point_children (p, stack);
+        }
+    }
+}
+
 WidgetImplP*
 MultiContainerImpl::begin () const
 {
@@ -984,6 +1101,7 @@ void
 MultiContainerImpl::add_child (WidgetImpl &widget)
 {
   widgets.push_back (shared_ptr_cast<WidgetImpl> (&widget));
+  invalidate_point_index();
   ClassDoctor::widget_set_parent (widget, this);
 }
 
@@ -996,6 +1114,7 @@ MultiContainerImpl::remove_child (WidgetImpl &widget)
       {
         const WidgetImplP guard_widget = *it;
         widgets.erase (it);
+        invalidate_point_index();
         ClassDoctor::widget_set_parent (widget, NULL);
         return;
       }
@@ -1013,6 +1132,7 @@ MultiContainerImpl::raise_child (WidgetImpl &widget)
             std::shared_ptr<WidgetImpl> widgetp = widgets[i];
             widgets.erase (widgets.begin() + i);
             widgets.push_back (widgetp);
+            invalidate_point_index();
             invalidate();
           }
         break;
@@ -1030,6 +1150,7 @@ MultiContainerImpl::lower_child (WidgetImpl &widget)
             std::shared_ptr<WidgetImpl> widgetp = widgets[i];
             widgets.erase (widgets.begin() + i);
             widgets.insert (widgets.begin(), widgetp);
+            invalidate_point_index();
             invalidate();
           }
         break;
@@ -1046,6 +1167,8 @@ MultiContainerImpl::remove_all_children ()
 MultiContainerImpl::~MultiContainerImpl()
 {
   remove_all_children();
+  delete point_grid_;
+  point_grid_ = NULL;
 }
 
 } // Rapicorn
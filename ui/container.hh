@@ -41,6 +41,7 @@ protected:
   void                expose_enclosure  (); /* expose without children */
   void                change_unviewable (WidgetImpl &child, bool);
   virtual void        focus_lost        ()                              { set_focus_child (NULL); }
+  virtual void        invalidate_point_index ()                         {} ///< Called when a child allocation or child_affine() changed.
   virtual void        set_focus_child   (WidgetImpl *widget);
   virtual void        scroll_to_child   (WidgetImpl &widget);
   virtual void        dump_test_data    (TestStream &tstream);
@@ -62,13 +63,15 @@ public:
   bool                  remove          (WidgetImpl           *widget)  { assert_return (widget != NULL, 0); return remove (*widget); }
   void                  add             (WidgetImpl                   &widget);
   void                  add             (WidgetImpl                   *widget);
-  virtual Affine        child_affine    (const WidgetImpl             &widget); /* container => widget affine */
+  virtual Affine        child_affine    (const WidgetImpl             &widget); /* container => widget affine, changes need invalidate_point_index() */
   virtual void          point_children  (Point                   p, /* widget coordinates relative */
                                          std::vector<WidgetImplP>     &stack);
   void    display_window_point_children (Point                   p, /* display_window coordinates relative */
                                          std::vector<WidgetImplP>     &stack);
   virtual ContainerImpl* as_container_impl ()                           { return this; }
   virtual void          render_recursive(RenderContext &rcontext);
+  virtual bool          render_concurrently (const Region &region) override;
+  bool                  render_children_concurrently (const Region &region);
   void                  debug_tree      (String indent = String());
   // ContainerIface
   virtual WidgetIfaceP create_widget    (const String &widget_identifier, const StringSeq &args) override;
@@ -123,9 +126,13 @@ public:
 
 // == Multi Child Container ==
 class MultiContainerImpl : public virtual ContainerImpl {
+  struct PointGrid;
   std::vector<WidgetImplP> widgets;
+  PointGrid               *point_grid_;
+  void                  update_point_grid       ();
 protected:
   virtual              ~MultiContainerImpl      ();
+  virtual void          invalidate_point_index  () override;
   virtual void          render                  (RenderContext&, const Rect&) {}
   virtual WidgetImplP*  begin                   () const override;
   virtual WidgetImplP*  end                     () const override;
@@ -137,6 +144,8 @@ protected:
   void                  lower_child             (WidgetImpl   &widget);
   void                  remove_all_children     ();
   explicit              MultiContainerImpl      ();
+public:
+  virtual void          point_children          (Point p, std::vector<WidgetImplP> &stack) override;
 };
 
 } // Rapicorn
@@ -1,6 +1,5 @@
 // This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
 #include "displaywindow.hh"
-#include <list>
 #include <algorithm>
 
 #define SDEBUG(...)     RAPICORN_KEY_DEBUG ("DisplayDriver", __VA_ARGS__)
@@ -14,7 +13,7 @@ DisplayWindow::DisplayWindow () :
 
 DisplayWindow::~DisplayWindow ()
 {
-  std::list<Event*> events;
+  std::deque<Event*> events;
   {
     ScopedLock<Spinlock> sl (async_spin_);
     events.swap (async_event_queue_);
@@ -32,11 +31,26 @@ void
 DisplayWindow::enqueue_event (Event *event)
 {
   critical_unless (event);
-  ScopedLock<Spinlock> sl (async_spin_);
-  const bool notify = async_event_queue_.empty();
-  async_event_queue_.push_back (event);
-  if (notify && async_wakeup_)
-    async_wakeup_();
+  Event *stale = NULL;
+  {
+    ScopedLock<Spinlock> sl (async_spin_);
+    const bool notify = async_event_queue_.empty();
+    if (event->type == MOUSE_MOVE && !notify)
+      {
+        // coalesce consecutive motion, only the latest pointer position matters
+        Event *last = async_event_queue_.back();
+        if (last->type == MOUSE_MOVE && last->modifiers == event->modifiers && last->synthesized == event->synthesized)
+          {
+            stale = last;
+            async_event_queue_.back() = event;
+          }
+      }
+    if (!stale)
+      async_event_queue_.push_back (event);
+    if (notify && async_wakeup_)
+      async_wakeup_();
+  }
+  delete stale;
 }
 
 void
@@ -4,6 +4,7 @@
 
 #include <ui/events.hh>
 #include <ui/region.hh>
+#include <deque>
 
 namespace Rapicorn {
 class DisplayDriver;
@@ -94,14 +95,14 @@ protected:
   explicit               DisplayWindow          ();
   virtual               ~DisplayWindow          ();
   virtual DisplayDriver& display_driver_async   () const = 0;                   ///< Acces DisplayDriver, called from any thread.
-  void                   enqueue_event          (Event *event);                 ///< Add an event to the back of the event queue.
+  void                   enqueue_event          (Event *event);                 ///< Add an event to the back of the event queue, merges motion.
   bool                   update_state           (const State &state);           ///< Updates the state returned from get_state().
   void                   queue_command          (DisplayCommand *command);      ///< Helper to queue commands on DisplayDriver.
 private:
   State                 async_state_;
   bool                  async_state_accessed_;
   Spinlock              async_spin_;
-  std::list<Event*>     async_event_queue_;
+  std::deque<Event*>    async_event_queue_;
   std::function<void()> async_wakeup_;
 };
 
@@ -4,6 +4,7 @@
 #include "../configure.h"
 
 #include <stdlib.h>
+#include <unordered_map>
 
 namespace Rapicorn {
 
@@ -155,11 +156,32 @@ Evaluator::populate_map (VariableMap        &vmap,
     vmap[variable_names[i]] = variable_values[i];
 }
 
+// Compiled expressions are immutable, so templates evaluating the same source text share them
+static SinfexP
+cached_sinfex (const String &expression)
+{
+  enum { MAX_CACHED_EXPRESSIONS = 1024 };
+  static Mutex mutex;
+  static std::unordered_map<String,SinfexP> cache;
+  {
+    ScopedLock<Mutex> locker (mutex);
+    auto it = cache.find (expression);
+    if (it != cache.end())
+      return it->second;
+  }
+  SinfexP sinfex = Sinfex::parse_string (expression);
+  ScopedLock<Mutex> locker (mutex);
+  if (cache.size() >= MAX_CACHED_EXPRESSIONS)
+    cache.clear();
+  cache[expression] = sinfex;
+  return sinfex;
+}
+
 String
 Evaluator::parse_eval (const String &expression)
 {
   VariableMapListScope scope (env_maps);
-  SinfexP sinfex = Sinfex::parse_string (expression);
+  SinfexP sinfex = cached_sinfex (expression);
   Sinfex::Value value = sinfex->eval (scope);
   return value.string();
 }
@@ -16,6 +16,11 @@ Event::~Event()
 {}
 
 class EventImpl : public Event {
+  // recycle memory of the most frequent events, these are created and deleted from different threads
+  enum { FREELIST_MAX = 64 };
+  static Spinlock       freelist_spin;
+  static void          *freelist[FREELIST_MAX];
+  static uint           freelist_size;
 public:
   explicit EventImpl (EventType           etype,
                       const EventContext &econtext) :
@@ -26,7 +31,33 @@ public:
             (etype >= SCROLL_UP   && etype <= SCROLL_RIGHT) ||
             etype == CANCEL_EVENTS || etype == WIN_DELETE || etype == WIN_DESTROY);
   }
+  static void*
+  operator new (size_t size)
+  {
+    assert (size == sizeof (EventImpl));
+    void *mem = NULL;
+    freelist_spin.lock();
+    if (freelist_size)
+      mem = freelist[--freelist_size];
+    freelist_spin.unlock();
+    return mem ? mem : ::operator new (size);
+  }
+  static void
+  operator delete (void *mem)
+  {
+    return_unless (mem != NULL);
+    freelist_spin.lock();
+    const bool recycle = freelist_size < FREELIST_MAX;
+    if (recycle)
+      freelist[freelist_size++] = mem;
+    freelist_spin.unlock();
+    if (!recycle)
+      ::operator delete (mem);
+  }
 };
+Spinlock EventImpl::freelist_spin;
+void*    EventImpl::freelist[FREELIST_MAX] = { NULL, };
+uint     EventImpl::freelist_size = 0;
 
 const char*
 string_from_content_source_type (ContentSourceType ctype)
@@ -14,6 +14,8 @@ namespace Rapicorn {
 namespace Factory {
 
 // == Utilities ==
+static const XmlAtom id_atom = XmlNode::atom ("id");   // attribute lookups compare atoms
+
 static String
 node_location (const XmlNode *xnode)
 {
@@ -57,7 +59,7 @@ register_interface_file (String file_name, const XmlNodeP root, const ArgumentLi
   for (auto dnode : root->children())
     if (dnode->istext() == false)
       {
-        const String id = dnode->get_attribute ("id");
+        const String id = dnode->get_attribute (id_atom);
         if (id.empty())
           {
             if (definitions)
@@ -78,7 +80,7 @@ lookup_interface_node (const String &identifier, InterfaceFileP *ifacepp, const
   for (auto ifile : interface_file_list)
     for (auto node : ifile->root->children())
       {
-        const String id = node->get_attribute ("id");
+        const String id = node->get_attribute (id_atom);
         if (id == identifier)
           {
             if (ifacepp)
@@ -169,7 +171,7 @@ factory_context_name (FactoryContext &fc)
 {
   const XmlNode &xnode = *fc.xnode;
   if (check_interface_node (xnode))
-    return xnode.get_attribute ("id");
+    return xnode.get_attribute (id_atom);
   else
     return xnode.name();
 }
@@ -184,7 +186,7 @@ factory_context_type (FactoryContext &fc)
       assert_return (xnode != NULL, "");
     }
   assert_return (check_interface_node (*xnode), "");
-  return xnode->get_attribute ("id");
+  return xnode->get_attribute (id_atom);
 }
 
 UserSource
@@ -213,13 +215,14 @@ factory_context_list_types (StringVector &types, const XmlNode *xnode, const boo
     {
       assert_return (check_interface_node (*xnode));
       if (need_ids)
-        types.push_back (xnode->get_attribute ("id"));
+        types.push_back (xnode->get_attribute (id_atom));
       const String parent_name = xnode->name();
       const XmlNode *last = xnode;
       xnode = lookup_interface_node (parent_name, NULL, xnode);
       if (!xnode && last->name() == "Rapicorn_Factory")
         {
-          const StringVector &attributes_names = last->list_attributes(), &attributes_values = last->list_values();
+          const XmlNode::AttributeNames attributes_names = last->list_attributes();
+          const StringVector &attributes_values = last->list_values();
           const ObjectTypeFactory *widget_factory = NULL;
           for (size_t i = 0; i < attributes_names.size(); i++)
             if (attributes_names[i] == "factory-type" || attributes_names[i] == "factory_type")
@@ -560,7 +563,7 @@ Builder::build_widget (const XmlNode *const wnode, Evaluator &env, const XmlNode
   const bool skip_argument_child = bflags & SCOPE_WIDGET;
   const bool filter_child_container = bflags & SCOPE_WIDGET;
   // collect properties from XML attributes
-  StringVector prop_names = wnode->list_attributes(), prop_values = wnode->list_values();
+  StringVector prop_names = wnode->list_attributes(), prop_values = wnode->list_values(); // copies, extended below
   // collect properties from XML property element syntax
   const size_t chsize = std::max (size_t (1), wnode->children().size());
   bool skip_child[chsize];
@@ -685,7 +688,8 @@ Builder::widget_has_ancestor (const String &widget_identifier, const String &anc
     return false; // no node match possible
   if (last && last->name() == "Rapicorn_Factory")
     {
-      const StringVector &attributes_names = last->list_attributes(), &attributes_values = last->list_values();
+      const XmlNode::AttributeNames attributes_names = last->list_attributes();
+      const StringVector &attributes_values = last->list_values();
       const ObjectTypeFactory *widget_factory = NULL;
       for (size_t i = 0; i < attributes_names.size(); i++)
         if (attributes_names[i] == "factory-type" || attributes_names[i] == "factory_type")
@@ -746,6 +750,16 @@ static String
 parse_ui_data_internal (const String &data_name, size_t data_length, const char *data, const String &i18n_domain,
                         const ArgumentList *arguments, StringVector *definitions)
 {
+  if (XmlNode::is_bundle (data, data_length)) // precompiled by rapiduib, no markup parsing needed
+    {
+      String errstr;
+      XmlNodeP xnode = XmlNode::load_bundle (data, data_length, &errstr);
+      if (!xnode)
+        return string_format ("%s: %s", data_name, errstr);
+      if (xnode->name() != "interfaces")
+        return string_format ("%s: bundle lacks toplevel <interfaces/> element", data_name);
+      return register_interface_file (data_name, xnode, arguments, definitions);
+    }
   String pseudoroot; // automatically wrap definitions into root tag <interfaces/>
   const size_t estart = MarkupParser::seek_to_element (data, data_length);
   if (estart + 11 < data_length && strncmp (data + estart, "<interfaces", 11) != 0 && data[estart + 1] != '?')
@@ -772,6 +786,15 @@ parse_ui_data (const String &data_name, size_t data_length, const char *data, co
 
 } // Factory
 
+static void
+load_builtin_definitions (const String &basename)
+{
+  Blob blob = Res ("@res " + basename + ".uib"); // embedded bundle from zuib.cc
+  if (!blob)
+    blob = Res ("@res " + basename + ".xml");
+  Factory::parse_ui_data_internal (basename + ".xml", blob.size(), blob.data(), "", NULL, NULL);
+}
+
 static void
 initialize_factory_lazily (void)
 {
@@ -779,11 +802,9 @@ initialize_factory_lazily (void)
   if (!initialized)
     {
       initialized++;
-      Blob blob = Res ("@res Rapicorn/foundation.xml");
-      Factory::parse_ui_data_internal ("Rapicorn/foundation.xml", blob.size(), blob.data(), "", NULL, NULL);
-      blob = Res ("@res Rapicorn/standard.xml");
-      Factory::parse_ui_data_internal ("Rapicorn/standard.xml", blob.size(), blob.data(), "", NULL, NULL);
-      blob = Res ("@res themes/Default.xml");
+      load_builtin_definitions ("Rapicorn/foundation");
+      load_builtin_definitions ("Rapicorn/standard");
+      Blob blob = Res ("@res themes/Default.xml");
       ThemeInfoP default_theme = ThemeInfo::load_theme ("Default");
       assert (default_theme != NULL);
       ThemeInfoP theme = ThemeInfo::load_theme ("$RAPICORN_THEME", true);
@@ -791,3 +812,6 @@ initialize_factory_lazily (void)
 }
 
 } // Rapicorn
+
+// rapicorn/res/ UI bundles
+#include "zuib.cc"
@@ -8,7 +8,9 @@ namespace Rapicorn {
 AlignmentImpl::AlignmentImpl() :
   left_padding_ (0), right_padding_ (0),
   bottom_padding_ (0), top_padding_ (0)
-{}
+{
+  set_flag (CONCURRENT_RENDER); // only positions its child, which render_concurrently() checks
+}
 
 AlignmentImpl::~AlignmentImpl ()
 {}
@@ -21,7 +21,9 @@ AmbienceImpl::AmbienceImpl() :
   hover_shade_ (Lighting::UPPER_LEFT),
   active_shade_ (Lighting::LOWER_RIGHT),
   insensitive_shade_ (Lighting::CENTER)
-{}
+{
+  set_flag (RENDER_LAYER); // keep gradients and children across exposes of neighbouring widgets
+}
 
 AmbienceImpl::~AmbienceImpl()
 {}
@@ -326,7 +328,9 @@ FrameImpl::FrameImpl() :
   normal_frame_ (DrawFrame::ETCHED_IN),
   active_frame_ (DrawFrame::ETCHED_IN),
   overlap_child_ (false), tight_focus_ (false)
-{}
+{
+  set_flag (RENDER_LAYER); // property setters and expose_enclosure() damage the layer
+}
 
 FrameImpl::~FrameImpl()
 {}
@@ -630,7 +634,9 @@ static const WidgetFactory<FocusFrameImpl> focus_frame_factory ("Rapicorn::Focus
 
 // == LayerPainterImpl ==
 LayerPainterImpl::LayerPainterImpl()
-{}
+{
+  set_flag (CONCURRENT_RENDER); // layers are painted by the children
+}
 
 LayerPainterImpl::~LayerPainterImpl()
 {}
@@ -676,7 +682,9 @@ static const WidgetFactory<LayerPainterImpl> layer_painter_factory ("Rapicorn::L
 // == ElementPainter ==
 ElementPainterImpl::ElementPainterImpl() :
   cached_painter_ ("")
-{}
+{
+  set_flag (RENDER_LAYER); // retain rendered SVG elements and children across neighbouring exposes
+}
 
 ElementPainterImpl::~ElementPainterImpl()
 {}
@@ -14,7 +14,9 @@ namespace Rapicorn {
 // == ArrowImpl ==
 ArrowImpl::ArrowImpl() :
   dir_ (Direction::RIGHT)
-{}
+{
+  set_flag (CONCURRENT_RENDER);
+}
 
 ArrowImpl::~ArrowImpl()
 {}
@@ -92,7 +94,9 @@ DotGridImpl::DotGridImpl() :
   n_hdots_ (1), n_vdots_ (1),
   right_padding_dots_ (0), top_padding_dots_ (0),
   left_padding_dots_ (0), bottom_padding_dots_ (0)
-{}
+{
+  set_flag (CONCURRENT_RENDER);
+}
 
 DotGridImpl::~DotGridImpl()
 {}
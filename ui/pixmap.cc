@@ -2,6 +2,7 @@
 #define __RAPICORN_IDL_ALIASES__ 0      // provide no ClnT or SrvT aliases
 #include "serverapi.hh" // to instantiate template class PixmapT<Rapicorn::SrvT_Pixbuf>;
 #include "clientapi.hh" // to instantiate template class PixmapT<Rapicorn::ClnT_Pixbuf>;
+#include "blitfuncs.hh"
 #include <errno.h>
 #include <math.h>
 #include <cstring>
@@ -140,21 +141,22 @@ PixmapT<Pixbuf>::compare (const Pixbuf &source,
   const uint npix = sheight * swidth;
   uint nerr = 0;
   double erraccu = 0, errmax = 0;
+  const Blit::RenderTable &rtable = Blit::render_table();
   for (int k = 0; k < sheight; k++)
     {
       const uint32 *r1 = pixbuf_->row (ty + k);
       const uint32 *r2 = source.row (sy + k);
-      for (int j = 0; j < swidth; j++)
-        if (r1[tx + j] != r2[sx + j])
-          {
-            const double scale = 1.0 / 510.0; // 510 == 255 * sqrt (4)
-            const uint8 *p1 = (uint8*) &r1[tx + j], *p2 = (uint8*) &r2[sx + j];
-            double pixerr = sqrt (SQR (p1[0] - p2[0]) + SQR (p1[1] - p2[1]) +
-                                  SQR (p1[2] - p2[2]) + SQR (p1[3] - p2[3])) * scale;
-            errmax = MAX (errmax, pixerr);
-            erraccu += pixerr;
-            nerr++;
-          }
+      for (int j = rtable.find_mismatch (r1 + tx, r2 + sx, swidth); j < swidth;
+           j += 1 + rtable.find_mismatch (r1 + tx + j + 1, r2 + sx + j + 1, swidth - j - 1))
+        {
+          const double scale = 1.0 / 510.0; // 510 == 255 * sqrt (4)
+          const uint8 *p1 = (uint8*) &r1[tx + j], *p2 = (uint8*) &r2[sx + j];
+          double pixerr = sqrt (SQR (p1[0] - p2[0]) + SQR (p1[1] - p2[1]) +
+                                SQR (p1[2] - p2[2]) + SQR (p1[3] - p2[3])) * scale;
+          errmax = MAX (errmax, pixerr);
+          erraccu += pixerr;
+          nerr++;
+        }
     }
   if (averrp)
     *averrp = erraccu / npix;
@@ -253,17 +255,15 @@ pixmap_border (PixmapT<Pixbuf> pixmap, uint32 pixel)
     }
 }
 
-static inline uint8 IMUL (uint8 v, uint8 alpha) { return (v * alpha * 0x0101 + 0x8080) >> 16; }
-
-static inline uint32
-premultiply (uint32 pixel)
+// convert a span of RGB or RGBA pixstream bytes into premultiplied ARGB pixels
+static inline void
+pixstream_convert (uint32 *dst, const uint8 *bytes, uint bpp, uint span)
 {
-  const uint8 alpha = pixel >> 24;
-  uint32 p = alpha << 24;
-  p |= IMUL (0xff & (pixel >> 16), alpha) << 16;     // red
-  p |= IMUL (0xff & (pixel >> 8),  alpha) << 8;      // green
-  p |= IMUL (0xff & pixel,         alpha);           // blue
-  return p;
+  const Blit::RenderTable &rtable = Blit::render_table();
+  if (bpp < 4)
+    rtable.expand_rgb (dst, bytes, span);
+  else
+    rtable.premultiply_rgba (dst, bytes, span);
 }
 
 template<class Pixbuf> static int /* errno */
@@ -294,12 +294,10 @@ fill_pixmap_from_pixstream (PixmapT<Pixbuf> pixmap, bool has_alpha, bool rle_enc
               check_overrun = image_buffer + length > image_limit;
               if (check_overrun)
                 length = image_limit - image_buffer;
-              if (bpp < 4)
-                while (length--)
-                  *image_buffer++ = premultiply ((0xff << 24) | (rle_buffer[0] << 16) | (rle_buffer[1] << 8) | rle_buffer[2]);
-              else
-                while (length--)
-                  *image_buffer++ = premultiply ((rle_buffer[3] << 24) | (rle_buffer[0] << 16) | (rle_buffer[1] << 8) | rle_buffer[2]);
+              uint32 pixel;
+              pixstream_convert (&pixel, rle_buffer, bpp, 1);
+              Blit::render_table().fill (image_buffer, pixel, length);
+              image_buffer += length;
               rle_buffer += bpp;
             }
           else
@@ -307,18 +305,9 @@ fill_pixmap_from_pixstream (PixmapT<Pixbuf> pixmap, bool has_alpha, bool rle_enc
               check_overrun = image_buffer + length > image_limit;
               if (check_overrun)
                 length = image_limit - image_buffer;
-              if (bpp < 4)
-                while (length--)
-                  {
-                    *image_buffer++ = premultiply ((0xff << 24) | (rle_buffer[0] << 16) | (rle_buffer[1] << 8) | rle_buffer[2]);
-                    rle_buffer += 3;
-                  }
-              else
-                while (length--)
-                  {
-                    *image_buffer++ = premultiply ((rle_buffer[3] << 24) | (rle_buffer[0] << 16) | (rle_buffer[1] << 8) | rle_buffer[2]);
-                    rle_buffer += 4;
-                  }
+              pixstream_convert (image_buffer, rle_buffer, bpp, length);
+              image_buffer += length;
+              rle_buffer += bpp * length;
             }
           if (check_overrun)
             return EINVAL;
@@ -327,20 +316,8 @@ fill_pixmap_from_pixstream (PixmapT<Pixbuf> pixmap, bool has_alpha, bool rle_enc
   else
     for (uint y = 0; y < pixdata_height; y++)
       {
-        uint32 *row = pixmap.row (y);
-        uint length = pixdata_width;
-        if (bpp < 4)
-          while (length--)
-            {
-              *row++ = premultiply ((0xff << 24) | (encoded_pixdata[0] << 16) | (encoded_pixdata[1] << 8) | encoded_pixdata[2]);
-              encoded_pixdata += 3;
-            }
-        else
-          while (length--)
-            {
-              *row++ = premultiply ((encoded_pixdata[3] << 24) | (encoded_pixdata[0] << 16) | (encoded_pixdata[1] << 8) | encoded_pixdata[2]);
-              encoded_pixdata += 4;
-            }
+        pixstream_convert (pixmap.row (y), encoded_pixdata, bpp, pixdata_width);
+        encoded_pixdata += bpp * pixdata_width;
       }
 
   return 0;
@@ -406,36 +383,15 @@ namespace {
 static void
 rgba_2_argb_pre (png_structp png, png_row_infop row_info, png_bytep data)
 {
-  for (uint i = 0; i < row_info->rowbytes; i += 4)
-    {
-      const uint8 alpha = data[i + 3];          // RGBA bytes
-      uint32 p = alpha << 24;
-      p |= IMUL (data[i + 0], alpha) << 16;     // red
-      p |= IMUL (data[i + 1], alpha) << 8;      // green
-      p |= IMUL (data[i + 2], alpha);           // blue
-      *(uint32*) &data[i] = p;                  // store ARGB in native endianess
-    }
+  // RGBA bytes to ARGB in native endianess, converted in place
+  Blit::render_table().premultiply_rgba ((uint32*) data, data, row_info->rowbytes / 4);
 }
 
-static inline uint8 IDIV (uint8 v, uint8 alpha) { return (0xff * v + (alpha >> 1)) / alpha; }
-
 static void
 argb_pre_2_rgba (png_structp png, png_row_infop row_info, png_bytep data)
 {
-  for (uint i = 0; i < row_info->rowbytes; i += 4)
-    {
-      const uint32 p = *(uint32*) &data[i];     // ARGB in native endianess
-      const uint8 alpha = p >> 24;
-      data[i + 3] = alpha;                      // store RGBA bytes
-      if (alpha == 0)
-        data[i + 0] = data[i + 1] = data[i + 2] = 0;
-      else
-        {
-          data[i + 0] = IDIV (p >> 16, alpha);  // red
-          data[i + 1] = IDIV (p >> 8, alpha);   // green
-          data[i + 2] = IDIV (p, alpha);        // blue
-        }
-    }
+  // ARGB in native endianess to RGBA bytes, converted in place
+  Blit::render_table().unpremultiply_rgba (data, (const uint32*) data, row_info->rowbytes / 4);
 }
 
 template<class Pixbuf>
@@ -166,6 +166,17 @@ Region::count_rects () const
   return _rapicorn_region_get_rect_count (REGION (this));
 }
 
+double
+Region::area () const
+{
+  std::vector<Rect> rects;
+  list_rects (rects);
+  double sum = 0;
+  for (const Rect &r : rects)
+    sum += r.area();
+  return sum;
+}
+
 void
 Region::add (const Rect &rect)
 {
@@ -200,11 +211,7 @@ Region::exor (const Region &other)
 void
 Region::translate (double deltax, double deltay)
 {
-  std::vector<Rect> rects;
-  list_rects (rects);
-  clear();
-  for (uint i = 0; i < rects.size(); i++)
-    add (Rect (rects[i].x + deltax, rects[i].y + deltay, rects[i].width, rects[i].height));
+  _rapicorn_region_translate (REGION (this), double2fixed (deltax), double2fixed (deltay));
 }
 
 void
@@ -227,6 +234,57 @@ Region::affine (const Affine &aff)
     }
 }
 
+/** Reduce the number of rectangles by growing some into their bounding boxes.
+ * Rectangles are merged as long as the area not covered by the original Region
+ * stays below the @a max_waste fraction (0..1) of a merged bounding box.
+ * If more than @a max_rects rectangles remain, the Region is replaced by its extents().
+ * Returns the area added to the Region (i.e. over-draw when used for exposes).
+ */
+double
+Region::coalesce (double max_waste, uint max_rects)
+{
+  std::vector<Rect> rects;
+  list_rects (rects);
+  if (rects.size() < 2)
+    return 0;
+  struct Group { Rect box; double covered; };
+  std::vector<Group> groups;
+  double old_area = 0;
+  for (const Rect &r : rects) // rectangles are disjoint and y-x banded, so recent groups are closest
+    {
+      const double rarea = r.area();
+      old_area += rarea;
+      bool merged = false;
+      for (ssize_t i = groups.size() - 1; i >= 0 && !merged; i--)
+        {
+          Rect box = groups[i].box;
+          box.rect_union (r);
+          const double covered = groups[i].covered + rarea;
+          if (box.area() - covered <= max_waste * box.area())
+            {
+              groups[i].box = box;
+              groups[i].covered = covered;
+              merged = true;
+            }
+        }
+      if (!merged)
+        groups.push_back (Group { r, rarea });
+    }
+  if (groups.size() < rects.size())
+    {
+      clear();
+      for (const Group &g : groups)
+        add (g.box);
+    }
+  if (count_rects() > max_rects)
+    {
+      const Rect ext = extents();
+      clear();
+      add (ext);
+    }
+  return area() - old_area;
+}
+
 bool
 operator== (const Region &r1,
             const Region &r2)
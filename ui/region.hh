@@ -16,10 +16,12 @@ namespace Rapicorn {
  * so only a small number of fractional digits are supported (2 decimals,
  * fractions are represented by 8 bit), and rectangle sizes are also limited
  * (rectangle dimensions shouldn't exceed 3.6e16, i.e. 2^55).
+ * Small regions store their rectangles inline, larger rectangle lists are
+ * shared between copies until one of them is modified.
  */
 class Region {
   union {
-    struct CRegion { int64 idummy[4]; void *pdummy; };
+    struct CRegion { int64 idummy[4]; void *pdummy; long ldummy[3]; int64 rdummy[8 * 4]; }; // 8 inline rectangles
     CRegion          cstruct_mem;               // ensure C structure size and alignment
     char             chars[sizeof (CRegion)];   // char may_alias any type
   }                  region_;                  // RAPICORN_MAY_ALIAS; ICE: GCC#30894
@@ -45,6 +47,7 @@ public: /* rectangles are represented at 64bit integer precision */
   ContainedType contains          (const Region &other) const;  ///< Returns if Region covers @a other fully, partially or not at all.
   void          list_rects        (vector<Rect> &rects) const;  ///< Provides a list of rectangles that define Region.
   uint          count_rects       () const;                     ///< Provides the number of rectangles that cover Region.
+  double        area              () const;                     ///< Provides the area covered by Region.
   void          add               (const Rect   &rect);         ///< Adds a rectangle to the Region.
   void          add               (const Region &other);        ///< Causes Region to contain the union with @a other.
   void          subtract          (const Region &subtrahend);   ///< Removes @a subtrahend from Region.
@@ -52,6 +55,7 @@ public: /* rectangles are represented at 64bit integer precision */
   void          exor              (const Region &other);        ///< Causes Region to contain the XOR composition with @a other.
   void          translate         (double dx, double dy);       ///< Shifts Region by @a dx, @a dy.
   void          affine            (const Affine &affine);       ///< Transforms Region by @a affine.
+  double        coalesce          (double max_waste, uint max_rects); ///< Merges rectangles with little waste, returns area added.
   double        epsilon           () const;                     ///< Returns the precision (granularity) between fractional digits.
   String        string            ();                           ///< Describes Region in a string.
   /*dtor*/     ~Region            ();                           ///< Public destructor, Region is a simple copyable structure.
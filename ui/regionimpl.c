@@ -118,11 +118,16 @@ typedef RapicornRegionBox      *BoxPtr;
 typedef struct _RegData {
   long        size;
   long        numRects;
+  long        refs;     /* regions sharing this data, copy-on-write if > 1, updated atomically */
   /*  BoxRec      rects[size];   in memory but not explicitly declared */
 } RegDataRec, *RegDataPtr;
 struct _RapicornRegion {
   BoxRec      extents;
   RegDataPtr  data;
+  struct {
+    RegDataRec  header;
+    BoxRec      rects[RAPICORN_REGION_INLINE_RECTS];
+  }           local;    /* small regions keep their rectangles inline */
 };
 #define REGION_NIL(reg) ((reg)->data && !(reg)->data->numRects)
 /* not a region */
@@ -136,6 +141,14 @@ struct _RapicornRegion {
 #define REGION_TOP(reg) REGION_BOX(reg, (reg)->data->numRects)
 #define REGION_END(reg) REGION_BOX(reg, (reg)->data->numRects - 1)
 #define REGION_SZOF(n) (sizeof(RegDataRec) + ((n) * sizeof(BoxRec)))
+#define REGION_LOCAL(reg) (&(reg)->local.header)
+#define REGION_IS_LOCAL(reg) ((reg)->data == REGION_LOCAL(reg))
+/* Regions sharing rectangles may be used by different threads. Other sharers drop their reference only
+ * after they are done reading, the acquire load orders those reads before in-place writes. New sharers
+ * are added by copying a Region, which must not race with writes to that same Region, so refs == 1
+ * cannot grow while the region is being modified.
+ */
+#define REGION_SHARED(reg) ((reg)->data && __atomic_load_n (&(reg)->data->refs, __ATOMIC_ACQUIRE) > 1)
 
 #define ErrorF(...) fprintf (stderr, __VA_ARGS__)
 #define good(reg) do { if (!miValidRegion(reg)) { ErrorF ("InvalidRegion: %p:\n", reg); miPrintRegion (reg); } assert(miValidRegion(reg)); } while (0)
@@ -208,8 +221,37 @@ struct _RapicornRegion {
         ((r1)->y1 <= (r2)->y1) && \
         ((r1)->y2 >= (r2)->y2) )
 
-#define xallocData(n) (RegDataPtr)xalloc(REGION_SZOF(n))
-#define xfreeData(reg) if ((reg)->data && (reg)->data->size) xfree((reg)->data)
+#define xfreeData(reg) miReleaseData(reg, (reg)->data)
+
+static inline RegDataPtr
+xallocData (long n)
+{
+  RegDataPtr data = (RegDataPtr) xalloc (REGION_SZOF (n));
+  if (data)
+    data->refs = 1;
+  return data;
+}
+
+/* allocate rectangle storage, using the inline rectangles if possible and unused */
+static inline RegDataPtr
+miAllocData (RegionPtr reg, long n)
+{
+  if (n <= RAPICORN_REGION_INLINE_RECTS && !REGION_IS_LOCAL (reg))
+    {
+      RegDataPtr data = REGION_LOCAL (reg);
+      data->refs = 1;
+      return data;
+    }
+  return xallocData (n);
+}
+
+/* drop a reference to rectangle storage, static and inline storage is never freed */
+static inline void
+miReleaseData (RegionPtr reg, RegDataPtr data)
+{
+  if (data && data->size && data != REGION_LOCAL (reg) && __sync_sub_and_fetch (&data->refs, 1) == 0)
+    xfree (data);
+}
 
 #define RECTALLOC_BAIL(pReg,n,bail) \
 if (!(pReg)->data || (((pReg)->data->numRects + (n)) > (pReg)->data->size)) \
@@ -256,9 +298,9 @@ if (((numRects) < ((reg)->data->size >> 1)) && ((reg)->data->size > 50)) \
 
 
 _X_EXPORT BoxRec miEmptyBox = {0, 0, 0, 0};
-_X_EXPORT RegDataRec miEmptyData = {0, 0};
+_X_EXPORT RegDataRec miEmptyData = {0, 0, 0};
 
-static RegDataRec  miBrokenData = {0, 0};
+static RegDataRec  miBrokenData = {0, 0, 0};
 static RegionRec   miBrokenRegion = { { 0, 0, 0, 0 }, &miBrokenData };
 
 static int
@@ -458,7 +500,7 @@ miRectAlloc(
   if (!pRgn->data)
     {
       n++;
-      pRgn->data = xallocData(n);
+      pRgn->data = miAllocData(pRgn, n);
       if (!pRgn->data)
         return miRegionBreak (pRgn);
       pRgn->data->numRects = 1;
@@ -466,7 +508,7 @@ miRectAlloc(
     }
   else if (!pRgn->data->size)
     {
-      pRgn->data = xallocData(n);
+      pRgn->data = miAllocData(pRgn, n);
       if (!pRgn->data)
         return miRegionBreak (pRgn);
       pRgn->data->numRects = 0;
@@ -480,12 +522,25 @@ miRectAlloc(
             n = 250;
         }
       n += pRgn->data->numRects;
-      data = (RegDataPtr)xrealloc(pRgn->data, REGION_SZOF(n));
-      if (!data)
-        return miRegionBreak (pRgn);
+      if (REGION_IS_LOCAL (pRgn) || REGION_SHARED (pRgn))
+        {
+          /* inline or shared rectangles are moved into private storage */
+          data = xallocData(n);
+          if (!data)
+            return miRegionBreak (pRgn);
+          data->numRects = pRgn->data->numRects;
+          memcpy (data + 1, REGION_BOXPTR (pRgn), data->numRects * sizeof (BoxRec));
+          xfreeData (pRgn);
+        }
+      else
+        {
+          data = (RegDataPtr)xrealloc(pRgn->data, REGION_SZOF(n));
+          if (!data)
+            return miRegionBreak (pRgn);
+        }
       pRgn->data = data;
     }
-  pRgn->data->size = n;
+  pRgn->data->size = REGION_IS_LOCAL (pRgn) ? RAPICORN_REGION_INLINE_RECTS : n;
   return TRUE;
 }
 
@@ -505,14 +560,22 @@ miRegionCopy(dst, src)
       dst->data = src->data;
       return TRUE;
     }
-  if (!dst->data || (dst->data->size < src->data->numRects))
+  if (!REGION_IS_LOCAL (src))
     {
+      /* share heap allocated rectangles, miRectAlloc copies before writes */
+      __sync_add_and_fetch (&src->data->refs, 1);
       xfreeData(dst);
-      dst->data = xallocData(src->data->numRects);
-      if (!dst->data)
-        return miRegionBreak (dst);
-      dst->data->size = src->data->numRects;
+      dst->data = src->data;
+      return TRUE;
     }
+  xfreeData(dst);
+  dst->data = &miEmptyData;
+  dst->data = miAllocData(dst, src->data->numRects);
+  if (!dst->data)
+    return miRegionBreak (dst);
+  dst->data->size = src->data->numRects;
+  if (REGION_IS_LOCAL (dst))
+    dst->data->size = RAPICORN_REGION_INLINE_RECTS;
   dst->data->numRects = src->data->numRects;
   memmove((char *)REGION_BOXPTR(dst),(char *)REGION_BOXPTR(src),
           dst->data->numRects * sizeof(BoxRec));
@@ -552,6 +615,8 @@ miCoalesce (
     register BoxPtr	pCurBox;    	/* Current box in current band       */
     register int  	numRects;	/* Number rectangles in both bands   */
     register Xint64	y2;		/* Bottom of current band	     */
+    Xint64		xdiff;		/* Accumulated x differences	     */
+    int			i;
     /*
      * Figure out how many rectangles are in the band.
      */
@@ -576,14 +641,18 @@ miCoalesce (
      */
     y2 = pCurBox->y2;
 
-    do {
-	if ((pPrevBox->x1 != pCurBox->x1) || (pPrevBox->x2 != pCurBox->x2)) {
-	    return (curStart);
-	}
-	pPrevBox++;
-	pCurBox++;
-	numRects--;
-    } while (numRects);
+    /*
+     * Most mismatches show at the first box, the remaining boxes are
+     * compared without branches, so the loop can be vectorized.
+     */
+    if ((pPrevBox->x1 != pCurBox->x1) || (pPrevBox->x2 != pCurBox->x2))
+	return (curStart);
+    xdiff = 0;
+    for (i = 1; i < numRects; i++)
+	xdiff |= (pPrevBox[i].x1 ^ pCurBox[i].x1) | (pPrevBox[i].x2 ^ pCurBox[i].x2);
+    if (xdiff)
+	return (curStart);
+    pPrevBox += numRects;
 
     /*
      * The bands may be merged, so set the bottom y of each box
@@ -746,6 +815,7 @@ miRegionOp(
     register Xint64 r2y1;
     int		    newSize;
     int		    numRects;
+    BoxRec	    localRects[RAPICORN_REGION_INLINE_RECTS];
 
     /*
      * Break any region computed from a broken region
@@ -774,7 +844,23 @@ miRegionOp(
     if (((newReg == reg1) && (newSize > 1)) ||
 	((newReg == reg2) && (numRects > 1)))
     {
-	oldData = newReg->data;
+	if (REGION_IS_LOCAL (newReg))
+	{
+	    /* move inline source rectangles aside, so newReg can reuse its inline storage */
+	    memcpy (localRects, REGION_BOXPTR (newReg), newReg->data->numRects * sizeof (BoxRec));
+	    if (newReg == reg1)
+	    {
+		r1 = localRects;
+		r1End = r1 + newSize;
+	    }
+	    else
+	    {
+		r2 = localRects;
+		r2End = r2 + numRects;
+	    }
+	}
+	else
+	    oldData = newReg->data;
 	newReg->data = &miEmptyData;
     }
     /* guess at new size */
@@ -783,6 +869,11 @@ miRegionOp(
     newSize <<= 1;
     if (!newReg->data)
 	newReg->data = &miEmptyData;
+    else if (REGION_SHARED (newReg))
+    {
+	xfreeData(newReg);
+	newReg->data = &miEmptyData;
+    }
     else if (newReg->data->size)
 	newReg->data->numRects = 0;
     if (newSize > newReg->data->size)
@@ -913,7 +1004,7 @@ miRegionOp(
     }
 
     if (oldData)
-	xfree(oldData);
+	miReleaseData(newReg, oldData);
 
     if (!(numRects = newReg->data->numRects))
     {
@@ -1801,6 +1892,35 @@ _rapicorn_region_xor (RapicornRegion       *region,
   fix_empty_region (region);
 }
 
+/* Shift region by dx, dy, banding is unaffected by translation. */
+void
+_rapicorn_region_translate (RapicornRegion *region,
+                            llint64_t       dx,
+                            llint64_t       dy)
+{
+  assert (region != NULL);
+  if (_rapicorn_region_empty (region) || REGION_NAR (region))
+    return;
+  if (REGION_SHARED (region) && !miRectAlloc (region, 0))
+    return;
+  int i, n = REGION_NUM_RECTS (region);
+  BoxPtr rects = REGION_RECTS (region); /* points to extents for single rectangle regions */
+  for (i = 0; i < n; i++)
+    {
+      rects[i].x1 += dx;
+      rects[i].y1 += dy;
+      rects[i].x2 += dx;
+      rects[i].y2 += dy;
+    }
+  if (region->data)
+    {
+      region->extents.x1 += dx;
+      region->extents.y1 += dy;
+      region->extents.x2 += dx;
+      region->extents.y2 += dy;
+    }
+}
+
 /* Alter region so that it is empty. */
 void
 _rapicorn_region_clear (RapicornRegion *region)
@@ -1822,6 +1942,8 @@ _rapicorn_region_equal (const RapicornRegion *region,
 {
   if (_rapicorn_region_empty (region) && _rapicorn_region_empty (region2))
     return TRUE;        /* empty regions are equal regardless of their zero-size extents */
+  if (region->data == region2->data)    /* shared rectangles, only extents can differ */
+    return memcmp (&region->extents, &region2->extents, sizeof (region->extents)) == 0;
   return miRegionEqual (rmutable (region), rmutable (region2));
 }
 
@@ -1857,9 +1979,15 @@ void
 _rapicorn_region_swap (RapicornRegion *region,
                        RapicornRegion *region2)
 {
+  const bool local1 = REGION_IS_LOCAL (region), local2 = REGION_IS_LOCAL (region2);
   RapicornRegion tregion = *region;
   *region = *region2;
   *region2 = tregion;
+  /* inline storage moved along with the structure contents */
+  if (local1)
+    region2->data = REGION_LOCAL (region2);
+  if (local2)
+    region->data = REGION_LOCAL (region);
   fix_empty_region (region);
   fix_empty_region (region2);
 }
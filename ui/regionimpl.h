@@ -9,6 +9,7 @@
 RAPICORN_EXTERN_C_BEGIN();
 
 /* --- types & macros --- */
+#define RAPICORN_REGION_INLINE_RECTS    8       /* rectangles stored without heap allocation */
 typedef signed long long int llint64_t;
 typedef char llint64_size_assertion_t[-!(sizeof (llint64_t) == 8)];
 typedef enum {
@@ -62,6 +63,9 @@ void			_rapicorn_region_intersect 	(RapicornRegion       	   *region,
 							 const RapicornRegion 	   *region2);
 void			_rapicorn_region_xor 		(RapicornRegion       	   *region,
 							 const RapicornRegion 	   *region2);
+void			_rapicorn_region_translate	(RapicornRegion       	   *region,
+							 llint64_t                  dx,
+							 llint64_t                  dy);
 
 RAPICORN_EXTERN_C_END();
 
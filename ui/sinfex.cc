@@ -8,130 +8,146 @@
 namespace Rapicorn {
 
 /* --- Sinfex standard functions --- */
-class StandardScope : public Sinfex::Scope {
-  Scope &chain_scope_;
-  typedef Sinfex::Value Value;
-  double
-  vdouble (const Value &v)
-  {
-    return v.real();
-  }
-  Value
-  printfunc (uint                 stdnum,
-             const vector<Value> &args)
-  {
-    String s;
-    for (uint i = 0; i < args.size(); i++)
-      s += args[i].string();
-    if (stdnum == 1)
-      printout ("%s", s.c_str());
-    else if (stdnum == 2)
-      printerr ("%s", s.c_str());
-    return Value ("");
-  }
-  enum SeqType { SEQCOUNT, SEQMIN, SEQMAX, SEQSUM, SEQAVG, };
-  Value
-  seqfunc (const SeqType        seqtype,
-           const vector<Value> &args)
-  {
-    double accu = args.size() ? vdouble (args[0]) : 0;
-    if (seqtype == SEQCOUNT)
-      return Value (args.size());
-    for (uint i = 1; i < args.size(); i++)
-      {
-        double v = vdouble (args[i]);
-        switch (seqtype)
-          {
-          case SEQMIN:  accu = MIN (accu, v);   break;
-          case SEQMAX:  accu = MAX (accu, v);   break;
-          case SEQAVG:
-          case SEQSUM:  accu += v;              break;
-          default: ;
-          }
-      }
-    if (seqtype == SEQAVG && args.size())
-      accu /= args.size();
-    return Value (accu);
-  }
-public:
-  StandardScope (Scope &chain) :
-    chain_scope_ (chain)
-  {}
-  virtual Value
-  resolve_variable (const String        &entity,
-                    const String        &name)
-  {
-    return chain_scope_.resolve_variable (entity, name);
-  }
-#define MATH1FUNC(func,args)    Value (({ double v = func (vdouble (args[0])); v; }))
-#define RETURN_IF_MATH1FUNC(func,args,nm)     ({ if (nm == #func) return MATH1FUNC (func, args); })
-#define MATH2FUNC(func,args)    Value (({ double v = func (vdouble (args[0]), vdouble (args[1])); v; }))
-#define RETURN_IF_MATH2FUNC(func,args,nm)     ({ if (nm == #func) return MATH2FUNC (func, args); })
-  virtual Value
-  call_function (const String        &entity,
-                 const String        &name,
-                 const vector<Value> &args)
-  {
-    if (entity == "")
-      {
-        if (args.size() == 0)
-          {
-            if (name == "rand")
-              return Value (drand48());
-          }
-        else if (args.size() == 1)
-          {
-            if (name == "bool")
-              return Value (args[0].asbool());
-            else if (name == "strbool")
-              return Value (string_to_bool (args[0].string()));
-            else if (name == "real")
-              return Value (args[0].real());
-            RETURN_IF_MATH1FUNC (ceil,  args, name);
-            RETURN_IF_MATH1FUNC (floor, args, name);
-            RETURN_IF_MATH1FUNC (round, args, name);
-            RETURN_IF_MATH1FUNC (log10, args, name);
-            RETURN_IF_MATH1FUNC (log2, args, name);
-            RETURN_IF_MATH1FUNC (log, args, name);
-            RETURN_IF_MATH1FUNC (exp, args, name);
-          }
-        else if (args.size() == 2)
-          {
-            RETURN_IF_MATH2FUNC (hypot, args, name);
-          }
-        if (name == "count")
-          return seqfunc (SEQCOUNT, args);
-        else if (name == "min")
-          return seqfunc (SEQMIN, args);
-        else if (name == "max")
-          return seqfunc (SEQMAX, args);
-        else if (name == "sum")
-          return seqfunc (SEQSUM, args);
-        else if (name == "avg")
-          return seqfunc (SEQAVG, args);
-        else if (name == "printout")
-          return printfunc (1, args);
-        else if (name == "printerr")
-          return printfunc (2, args);
-      }
-    return chain_scope_.call_function (entity, name, args);
-  }
+enum SinfexBuiltin {
+  BUILTIN_RAND, BUILTIN_BOOL, BUILTIN_STRBOOL, BUILTIN_REAL,
+  BUILTIN_CEIL, BUILTIN_FLOOR, BUILTIN_ROUND, BUILTIN_LOG10, BUILTIN_LOG2, BUILTIN_LOG, BUILTIN_EXP,
+  BUILTIN_HYPOT,
+  BUILTIN_COUNT, BUILTIN_MIN, BUILTIN_MAX, BUILTIN_SUM, BUILTIN_AVG,
+  BUILTIN_PRINTOUT, BUILTIN_PRINTERR,
 };
 
-/* --- Sinfex Class --- */
-Sinfex::Sinfex () :
-  start_ (NULL)
-{}
+static const struct {
+  const char *name;
+  int         n_args;   // -1 for any number of arguments
+  bool        pure;     // results only depend on arguments, calls can be folded
+} sinfex_builtins[] = {
+  { "rand",     0, false }, { "bool",     1, true }, { "strbool",  1, true }, { "real",     1, true },
+  { "ceil",     1, true  }, { "floor",    1, true }, { "round",    1, true }, { "log10",    1, true },
+  { "log2",     1, true  }, { "log",      1, true }, { "exp",      1, true },
+  { "hypot",    2, true  },
+  { "count",   -1, true  }, { "min",     -1, true }, { "max",     -1, true }, { "sum",     -1, true }, { "avg",     -1, true },
+  { "printout", -1, false }, { "printerr", -1, false },
+};
 
-Sinfex::~Sinfex ()
+static int
+sinfex_builtin_lookup (const String &name, uint n_args)
 {
-  if (start_)
+  for (uint i = 0; i < ARRAY_SIZE (sinfex_builtins); i++)
+    if (name == sinfex_builtins[i].name && (sinfex_builtins[i].n_args < 0 || uint (sinfex_builtins[i].n_args) == n_args))
+      return i;
+  return -1;
+}
+
+static Sinfex::Value
+sinfex_builtin_call (uint builtin, const Sinfex::Value *args, uint n_args)
+{
+  typedef Sinfex::Value Value;
+  double accu;
+  String s;
+  switch (builtin)
+    {
+    case BUILTIN_RAND:          return Value (drand48());
+    case BUILTIN_BOOL:          return Value (args[0].asbool());
+    case BUILTIN_STRBOOL:       return Value (string_to_bool (args[0].string()));
+    case BUILTIN_REAL:          return Value (args[0].real());
+    case BUILTIN_CEIL:          return Value (ceil (args[0].real()));
+    case BUILTIN_FLOOR:         return Value (floor (args[0].real()));
+    case BUILTIN_ROUND:         return Value (round (args[0].real()));
+    case BUILTIN_LOG10:         return Value (log10 (args[0].real()));
+    case BUILTIN_LOG2:          return Value (log2 (args[0].real()));
+    case BUILTIN_LOG:           return Value (log (args[0].real()));
+    case BUILTIN_EXP:           return Value (exp (args[0].real()));
+    case BUILTIN_HYPOT:         return Value (hypot (args[0].real(), args[1].real()));
+    case BUILTIN_COUNT:         return Value (n_args);
+    case BUILTIN_MIN: case BUILTIN_MAX: case BUILTIN_SUM: case BUILTIN_AVG:
+      accu = n_args ? args[0].real() : 0;
+      for (uint i = 1; i < n_args; i++)
+        {
+          const double v = args[i].real();
+          accu = builtin == BUILTIN_MIN ? MIN (accu, v) : builtin == BUILTIN_MAX ? MAX (accu, v) : accu + v;
+        }
+      if (builtin == BUILTIN_AVG && n_args)
+        accu /= n_args;
+      return Value (accu);
+    case BUILTIN_PRINTOUT: case BUILTIN_PRINTERR:
+      for (uint i = 0; i < n_args; i++)
+        s += args[i].string();
+      if (builtin == BUILTIN_PRINTOUT)
+        printout ("%s", s.c_str());
+      else
+        printerr ("%s", s.c_str());
+      return Value ("");
+    }
+  fatal ("Sinfex: invalid builtin function: %u", builtin);
+}
+
+/* --- Sinfex operators --- */
+static inline int
+sinfex_cmp_values (const Sinfex::Value &a, const Sinfex::Value &b)
+{
+  /* like ECMAScript, perform string comparison only if both types are strings */
+  if (RAPICORN_UNLIKELY (a.isstring()) && RAPICORN_UNLIKELY (b.isstring()))
+    return strcmp (a.string().c_str(), b.string().c_str());
+  else
+    {
+      /* numrical comparison */
+      const double ar = a.real(), br = b.real();
+      return ar - br < 0 ? -1 : ar - br > 0 ? +1 : 0;
+    }
+}
+
+static Sinfex::Value
+sinfex_unary_op (uint op, const Sinfex::Value &a)
+{
+  typedef Sinfex::Value Value;
+  switch (op)
     {
-      delete[] start_;
-      start_ = NULL;
+    case SINFEX_NOT:    return Value (!a.asbool());
+    case SINFEX_NEG:    return Value (-a.real());
+    case SINFEX_POS:    return Value (a.real());
     }
+  fatal ("Sinfex: invalid unary op code: %u", op);
 }
 
+static Sinfex::Value
+sinfex_binary_op (uint op, const Sinfex::Value &a, const Sinfex::Value &b)
+{
+  typedef Sinfex::Value Value;
+  switch (op)
+    {
+      double ar, br;
+    case SINFEX_OR:     return Value (a.asbool() ? a : b);
+    case SINFEX_AND:    return Value (a.asbool() ? b : a);
+    case SINFEX_ADD:
+      /* like ECMAScript, perform string concatenation if either type is string */
+      if (a.isstring() || b.isstring())
+        return Value (a.string() + b.string());
+      else
+        return Value (a.real() + b.real());
+    case SINFEX_SUB:    return Value (a.real() - b.real());
+    case SINFEX_MUL:    return Value (a.real() * b.real());
+    case SINFEX_DIV:
+      ar = a.real(), br = b.real();
+      /* like ECMAScript, produce +-Infinity for division by zero */
+      return Value (br != 0 ? ar / br : copysign (ar == 0 ? nanl ("0xbad0") : INFINITY, ar * br));
+    case SINFEX_POW:    return Value (pow (a.real(), b.real()));
+    case SINFEX_EQ:     return Value (sinfex_cmp_values (a, b) == 0);
+    case SINFEX_NE:     return Value (sinfex_cmp_values (a, b) != 0);
+    case SINFEX_LT:     return Value (sinfex_cmp_values (a, b) < 0);
+    case SINFEX_GT:     return Value (sinfex_cmp_values (a, b) > 0);
+    case SINFEX_LE:     return Value (sinfex_cmp_values (a, b) <= 0);
+    case SINFEX_GE:     return Value (sinfex_cmp_values (a, b) >= 0);
+    }
+  fatal ("Sinfex: invalid binary op code: %u", op);
+}
+
+/* --- Sinfex Class --- */
+Sinfex::Sinfex ()
+{}
+
+Sinfex::~Sinfex ()
+{}
+
 Sinfex::Value::Value (const String &s) :
   string_ (string_from_cquote (s)), real_ (0), strflag_ (1)
 {}
@@ -155,47 +171,81 @@ Sinfex::Value::string2real () const
 }
 
 /* --- SinfexExpression Class --- */
+/* The parse tree from SinfexExpressionStack is compiled into postfix bytecode for a value
+ * stack. Operators and pure builtin functions with constant operands are folded, variable
+ * references are bound to frame slots that are resolved at most once per evaluation.
+ */
 class SinfexExpression : public virtual Sinfex {
-  inline int
-  cmp_values (const Value &a, const Value &b)
-  {
-    /* like ECMAScript, perform string comparison only if both types are strings */
-    if (RAPICORN_UNLIKELY (a.isstring()) && RAPICORN_UNLIKELY (b.isstring()))
-      return strcmp (a.string().c_str(), b.string().c_str());
-    else
-      {
-        /* numrical comparison */
-        const double ar = a.real(), br = b.real();
-        return ar - br < 0 ? -1 : ar - br > 0 ? +1 : 0;
-      }
-  }
-  Value eval_op (Scope &scope, uint opx);
+  struct Instruction {
+    uint                op, arg, n_args;
+  };
+  struct Variable {
+    String              entity, name;
+  };
+  vector<Instruction>   code_;
+  vector<Value>         constants_;
+  vector<Variable>      variables_;
+  StringVector          functions_;
+  uint                  max_depth_;
+  bool                  compile         (const uint *tree, uint opx, uint depth);
+  bool                  emit_constant   (const Value &value);
+  bool                  fold            (uint n_operands);
+  uint                  variable_slot   (const String &entity, const String &name);
+  Value                 execute         (const Instruction *ip, const Instruction *end,
+                                         Scope *scope, Value *slots, vector<bool> &resolved) const;
 public:
-  SinfexExpression (const SinfexExpressionStack &estk)
+  SinfexExpression (const SinfexExpressionStack &estk) :
+    max_depth_ (0)
   {
-    const uint *prog = estk.startmem();
-    if (prog)
-      {
-        start_ = new uint[prog[0] / sizeof (uint)];
-        memcpy (start_, prog, prog[0]);
-      }
+    const uint *tree = estk.startmem();
+    if (tree && tree[1])
+      compile (tree, tree[1], 0);
   }
   virtual Value
   eval (Scope &scope)
   {
-    if (!start_ || !start_[1])
+    if (code_.empty())
       return Value (0);
-    else
-      {
-        StandardScope stdscope (scope);
-        return eval_op (stdscope, start_[1]);
-      }
+    const uint n_slots = variables_.size();
+    vector<Value> slots (n_slots, Value (0));
+    vector<bool> resolved (n_slots, false);
+    return execute (code_.data(), code_.data() + code_.size(), &scope, slots.data(), resolved);
   }
 };
 
-Sinfex::Value
-SinfexExpression::eval_op (Scope &scope,
-                           uint   opx)
+bool
+SinfexExpression::emit_constant (const Value &value)
+{
+  constants_.push_back (value);
+  code_.push_back (Instruction { SINFEX_CONSTANT, uint (constants_.size() - 1), 0 });
+  return true;
+}
+
+bool
+SinfexExpression::fold (uint n_operands)
+{
+  // the last instruction consumes the constants pushed by the preceding n_operands instructions
+  const size_t first = code_.size() - 1 - n_operands;
+  assert (n_operands == 0 || code_[first].arg == constants_.size() - n_operands);
+  vector<bool> no_slots; // folded instructions are constants and operators only
+  const Value result = execute (&code_[first], &code_[code_.size()], NULL, NULL, no_slots);
+  code_.resize (first);
+  constants_.resize (constants_.size() - n_operands, Value (0));
+  return emit_constant (result);
+}
+
+uint
+SinfexExpression::variable_slot (const String &entity, const String &name)
+{
+  for (uint i = 0; i < variables_.size(); i++)
+    if (variables_[i].entity == entity && variables_[i].name == name)
+      return i;
+  variables_.push_back (Variable { entity, name });
+  return variables_.size() - 1;
+}
+
+bool
+SinfexExpression::compile (const uint *tree, uint opx, uint depth)
 {
   union Mark {
     const uint   *up;
@@ -204,140 +254,115 @@ SinfexExpression::eval_op (Scope &scope,
     const double *dp;
   };
   Mark mark;
-  mark.up = start_ + opx;
-  assert (mark.up + 1 <= start_ + start_[0]);
-  switch (*mark.up++)
+  mark.up = tree + opx;
+  assert (mark.up + 1 <= tree + tree[0]);
+  max_depth_ = MAX (max_depth_, depth + 1);
+  const uint op = *mark.up++;
+  switch (op)
     {
       uint ui;
-    case SINFEX_0:      return Value (0);
-    case SINFEX_REAL:   return Value (*mark.dp);
+    case SINFEX_0:      return emit_constant (Value (0));
+    case SINFEX_REAL:   return emit_constant (Value (*mark.dp));
     case SINFEX_STRING:
       ui = *mark.up++;
-      return Value (String (mark.cp, ui));
+      return emit_constant (Value (String (mark.cp, ui)));
     case SINFEX_VARIABLE:
-      {
-        ui = *mark.up++;
-        String varname = String (mark.cp, ui);
-        Value result = scope.resolve_variable ("", varname);
-        return result;
-      }
+      ui = *mark.up++;
+      code_.push_back (Instruction { SINFEX_SLOT, variable_slot ("", String (mark.cp, ui)), 0 });
+      return false;
     case SINFEX_ENTITY_VARIABLE:
       {
-        String v1, v2;
         ui = *mark.up++;
-        String entity = String (mark.cp, ui);
+        const String entity = String (mark.cp, ui);
         mark.up += (ui + 3) / 4;
         ui = *mark.up++;
-        String varname = String (mark.cp, ui);
-        v2 = String (mark.cp, ui);
-        Value result = scope.resolve_variable (entity, varname);
-        return result;
-      }
-    case SINFEX_OR:
-      {
-        const Value &a = eval_op (scope, *mark.up++), &b = eval_op (scope, *mark.up++);
-        return Value (a.asbool() ? a : b);
-      }
-    case SINFEX_AND:
-      {
-        const Value &a = eval_op (scope, *mark.up++), &b = eval_op (scope, *mark.up++);
-        return Value (a.asbool() ? b : a);
-      }
-    case SINFEX_NOT:
-      {
-        const Value &a = eval_op (scope, *mark.up++);
-        return Value (!a.asbool());
-      }
-    case SINFEX_NEG:
-      {
-        const Value &a = eval_op (scope, *mark.up++);
-        return Value (-a.real());
+        code_.push_back (Instruction { SINFEX_SLOT, variable_slot (entity, String (mark.cp, ui)), 0 });
+        return false;
       }
-    case SINFEX_POS:
+    case SINFEX_NOT: case SINFEX_NEG: case SINFEX_POS:
       {
-        const Value &a = eval_op (scope, *mark.up++);
-        return Value (a.real());
+        const bool constant = compile (tree, *mark.up++, depth);
+        code_.push_back (Instruction { op, 0, 1 });
+        return constant && fold (1);
       }
-    case SINFEX_ADD:
+    case SINFEX_OR: case SINFEX_AND:
+    case SINFEX_ADD: case SINFEX_SUB: case SINFEX_MUL: case SINFEX_DIV: case SINFEX_POW:
+    case SINFEX_EQ: case SINFEX_NE: case SINFEX_LT: case SINFEX_GT: case SINFEX_LE: case SINFEX_GE:
       {
-        const Value &a = eval_op (scope, *mark.up++), &b = eval_op (scope, *mark.up++);
-        /* like ECMAScript, perform string concatenation if either type is string */
-        if (a.isstring() || b.isstring())
-          return Value (a.string() + b.string());
-        else
-          return Value (a.real() + b.real());
-      }
-    case SINFEX_SUB:
-      {
-        const Value &a = eval_op (scope, *mark.up++), &b = eval_op (scope, *mark.up++);
-        return Value (a.real() - b.real());
-      }
-    case SINFEX_MUL:
-      {
-        const Value &a = eval_op (scope, *mark.up++), &b = eval_op (scope, *mark.up++);
-        return Value (a.real() * b.real());
-      }
-    case SINFEX_DIV:
-      {
-        const Value &a = eval_op (scope, *mark.up++), &b = eval_op (scope, *mark.up++);
-        double ar = a.real(), br = b.real();
-        /* like ECMAScript, produce +-Infinity for division by zero */
-        return Value (br != 0 ? ar / br : copysign (ar == 0 ? nanl ("0xbad0") : INFINITY, ar * br));
-      }
-    case SINFEX_POW:
-      {
-        const Value &a = eval_op (scope, *mark.up++), &b = eval_op (scope, *mark.up++);
-        return Value (pow (a.real(), b.real()));
-      }
-    case SINFEX_EQ:
-      {
-        const Value &a = eval_op (scope, *mark.up++), &b = eval_op (scope, *mark.up++);
-        return Value (cmp_values (a, b) == 0);
-      }
-    case SINFEX_NE:
-      {
-        const Value &a = eval_op (scope, *mark.up++), &b = eval_op (scope, *mark.up++);
-        return Value (cmp_values (a, b) != 0);
-      }
-    case SINFEX_LT:
-      {
-        const Value &a = eval_op (scope, *mark.up++), &b = eval_op (scope, *mark.up++);
-        return Value (cmp_values (a, b) < 0);
-      }
-    case SINFEX_GT:
-      {
-        const Value &a = eval_op (scope, *mark.up++), &b = eval_op (scope, *mark.up++);
-        return Value (cmp_values (a, b) > 0);
-      }
-    case SINFEX_LE:
-      {
-        const Value &a = eval_op (scope, *mark.up++), &b = eval_op (scope, *mark.up++);
-        return Value (cmp_values (a, b) <= 0);
-      }
-    case SINFEX_GE:
-      {
-        const Value &a = eval_op (scope, *mark.up++), &b = eval_op (scope, *mark.up++);
-        return Value (cmp_values (a, b) >= 0);
+        const bool constant1 = compile (tree, mark.up[0], depth);
+        const bool constant2 = compile (tree, mark.up[1], depth + 1);
+        code_.push_back (Instruction { op, 0, 2 });
+        return constant1 && constant2 && fold (2);
       }
     case SINFEX_FUNCTION:
       {
         Mark arg;
-        arg.up = start_ + *mark.up++;
+        arg.up = tree + *mark.up++;
         ui = *mark.up++;
-        vector<Value> funcargs;
-        while (arg.up > start_ && *arg.up++ == SINFEX_ARG)
+        const String funcname = String (mark.cp, ui);
+        uint n_args = 0;
+        bool constant = true;
+        while (arg.up > tree && *arg.up++ == SINFEX_ARG)
           {
             uint valindex = *arg.up++;
-            arg.up = start_ + *arg.up;
-            funcargs.push_back (eval_op (scope, valindex));
+            arg.up = tree + *arg.up;
+            constant = compile (tree, valindex, depth + n_args++) && constant;
+          }
+        const int builtin = sinfex_builtin_lookup (funcname, n_args);
+        if (builtin >= 0)
+          {
+            code_.push_back (Instruction { SINFEX_BUILTIN, uint (builtin), n_args });
+            return constant && sinfex_builtins[builtin].pure && fold (n_args);
           }
-        String funcname = String (mark.cp, ui);
-        Value result = scope.call_function ("", funcname, funcargs);
-        return result;
+        functions_.push_back (funcname);
+        code_.push_back (Instruction { SINFEX_CALL, uint (functions_.size() - 1), n_args });
+        return false;
       }
-    case SINFEX_ARG: ;
     }
-  fatal ("Expression with invalid op code: (%p:%u:%u)", start_, mark.up - 1 - start_, *(mark.up-1));
+  fatal ("Expression with invalid op code: (%p:%u:%u)", tree, opx, op);
+}
+
+Sinfex::Value
+SinfexExpression::execute (const Instruction *ip, const Instruction *end, Scope *scope, Value *slots, vector<bool> &resolved) const
+{
+  vector<Value> stack;
+  stack.reserve (max_depth_);
+  for (; ip < end; ip++)
+    switch (ip->op)
+      {
+      case SINFEX_CONSTANT:
+        stack.push_back (constants_[ip->arg]);
+        break;
+      case SINFEX_SLOT:
+        if (!resolved[ip->arg])
+          {
+            slots[ip->arg] = scope->resolve_variable (variables_[ip->arg].entity, variables_[ip->arg].name);
+            resolved[ip->arg] = true;
+          }
+        stack.push_back (slots[ip->arg]);
+        break;
+      case SINFEX_NOT: case SINFEX_NEG: case SINFEX_POS:
+        stack.back() = sinfex_unary_op (ip->op, stack.back());
+        break;
+      case SINFEX_BUILTIN:
+      case SINFEX_CALL:
+        {
+          const size_t first = stack.size() - ip->n_args;
+          Value result = ip->op == SINFEX_BUILTIN ? sinfex_builtin_call (ip->arg, stack.data() + first, ip->n_args) :
+                         scope->call_function ("", functions_[ip->arg], vector<Value> (stack.begin() + first, stack.end()));
+          stack.erase (stack.begin() + first, stack.end());
+          stack.push_back (result);
+        }
+        break;
+      default: // binary operators
+        {
+          const Value b = stack.back();
+          stack.pop_back();
+          stack.back() = sinfex_binary_op (ip->op, stack.back(), b);
+        }
+        break;
+      }
+  return stack.back();
 }
 
 /* --- Parser Class --- */
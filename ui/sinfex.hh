@@ -13,7 +13,6 @@ typedef std::weak_ptr  <Sinfex> SinfexW;
 class Sinfex {
   RAPICORN_CLASS_NON_COPYABLE (Sinfex);
 protected:
-  uint          *start_;
   explicit       Sinfex ();
   virtual       ~Sinfex ();
 public:
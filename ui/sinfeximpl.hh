@@ -31,6 +31,11 @@ typedef enum {
   SINFEX_GE,
   SINFEX_ARG,
   SINFEX_FUNCTION,
+  // bytecode only
+  SINFEX_CONSTANT,
+  SINFEX_SLOT,
+  SINFEX_BUILTIN,
+  SINFEX_CALL,
 } SinfexOp;
 
 class SinfexExpressionStack {
@@ -100,6 +100,7 @@ top_attach (const WidgetImpl::PackInfo &pi)
 TableLayoutImpl::TableLayoutImpl() :
   default_col_spacing_ (0), default_row_spacing_ (0), homogeneous_widgets_ (false)
 {
+  set_flag (CONCURRENT_RENDER); // HBox, VBox, Table and SliderArea paint nothing themselves
   resize_table (1, 1);
 }
 
@@ -0,0 +1,102 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include <rcore/testutils.hh>
+#include <ui/blitfuncs.hh>
+
+namespace {
+using namespace Rapicorn;
+using namespace Rapicorn::Blit;
+
+static vector<uint32>
+random_pixels (uint n)
+{
+  vector<uint32> pixels (n);
+  for (uint i = 0; i < n; i++)
+    pixels[i] = Test::random_int64();
+  return pixels;
+}
+
+static void
+test_blit_kernels()
+{
+  RenderTable alu, simd;
+  TASSERT (render_table_setup (&alu, RENDER_ALU));
+  const uint N = 1021; // odd length covers vector loops and scalar tails
+  const vector<uint32> src = random_pixels (N + 1), dst = random_pixels (N + 1);
+  vector<uint32> premul (N + 1); // valid premultiplied pixels, MMX saturates where ALU wraps around
+  alu.premultiply_rgba (&premul[0], (const uint8*) &src[0], N + 1);
+  for (int level = RENDER_MMX; level <= RENDER_AVX2; level++)
+    {
+      if (!render_table_setup (&simd, RenderLevel (level)))
+        continue;
+      for (uint offset = 0; offset < 2; offset++) // check unaligned access
+        {
+          vector<uint32> d1 (dst), d2 (dst);
+          alu.combine_over (&d1[offset], &premul[offset], N);
+          simd.combine_over (&d2[offset], &premul[offset], N);
+          simd.clear_fpu();
+          TASSERT (d1 == d2);
+          const uint8 *rgba = (const uint8*) &src[offset];
+          alu.premultiply_rgba (&d1[0], rgba, N);
+          simd.premultiply_rgba (&d2[0], rgba, N);
+          TASSERT (d1 == d2);
+          d2 = src;
+          simd.premultiply_rgba (&d2[offset], (const uint8*) &d2[offset], N); // in-place conversion
+          TASSERT (std::equal (&d1[0], &d1[N], &d2[offset]));
+          d2 = d1;
+          alu.expand_rgb (&d1[0], rgba, N);
+          simd.expand_rgb (&d2[0], rgba, N);
+          TASSERT (d1 == d2);
+          alu.unpremultiply_rgba ((uint8*) &d1[0], &src[offset], N);
+          simd.unpremultiply_rgba ((uint8*) &d2[0], &src[offset], N);
+          TASSERT (d1 == d2);
+          alu.fill (&d1[offset], src[0], N);
+          simd.fill (&d2[offset], src[0], N);
+          TASSERT (d1 == d2);
+          for (uint k : { 0U, 1U, 7U, 8U, 15U, 16U, N - 1 })
+            {
+              d2 = d1;
+              d2[offset + k] ^= 0x00010000;
+              TCMP (simd.find_mismatch (&d1[offset], &d2[offset], N), ==, k);
+              TCMP (alu.find_mismatch (&d1[offset], &d2[offset], N), ==, k);
+            }
+          TCMP (simd.find_mismatch (&d1[offset], &d1[offset], N), ==, N);
+        }
+    }
+}
+REGISTER_TEST ("Blit/SIMD Kernels", test_blit_kernels);
+
+static void
+bench_blit_kernels()
+{
+  const uint N = 64 * 1024;
+  const vector<uint32> src = random_pixels (N);
+  vector<uint32> dst = random_pixels (N);
+  RenderTable table;
+  for (int level = RENDER_ALU; level <= RENDER_AVX2; level++)
+    {
+      if (!render_table_setup (&table, RenderLevel (level)))
+        continue;
+      Test::Timer timer (0.1); // maximum seconds
+      const double mpix = N / 1000000.;
+      const double over = timer.benchmark ([&] () { table.combine_over (&dst[0], &src[0], N); table.clear_fpu(); });
+      const double prem = timer.benchmark ([&] () { table.premultiply_rgba (&dst[0], (const uint8*) &src[0], N); });
+      const double unpr = timer.benchmark ([&] () { table.unpremultiply_rgba ((uint8*) &dst[0], &src[0], N); });
+      const double xrgb = timer.benchmark ([&] () { table.expand_rgb (&dst[0], (const uint8*) &src[0], N * 3 / 4); });
+      dst = src;
+      const double cmp = timer.benchmark ([&] () { table.find_mismatch (&dst[0], &src[0], N); });
+      TPASS ("%-5s pixel kernels # MPixel/s: over=%.1f premultiply=%.1f unpremultiply=%.1f rgb=%.1f compare=%.1f\n",
+             render_level_name (RenderLevel (level)), mpix / over, mpix / prem, mpix / unpr, mpix * 3 / 4 / xrgb, mpix / cmp);
+    }
+}
+REGISTER_TEST ("Blit/Benchmark Kernels", bench_blit_kernels);
+
+} // Anon
+
+int
+main (int   argc,
+      char *argv[])
+{
+  init_core_test (__PRETTY_FILE__, &argc, argv);
+
+  return Test::run();
+}
@@ -72,4 +72,63 @@ property_test()
 }
 REGISTER_UITHREAD_TEST ("Objects/Property Test", property_test);
 
+static void
+bindable_relay_test()
+{
+  BindableRelayIfaceP relay = ApplicationImpl::the().create_bindable_relay();
+  BindableIfaceP bindable = std::dynamic_pointer_cast<BindableIface> (relay);
+  TASSERT (bindable != NULL);
+  StringVector requests, notifies;
+  vector<int64> get_nonces;
+  relay->sig_relay_set() += [&requests] (const String &bpath, int64 nonce, const Any &value) {
+    requests.push_back (string_format ("set:%s=%d", bpath, value.as_int64()));
+  };
+  relay->sig_relay_get() += [&requests, &get_nonces] (const String &bpath, int64 nonce) {
+    requests.push_back (string_format ("get:%s", bpath));
+    get_nonces.push_back (nonce);
+  };
+  bindable->sig_bindable_notify() += [&notifies] (const String &property) {
+    notifies.push_back (property);
+  };
+  MainLoopP loop = uithread_main_loop();
+  Any any;
+  // repeated SETs within one frame are sent once, with the latest value
+  bindable->bindable_set ("a", Any (int64 (1)));
+  bindable->bindable_set ("b", Any (int64 (2)));
+  bindable->bindable_set ("a", Any (int64 (3)));
+  TCMP (requests.size(), ==, 0);
+  loop->iterate_pending();
+  TCMP (string_join (" ", requests), ==, "set:a=3 set:b=2");
+  requests.clear();
+  // reading right after setting sends the SET before the GET
+  bindable->bindable_set ("a", Any (int64 (4)));
+  bindable->bindable_get ("a", any);
+  TCMP (string_join (" ", requests), ==, "set:a=4 get:a");
+  TCMP (get_nonces.size(), ==, 1);
+  // a SET supersedes an outstanding GET, its result must not be cached
+  bindable->bindable_set ("a", Any (int64 (5)));
+  bindable->bindable_get ("a", any);
+  TCMP (get_nonces.size(), ==, 2);
+  relay->report_result (get_nonces[0], Any (int64 (4)), "");
+  relay->report_result (get_nonces[1], Any (int64 (5)), "");
+  TCMP (string_join (" ", notifies), ==, "a");
+  any = Any();
+  bindable->bindable_get ("a", any);
+  TCMP (any.as_int64(), ==, 5);
+  loop->iterate_pending();
+  requests.clear();
+  notifies.clear();
+  // notifications within one frame are delivered once per property, in reporting order
+  relay->report_notify ("b");
+  relay->report_notify ("a");
+  relay->report_notify ("b");
+  relay->report_notify ("c");
+  relay->report_notify ("a");
+  TCMP (notifies.size(), ==, 0);
+  loop->iterate_pending();
+  TCMP (string_join (" ", notifies), ==, "b a c");
+  TCMP (requests.size(), ==, 0);
+}
+REGISTER_UITHREAD_TEST ("Objects/BindableRelay Coalescing", bindable_relay_test);
+
 } // anon
@@ -282,4 +282,71 @@ test_region_cmp ()
 }
 REGISTER_UITHREAD_TEST ("Region/random-cmp", test_region_cmp);
 
+static void
+test_region_sharing ()
+{
+  // build a region with more rectangles than fit inline
+  Region big;
+  for (uint i = 0; i < 32; i++)
+    big.add (Rect (i * 10, i * 7, 5, 5));
+  TCMP (big.count_rects(), ==, 32);
+  // copies share rectangles until modified
+  Region copy = big, small (Rect (0, 0, 5, 5));
+  TCMP (copy, ==, big);
+  copy.subtract (small);
+  TCMP (copy.count_rects(), ==, 31);
+  TCMP (big.count_rects(), ==, 32);
+  TCMP (copy, !=, big);
+  copy.add (small);
+  TCMP (copy, ==, big);
+  // inline rectangles survive swap and copy
+  Region inl;
+  for (uint i = 0; i < 4; i++)
+    inl.add (Rect (i * 10, 0, 5, 5));
+  Region inl2 = inl;
+  inl.swap (copy);
+  TCMP (copy, ==, inl2);
+  TCMP (inl, ==, big);
+  copy.add (Rect (100, 0, 5, 5));
+  TCMP (copy.count_rects(), ==, 5);
+  TCMP (inl2.count_rects(), ==, 4);
+  // translation keeps banding intact
+  Region moved = big;
+  moved.translate (-3.5, 2);
+  TCMP (moved.count_rects(), ==, 32);
+  TASSERT (moved.extents().equals (Rect (-3.5, 2, 31 * 10 + 5, 31 * 7 + 5), moved.epsilon()));
+  TCMP (big.extents().x, ==, 0);
+  moved.translate (3.5, -2);
+  TCMP (moved, ==, big);
+}
+REGISTER_UITHREAD_TEST ("Region/sharing", test_region_sharing);
+
+static void
+test_region_coalesce()
+{
+  Region region;
+  region.add (Rect (0, 0, 10, 10));
+  region.add (Rect (11, 0, 10, 10));
+  region.add (Rect (100, 100, 5, 5));
+  TCMP (region.count_rects(), ==, 3);
+  TCMP (region.area(), ==, 225);
+  // close neighbours are merged, distant rectangles are kept
+  Region merged = region;
+  TCMP (merged.coalesce (0.1, 16), ==, 10);
+  TCMP (merged.count_rects(), ==, 2);
+  TCMP (merged.contains (Rect (0, 0, 21, 10)), ==, Region::INSIDE);
+  Region exact = region;
+  TCMP (exact.coalesce (0.01, 16), ==, 0);
+  TCMP (exact, ==, region);
+  // rectangle cap falls back to the bounding box
+  Region scattered;
+  for (uint i = 0; i < 32; i++)
+    scattered.add (Rect (i * 10, i * 7, 5, 5));
+  const double waste = scattered.coalesce (0.1, 4);
+  TCMP (scattered.count_rects(), ==, 1);
+  TASSERT (scattered.extents() == Rect (0, 0, 31 * 10 + 5, 31 * 7 + 5));
+  TCMP (waste, ==, (31 * 10 + 5) * (31 * 7 + 5) - 32 * 25);
+}
+REGISTER_UITHREAD_TEST ("Region/coalesce", test_region_coalesce);
+
 } // Anon
@@ -27,6 +27,42 @@ test_basics ()
 }
 REGISTER_UITHREAD_TEST ("Sinfex/Basics", test_basics);
 
+struct CountingScope : public Sinfex::Scope {
+  uint resolves = 0, calls = 0;
+  virtual Sinfex::Value
+  resolve_variable (const String &entity, const String &name)
+  {
+    resolves++;
+    return Sinfex::Value (entity == "w" ? 10 : 2);
+  }
+  virtual Sinfex::Value
+  call_function (const String &entity, const String &name, const vector<Sinfex::Value> &args)
+  {
+    calls++;
+    return Sinfex::Value (args.size());
+  }
+};
+
+static void
+test_bytecode ()
+{
+  // constant subexpressions never reach the scope
+  SinfexP sinfex = Sinfex::parse_string ("(1 + 2) * 3 + floor (2.5) + count (1, 2) + ('a' == 'a')");
+  TCMP (sinfex->eval (*(Sinfex::Scope*) NULL).real(), ==, 14);
+  // each variable is resolved once per evaluation, unknown functions are called with all arguments
+  sinfex = Sinfex::parse_string ("x * x + w.x + x - custom (x, 1, w.x) + max (x, 1)");
+  CountingScope scope;
+  TCMP (sinfex->eval (scope).real(), ==, 4 + 10 + 2 - 3 + 2);
+  TCMP (scope.resolves, ==, 2);
+  TCMP (scope.calls, ==, 1);
+  TCMP (sinfex->eval (scope).real(), ==, 15);
+  TCMP (scope.resolves, ==, 4);
+  // impure builtins are evaluated each time
+  sinfex = Sinfex::parse_string ("rand()");
+  TCMP (sinfex->eval (scope).real(), !=, sinfex->eval (scope).real());
+}
+REGISTER_UITHREAD_TEST ("Sinfex/Bytecode", test_bytecode);
+
 static void
 eval_expect_tests ()
 {
@@ -129,6 +165,14 @@ eval_expect_tests ()
     STRLINE, "count (0, 1)", "2",
     STRLINE, "count (1, 2, 3)", "3",
     STRLINE, "rand() > 0 and rand() != rand() and 'OK'", "OK",
+    STRLINE, "max (1, 7, one) + min (3, one, 2)", "8",
+    STRLINE, "hypot (3, 4) == 5 and avg (1, 2, 3) == 2 and 'OK'", "OK",
+    /* constant folding and variable slots */
+    STRLINE, "'a' + 1 + 2", "a12",
+    STRLINE, "1 + 2 + 'a'", "3a",
+    STRLINE, "-(2 * 3) + real (one)", "-5",
+    STRLINE, "real (one) + one * 2 + one ** 2", "4",
+    STRLINE, "empty or 'x' + one", "x1",
   };
   Evaluator ev;
   Evaluator::VariableMap map;
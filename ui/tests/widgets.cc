@@ -23,4 +23,198 @@ test_window()
 }
 REGISTER_UITHREAD_TEST ("Widgets/Test Window creation", test_window);
 
+/// Multi child container with manually placed children and settable child affines.
+class PointGridTestImpl : public virtual MultiContainerImpl {
+  std::map<const WidgetImpl*, Affine> affines_;
+protected:
+  virtual void   size_request  (Requisition &requisition) override     { requisition = Requisition (1000, 1000); }
+  virtual void   size_allocate (Allocation area, bool changed) override {} // children are placed by the test
+public:
+  virtual Affine
+  child_affine (const WidgetImpl &widget) override
+  {
+    auto it = affines_.find (&widget);
+    return it != affines_.end() ? it->second : Affine();
+  }
+  void
+  child_transform (WidgetImpl &child, const Affine &affine)
+  {
+    affines_[&child] = affine;
+    invalidate_point_index(); // child_affine() changed
+  }
+};
+static const WidgetFactory<PointGridTestImpl> point_grid_test_factory ("Rapicorn::PointGridTest");
+
+static WidgetImpl*
+point_child (PointGridTestImpl &container, double x, double y)
+{
+  vector<WidgetImplP> stack;
+  container.point_children (Point (x, y), stack);
+  return stack.empty() ? NULL : stack[0].get();
+}
+
+static void
+test_point_grid()
+{
+  ApplicationImpl &app = ApplicationImpl::the();
+  WindowIface &window = *app.create_window ("Window");
+  WidgetImplP cwidget = Factory::create_ui_widget ("PointGridTest");
+  PointGridTestImpl *container = dynamic_cast<PointGridTestImpl*> (cwidget.get());
+  TASSERT (container != NULL);
+  window.impl().add (*container);
+  // place 8x8 children on a 10 pixel raster, enough to be indexed by the point grid
+  vector<WidgetImpl*> children;
+  for (uint i = 0; i < 64; i++)
+    {
+      WidgetImplP child = Factory::create_ui_child (*container, "Alignment", Factory::ArgumentList());
+      child->set_allocation (Allocation (i % 8 * 10, i / 8 * 10, 10, 10));
+      children.push_back (child.get());
+    }
+  TCMP (point_child (*container, 15, 25), ==, children[17]);
+  TCMP (point_child (*container, 79, 79), ==, children[63]);
+  TCMP (point_child (*container, 85, 5), ==, (WidgetImpl*) NULL);
+  // lookups must follow moved children
+  children[17]->set_allocation (Allocation (500, 500, 10, 10));
+  TCMP (point_child (*container, 15, 25), ==, (WidgetImpl*) NULL);
+  TCMP (point_child (*container, 505, 505), ==, children[17]);
+  TCMP (point_child (*container, 5, 5), ==, children[0]);
+  // lookups must follow transformed children
+  container->child_transform (*children[0], AffineTranslate (-200, -200));
+  TCMP (point_child (*container, 5, 5), ==, (WidgetImpl*) NULL);
+  TCMP (point_child (*container, 205, 205), ==, children[0]);
+  TCMP (point_child (*container, 15, 5), ==, children[1]);
+  container->child_transform (*children[0], Affine());
+  TCMP (point_child (*container, 5, 5), ==, children[0]);
+  TCMP (point_child (*container, 205, 205), ==, (WidgetImpl*) NULL);
+  window.close();
+}
+REGISTER_UITHREAD_TEST ("Widgets/Point Grid Hit Testing", test_point_grid);
+
+static bool
+surfaces_equal (cairo_surface_t *s1, cairo_surface_t *s2)
+{
+  cairo_surface_flush (s1);
+  cairo_surface_flush (s2);
+  const int height = cairo_image_surface_get_height (s1), stride = cairo_image_surface_get_stride (s1);
+  return height == cairo_image_surface_get_height (s2) && stride == cairo_image_surface_get_stride (s2) &&
+         memcmp (cairo_image_surface_get_data (s1), cairo_image_surface_get_data (s2), height * stride) == 0;
+}
+
+static void
+test_tiled_rendering()
+{
+  ApplicationImpl &app = ApplicationImpl::the();
+  WindowIface &window_iface = *app.create_window ("Window");
+  WindowImpl &window = window_iface.impl();
+  WidgetImplP vbox = Factory::create_ui_child (window, "VBox", Factory::ArgumentList());
+  ContainerImpl *vcontainer = vbox->as_container_impl();
+  TASSERT (vcontainer != NULL);
+  // 3x3 widgets of 90x70 pixels, crossing the 128x128 tile boundaries
+  for (uint i = 0; i < 3; i++)
+    {
+      WidgetImplP hbox = Factory::create_ui_child (*vcontainer, "HBox", Factory::ArgumentList());
+      ContainerImpl &hcontainer = *hbox->as_container_impl();
+      Factory::create_ui_child (hcontainer, "DotGrid", Factory::ArgumentList ({ "width=90", "height=70", "dot-type=in" }));
+      Factory::create_ui_child (hcontainer, "Arrow", Factory::ArgumentList ({ "width=90", "height=70", "arrow-dir=up" }));
+      Factory::create_ui_child (hcontainer, "DotGrid", Factory::ArgumentList ({ "width=90", "height=70", "dot-type=etched-out", "n-hdots=7" }));
+    }
+  const Requisition requisition = window.requisition();
+  window.set_allocation (Allocation (0, 0, requisition.width, requisition.height));
+  const Allocation area = window.allocation();
+  TASSERT (area.width > 256 && area.height > 128);
+  // tiles rendered on the TaskPool must match a serial rendering, also while exposes are pending
+  uint n_tiles = 0;
+  window.expose();
+  cairo_surface_t *tiled = window.create_snapshot (area, &n_tiles);
+  cairo_surface_t *serial = window.create_snapshot (area);
+  TCMP (n_tiles, >, 1);
+  TASSERT (surfaces_equal (serial, tiled));
+  cairo_surface_destroy (tiled);
+  cairo_surface_destroy (serial);
+  // widgets that did not opt into CONCURRENT_RENDER force serial rendering
+  Factory::create_ui_child (*vcontainer, "Frame", Factory::ArgumentList ({ "width=270", "height=20" }));
+  window.set_allocation (Allocation (0, 0, requisition.width, requisition.height + 20));
+  tiled = window.create_snapshot (window.allocation(), &n_tiles);
+  serial = window.create_snapshot (window.allocation());
+  TCMP (n_tiles, ==, 0);
+  TASSERT (surfaces_equal (serial, tiled));
+  cairo_surface_destroy (tiled);
+  cairo_surface_destroy (serial);
+  window.close();
+}
+REGISTER_UITHREAD_TEST ("Widgets/Tiled Rendering", test_tiled_rendering);
+
+/// Widget painting a solid color into a retained render layer, recording render() calls.
+class LayerTestImpl : public virtual SingleContainerImpl {
+  uint32 argb_;
+protected:
+  virtual void size_request (Requisition &requisition) override { requisition = Requisition (64, 64); }
+  virtual void
+  render (RenderContext &rcontext, const Rect &rect) override
+  {
+    cairo_t *cr = cairo_context (rcontext, rect);
+    cairo_set_source_rgba (cr, (argb_ >> 16 & 0xff) / 255., (argb_ >> 8 & 0xff) / 255., (argb_ & 0xff) / 255., (argb_ >> 24) / 255.);
+    cairo_paint (cr);
+    last_rect = rect;
+    n_renders++;
+  }
+public:
+  uint n_renders;
+  Rect last_rect;
+  explicit LayerTestImpl () : argb_ (0xffff0000), n_renders (0) { set_flag (RENDER_LAYER); }
+  void     argb          (uint32 argb)                         { argb_ = argb; invalidate_content(); }
+};
+static const WidgetFactory<LayerTestImpl> layer_test_factory ("Rapicorn::LayerTest");
+
+static uint32
+snapshot_pixel (WindowImpl &window, int x, int y)
+{
+  cairo_surface_t *surface = window.create_snapshot (window.allocation());
+  cairo_surface_flush (surface);
+  const uint8 *row = cairo_image_surface_get_data (surface) + y * cairo_image_surface_get_stride (surface);
+  const uint32 pixel = ((const uint32*) row)[x];
+  cairo_surface_destroy (surface);
+  return pixel;
+}
+
+static void
+test_render_layer()
+{
+  ApplicationImpl &app = ApplicationImpl::the();
+  WindowIface &window_iface = *app.create_window ("Window");
+  WindowImpl &window = window_iface.impl();
+  WidgetImplP lwidget = Factory::create_ui_child (window, "LayerTest", Factory::ArgumentList());
+  LayerTestImpl *layered = dynamic_cast<LayerTestImpl*> (lwidget.get());
+  TASSERT (layered != NULL);
+  window.set_allocation (Allocation (0, 0, 64, 64));
+  TCMP (snapshot_pixel (window, 32, 32), ==, 0xffff0000);
+  const uint n_renders = layered->n_renders;
+  TCMP (n_renders, >, 0);
+  // unchanged layers are composited without rendering
+  TCMP (snapshot_pixel (window, 32, 32), ==, 0xffff0000);
+  TCMP (layered->n_renders, ==, n_renders);
+  // content changes must not leave stale pixels behind
+  layered->argb (0xff0000ff);
+  TCMP (snapshot_pixel (window, 32, 32), ==, 0xff0000ff);
+  TCMP (layered->n_renders, ==, n_renders + 1);
+  layered->argb (0xff00ff00); // INVALID_CONTENT is still set, the layer must be dropped regardless
+  window.set_allocation (Allocation (0, 0, 64, 64)); // clears INVALID_CONTENT
+  TCMP (snapshot_pixel (window, 32, 32), ==, 0xff00ff00);
+  TCMP (layered->n_renders, ==, n_renders + 2);
+  TCMP (snapshot_pixel (window, 0, 0), ==, 0xff00ff00);
+  // exposes only re-render the damaged part of the layer
+  const Allocation area = layered->allocation();
+  layered->expose (Rect (area.x, area.y, 16, 16));
+  TCMP (snapshot_pixel (window, 8, 8), ==, 0xff00ff00);
+  TCMP (layered->n_renders, ==, n_renders + 3);
+  TCMP (layered->last_rect.width, ==, 16);
+  TCMP (layered->last_rect.height, ==, 16);
+  // allocation changes re-render the complete layer
+  window.set_allocation (Allocation (0, 0, 48, 48));
+  TCMP (snapshot_pixel (window, 40, 40), ==, 0xff00ff00);
+  TCMP (layered->last_rect.width, ==, layered->allocation().width);
+  window.close();
+}
+REGISTER_UITHREAD_TEST ("Widgets/Render Layer Invalidation", test_render_layer);
+
 } // Anon
@@ -141,6 +141,8 @@ private:
     assert_return (idata_ != NULL);
     // idata_core() already called
     ThisThread::affinity (string_to_int (string_vector_find_value (*idata_->args, "cpu-affinity=", "-1")));
+    // handle input bursts without re-preparing all sources per event, bounded to stay responsive
+    main_loop_->dispatch_budget (16, 4000);
     // initialize Application singleton
     ApplicationImpl &application = ApplicationImpl::the();
     // setup Aida server connection for RPC calls
@@ -7,7 +7,7 @@
 namespace Rapicorn {
 
 ViewportImpl::ViewportImpl () :
-  xoffset_ (0), yoffset_ (0),
+  expose_overdraw_ (0), xoffset_ (0), yoffset_ (0),
   sig_scrolled (Aida::slot (*this, &ViewportImpl::do_scrolled))
 {
   const_cast<AnchorInfo*> (force_anchor_info())->viewport = this;
@@ -25,6 +25,7 @@ ViewportImpl::scroll_offsets (int deltax, int deltay)
     {
       xoffset_ = deltax;
       yoffset_ = deltay;
+      invalidate_point_index(); // child_affine() changed
       // FIXME: need to issue 0-distance move here
       sig_scrolled.emit();
     }
@@ -63,6 +64,13 @@ ViewportImpl::render_recursive (RenderContext &rcontext)
 
 void
 ViewportImpl::render (RenderContext &rcontext, const Rect &rect)
+{
+  render_child (rcontext, rect, true);
+}
+
+/// Render the viewport child into @a rect, @a consume_exposes removes the rendered area from the pending exposes.
+void
+ViewportImpl::render_child (RenderContext &rcontext, const Rect &rect, bool consume_exposes)
 {
   if (!has_drawable_child())
     return;
@@ -83,13 +91,26 @@ ViewportImpl::render (RenderContext &rcontext, const Rect &rect)
   // render child stack
   if (!what.empty())
     {
-      expose_region_.subtract (what);
+      if (consume_exposes)
+        expose_region_.subtract (what);
       cairo_t *cr = cairo_context (rcontext, rarea);
       cairo_translate (cr, area.x - xoffset, area.y - yoffset);
       child.render_into (cr, what);
     }
 }
 
+/// Remove @a region, given in viewport coordinates, from the pending exposes.
+void
+ViewportImpl::subtract_expose_region (const Region &region)
+{
+  if (expose_region_.empty())
+    return;
+  const Allocation &area = allocation();
+  Region what = region;
+  what.translate (xoffset_ - area.x, yoffset_ - area.y); // translate to child coords
+  expose_region_.subtract (what);
+}
+
 void
 ViewportImpl::expose_child_region (const Region &region)
 {
@@ -108,25 +129,38 @@ ViewportImpl::expose_child_region (const Region &region)
     }
 }
 
+// Expose coalescing policy, configurable via RAPICORN_DEBUG=expose-waste=0.25:expose-rects=32
+static double expose_max_waste = -1;
+static uint   expose_max_rects = 0;
+
+/** Configure how expose regions are simplified before rendering.
+ * Expose rectangles are merged into bounding boxes as long as at most @a max_waste
+ * (0..1) of a merged box is area that wasn't exposed, if more than @a max_rects
+ * rectangles remain, the bounding box of all exposes is rendered instead.
+ */
+void
+ViewportImpl::expose_coalescing (double max_waste, uint max_rects)
+{
+  expose_max_waste = CLAMP (max_waste, 0.0, 1.0);
+  expose_max_rects = MAX (1, max_rects);
+}
+
 void
 ViewportImpl::collapse_expose_region ()
 {
-  // check for excess expose fragment scenarios
-  uint n_erects = expose_region_.count_rects();
-  /* considering O(n^2) collision computation complexity, but also focus frame
-   * exposures which easily consist of 4+ fragments, a hundred rectangles turn
-   * out to be an emperically suitable threshold.
+  if (RAPICORN_UNLIKELY (expose_max_waste < 0))
+    expose_coalescing (string_to_double (debug_config_get ("expose-waste", "0.25")),
+                       string_to_uint (debug_config_get ("expose-rects", "32")));
+  /* considering O(n^2) coalescing complexity, but also focus frame exposures
+   * which easily consist of 4+ fragments, merging is only attempted for regions
+   * with more rectangles than fit into the inline Region storage.
    */
-  if (n_erects > 99)
+  const uint n_erects = expose_region_.count_rects();
+  if (n_erects > 8)
     {
-      /* aparently the expose fragments we're combining are too small,
-       * so we can end up with spending too much time on expose rectangle
-       * compression (more time than needed for actual rendering).
-       * as a workaround, we simply force everything into a single expose
-       * rectangle which is good enough to avoid worst case explosion.
-       */
-      expose_region_.add (expose_region_.extents());
-      VDEBUG ("collapsing expose rectangles due to overflow: %u -> %u", n_erects, expose_region_.count_rects());
+      // earlier waste is now part of expose_region_ and may since have been exposed, only count the latest
+      expose_overdraw_ = expose_region_.coalesce (expose_max_waste, expose_max_rects);
+      VDEBUG ("coalescing expose rectangles: %u -> %u (overdraw=%.0f)", n_erects, expose_region_.count_rects(), expose_overdraw_);
     }
 }
 
@@ -9,15 +9,19 @@ namespace Rapicorn {
 
 class ViewportImpl : public virtual ResizeContainerImpl {
   Region                expose_region_;        // maintained in child coord space
+  double                expose_overdraw_;      // area added to expose_region_ by the last coalescing
   int                   xoffset_, yoffset_;
   void                  collapse_expose_region  ();
 protected:
   virtual Affine        child_affine            (const WidgetImpl &widget);
   const Region&         peek_expose_region      () const { return expose_region_; }
-  void                  discard_expose_region   () { expose_region_.clear(); }
+  void                  discard_expose_region   () { expose_region_.clear(); expose_overdraw_ = 0; }
+  double                expose_overdraw         () const { return expose_overdraw_; }
   bool                  exposes_pending         () const { return !expose_region_.empty(); }
+  void                  subtract_expose_region  (const Region &region);
   virtual void          render_recursive        (RenderContext &rcontext);
   virtual void          render                  (RenderContext &rcontext, const Rect &rect);
+  void                  render_child            (RenderContext &rcontext, const Rect &rect, bool consume_exposes);
   void                  scroll_offsets          (int deltax, int deltay);
   void                  do_scrolled             ();
   int                   scroll_offset_x         () const { return xoffset_; }
@@ -25,6 +29,7 @@ protected:
 public:
   Aida::Signal<void ()> sig_scrolled;
   void                  expose_child_region     (const Region &region);
+  static void           expose_coalescing       (double max_waste, uint max_rects);
   Allocation            child_viewport          ();
   explicit              ViewportImpl            ();
   virtual              ~ViewportImpl            ();
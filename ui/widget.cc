@@ -1375,6 +1375,8 @@ WidgetImpl::invalidate (uint64 mask)
   const bool had_invalid_content = test_any_flag (INVALID_CONTENT);
   const bool had_invalid_allocation = test_any_flag (INVALID_ALLOCATION);
   const bool had_invalid_requisition = test_any_flag (INVALID_REQUISITION);
+  if ((mask & INVALID_CONTENT) && test_any_flag (RENDER_LAYER))
+    delete_data (&render_layer_key);    // content changed, even if already invalid
   if (!had_invalid_content && (mask & INVALID_CONTENT))
     expose();
   change_flags_silently (mask, true);
@@ -1450,6 +1452,33 @@ WidgetImpl::tune_requisition (double new_width,
   return tune_requisition (req);
 }
 
+// Retained rendering of a #RENDER_LAYER widget, see render_layer()
+struct RenderLayer {
+  cairo_surface_t *surface;
+  Rect             area;
+  WidgetState      state;
+  Region           damage;      // exposed parts of area that need re-rendering
+  explicit         RenderLayer () : surface (NULL), state (WidgetState::NORMAL) {}
+  /*dtor*/        ~RenderLayer () { assign (NULL, Rect(), WidgetState::NORMAL); }
+  void
+  assign (cairo_surface_t *lsurface, const Rect &larea, WidgetState lstate)
+  {
+    if (surface)
+      cairo_surface_destroy (surface);
+    surface = lsurface;
+    area = larea;
+    state = lstate;
+    damage.clear();
+  }
+};
+class RenderLayerKey : public DataKey<RenderLayer*> {
+  virtual void destroy (RenderLayer *layer) override
+  {
+    delete layer;
+  }
+};
+static RenderLayerKey render_layer_key;
+
 void
 WidgetImpl::expose_internal (const Region &region)
 {
@@ -1457,11 +1486,26 @@ WidgetImpl::expose_internal (const Region &region)
     {
       // queue expose region on nextmost viewport
       ViewportImpl *vp = parent() ? parent()->get_viewport() : get_viewport();
+      damage_render_layers (region, vp);
       if (vp)
         vp->expose_child_region (region);
     }
 }
 
+/// Add @a region to the damage of the retained layers of this widget and its ancestors below @a viewport.
+void
+WidgetImpl::damage_render_layers (const Region &region, ViewportImpl *viewport)
+{
+  // ancestors beyond the viewport use other coordinates, they are damaged by the viewport's own expose
+  for (WidgetImpl *widget = this; widget && widget != viewport; widget = widget->parent())
+    if (widget->test_any_flag (RENDER_LAYER))
+      {
+        RenderLayer *layer = widget->get_data (&render_layer_key);
+        if (layer)
+          layer->damage.add (region);
+      }
+}
+
 /** Invalidate drawing contents of a widget
  *
  * Cause the given @a region of @a this widget to be rerendered.
@@ -1941,6 +1985,8 @@ WidgetImpl::set_allocation (const Allocation &area, const Allocation *clip)
   Allocation a = allocation();
   const bool need_expose = oa != a || oc != clip || test_any_flag (INVALID_CONTENT);
   change_flags_silently (INVALID_CONTENT, false); // skip notification
+  if ((oa != a || oc != clip) && test_any_flag (RENDER_LAYER))
+    delete_data (&render_layer_key);    // layer size and position changed
   // expose old area
   if (need_expose)
     {
@@ -1948,6 +1994,9 @@ WidgetImpl::set_allocation (const Allocation &area, const Allocation *clip)
       if (oc)
         region.intersect (oc_copy);
       expose_internal (region); // don't intersect with new allocation
+      ContainerImpl *pc = parent();
+      if (pc)
+        pc->invalidate_point_index();
     }
   /* expose new area */
   if (need_expose)
@@ -1998,6 +2047,15 @@ WidgetImpl::render_into (cairo_t *cr, const Region &region)
 /// Render widget's clipped allication area contents into the rendering context provided.
 void
 WidgetImpl::render_widget (RenderContext &rcontext)
+{
+  if (test_any_flag (RENDER_LAYER) && render_layer (rcontext))
+    return;
+  render_content (rcontext);
+}
+
+/// Render widget and descendants via render() and render_recursive(), honoring clip_area().
+void
+WidgetImpl::render_content (RenderContext &rcontext)
 {
   size_t n_cairos = rcontext.cairos.size();
   Rect area = clipped_allocation();
@@ -2030,6 +2088,73 @@ void
 WidgetImpl::render_recursive (RenderContext &rcontext)
 {}
 
+/** Composite the retained rendering layer of a #RENDER_LAYER widget.
+ * The layer covers the complete clipped_allocation(), it is discarded by invalidate() with #INVALID_CONTENT,
+ * allocation changes and if the hierarchical clip or widget state changed. Exposes of the widget or its
+ * descendants only cause the damaged parts of the layer to be re-rendered.
+ * Returns false if the widget has no visible area to keep a layer for.
+ */
+bool
+WidgetImpl::render_layer (RenderContext &rcontext)
+{
+  Rect area = clipped_allocation();
+  if (rcontext.hierarchical_clip)
+    area.intersect (*rcontext.hierarchical_clip);
+  const int width = iceil (area.width), height = iceil (area.height);
+  if (width < 1 || height < 1)
+    return false;
+  RenderLayer *layer = get_data (&render_layer_key);
+  if (!layer)
+    {
+      layer = new RenderLayer();
+      set_data (&render_layer_key, layer);
+    }
+  if (!layer->surface || layer->area != area || layer->state != state())
+    {
+      cairo_surface_t *lsurface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+      critical_unless (cairo_surface_status (lsurface) == CAIRO_STATUS_SUCCESS);
+      cairo_surface_set_device_offset (lsurface, -area.x, -area.y);
+      layer->assign (lsurface, area, state());
+      layer->damage = area;
+    }
+  layer->damage.intersect (area);
+  cairo_surface_t *surface = cairo_surface_reference (layer->surface);
+  if (!layer->damage.empty())
+    {
+      // exposes or invalidation from within render() must not get lost or free the layer under us
+      Region damage;
+      damage.swap (layer->damage);
+      RenderContext lcontext;
+      lcontext.render_area = damage;
+      lcontext.hierarchical_clip = rcontext.hierarchical_clip;
+      render_content (lcontext);
+      cairo_t *cr = cairo_create (surface);
+      vector<Rect> rects;
+      damage.list_rects (rects);
+      for (size_t i = 0; i < rects.size(); i++)
+        cairo_rectangle (cr, rects[i].x, rects[i].y, rects[i].width, rects[i].height);
+      cairo_clip (cr);
+      cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+      cairo_paint (cr);
+      cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
+      for (size_t i = 0; i < lcontext.surfaces.size(); i++)
+        {
+          cairo_set_source_surface (cr, lcontext.surfaces[i], 0, 0);
+          cairo_paint (cr);
+        }
+      cairo_destroy (cr);
+    }
+  rcontext.surfaces.push_back (surface);
+  return true;
+}
+
+/// Check if rendering @a region may be split into tiles that are rendered on several threads at once.
+bool
+WidgetImpl::render_concurrently (const Region &region)
+{
+  return test_any_flag (CONCURRENT_RENDER) && !test_any_flag (RENDER_LAYER);
+}
+
 const Region&
 WidgetImpl::rendering_region (RenderContext &rcontext) const
 {
@@ -112,6 +112,8 @@ protected:
     ALLOW_FOCUS            = 1ULL << 33, ///< Flag set by the widget user to indicate if a widget may or may not receive focus.
     NEEDS_FOCUS_INDICATOR  = 1ULL << 34, ///< Flag used for containers that need a focus-indicator to receive input focus.
     HAS_FOCUS_INDICATOR    = 1ULL << 35, ///< Flag set on #NEEDS_FOCUS_INDICATOR containers if a descendant provides a focus-indicator.
+    CONCURRENT_RENDER      = 1ULL << 36, ///< Opt-in flag for widgets whose render() only reads widget state and may run concurrently for several tiles, see render_concurrently().
+    RENDER_LAYER           = 1ULL << 37, ///< Opt-in flag for widgets that retain an offscreen layer of their rendering, see render_layer().
   };
   void                        set_flag          (uint64 flag, bool on = true);
   void                        unset_flag        (uint64 flag)   { set_flag (flag, false); }
@@ -257,6 +259,7 @@ public:
   virtual void                changed           (const String &name) override;
   void                        invalidate        (uint64 mask = INVALID_REQUISITION | INVALID_ALLOCATION | INVALID_CONTENT);
   void                        invalidate_size   ()                      { invalidate (INVALID_REQUISITION | INVALID_ALLOCATION); }
+  void                        invalidate_content ()                     { invalidate (INVALID_CONTENT); }
   void                        expose            () { expose (allocation()); } ///< Expose entire widget, see expose(const Region&)
   void                        expose            (const Rect &rect) { expose (Region (rect)); } ///< Rectangle constrained expose()
   void                        expose            (const Region &region);
@@ -275,7 +278,12 @@ protected:
   // rendering
   class RenderContext;
   virtual void               render_widget             (RenderContext    &rcontext);
+  void                       render_content            (RenderContext    &rcontext);
+  bool                       render_layer              (RenderContext    &rcontext);
+  void                       damage_render_layers      (const Region     &region,
+                                                        ViewportImpl     *viewport);
   virtual void               render_recursive          (RenderContext    &rcontext);
+  virtual bool               render_concurrently       (const Region     &region);
   virtual void               render                    (RenderContext    &rcontext, const Rect &rect) = 0;
   const Region&              rendering_region          (RenderContext    &rcontext) const;
   virtual cairo_t*           cairo_context             (RenderContext    &rcontext,
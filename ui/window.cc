@@ -182,8 +182,12 @@ WindowImpl::set_focus (WidgetImpl *widget)
     }
 }
 
+/** Render @a subarea of the window into a new image surface.
+ * If @a n_tiles is given, the snapshot is rendered as concurrent tiles if the widget tree allows it,
+ * and the number of tiles rendered concurrently is stored in @a n_tiles.
+ */
 cairo_surface_t*
-WindowImpl::create_snapshot (const Rect &subarea)
+WindowImpl::create_snapshot (const Rect &subarea, uint *n_tiles)
 {
   const Allocation area = allocation();
   Region region = area;
@@ -191,6 +195,12 @@ WindowImpl::create_snapshot (const Rect &subarea)
   cairo_surface_t *surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, subarea.width, subarea.height);
   critical_unless (cairo_surface_status (surface) == CAIRO_STATUS_SUCCESS);
   cairo_surface_set_device_offset (surface, -subarea.x, -subarea.y);
+  subtract_expose_region (region); // render() leaves expose_region_ alone, it may run on several threads
+  if (n_tiles)
+    {
+      *n_tiles = render_tiled (surface, region, subarea.x, subarea.y, true);
+      return surface;
+    }
   cairo_t *cr = cairo_create (surface);
   critical_unless (CAIRO_STATUS_SUCCESS == cairo_status (cr));
   render_into (cr, region);
@@ -356,6 +366,7 @@ WindowImpl::dispatch_mouse_movement (const Event &event)
 {
   last_event_context_ = event;
   vector<WidgetImplP> pierced;
+  pierced.reserve (last_entered_children_.size() + 1);
   /* figure all entered children */
   bool unconfined;
   WidgetImpl* grab_widget = get_grab (&unconfined);
@@ -748,6 +759,7 @@ WindowImpl::draw_now ()
       // determine invalidated rendering region
       Region region = area;
       region.intersect (peek_expose_region());
+      const double overdraw = expose_overdraw();
       discard_expose_region();
       // rendering rectangle
       Rect rrect = region.extents();
@@ -755,23 +767,75 @@ WindowImpl::draw_now ()
       cairo_surface_t *surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, x2 - x1, y2 - y1);
       cairo_surface_set_device_offset (surface, -x1, -y1);
       critical_unless (cairo_surface_status (surface) == CAIRO_STATUS_SUCCESS);
-      cairo_t *cr = cairo_create (surface);
-      critical_unless (CAIRO_STATUS_SUCCESS == cairo_status (cr));
-      render_into (cr, region);
+      const uint n_tiles = render_tiled (surface, region, x1, y1);
       display_window_->blit_surface (surface, region);
-      cairo_destroy (cr);
       cairo_surface_destroy (surface);
       // notify "displayed" at PRIORITY_UPDATE, so other high priority handlers run first
       loop_->exec_callback ([this] () { if (display_window_) sig_displayed.emit(); }, EventLoop::PRIORITY_UPDATE);
       const uint64 stop = timestamp_realtime();
-      EDEBUG ("RENDER: %+d%+d%+dx%d coverage=%.1f%% elapsed=%.3fms",
+      EDEBUG ("RENDER: %+d%+d%+dx%d coverage=%.1f%% rects=%u overdraw=%.0f tiles=%u elapsed=%.3fms",
               x1, y1, x2 - x1, y2 - y1, ((x2 - x1) * (y2 - y1)) * 100.0 / (area.width*area.height),
-              (stop - start) / 1000.0);
+              region.count_rects(), overdraw, n_tiles, (stop - start) / 1000.0);
     }
   else
     discard_expose_region(); // nuke stale exposes
 }
 
+/** Render @a region into an image @a surface with device offset (-sx,-sy), returns the number of tiles rendered concurrently.
+ * Small areas and single core machines are rendered serially, unless @a force_tiles is true.
+ */
+uint
+WindowImpl::render_tiled (cairo_surface_t *surface, const Region &region, int sx, int sy, bool force_tiles)
+{
+  const int TILE_SIZE = 128;
+  const int width = cairo_image_surface_get_width (surface), height = cairo_image_surface_get_height (surface);
+  const bool tiled = force_tiles || ((width > TILE_SIZE || height > TILE_SIZE) && TaskPool::the().n_workers() >= 2);
+  if (!tiled || !render_concurrently (region))
+    {
+      cairo_t *cr = cairo_create (surface);
+      critical_unless (CAIRO_STATUS_SUCCESS == cairo_status (cr));
+      render_into (cr, region);
+      cairo_destroy (cr);
+      return 0;
+    }
+  // split region into tiles, each tile renders into a separate cairo surface sharing the pixel memory
+  struct Tile { int x, y, width, height; Region region; };
+  vector<Tile> tiles;
+  for (int ty = 0; ty < height; ty += TILE_SIZE)
+    for (int tx = 0; tx < width; tx += TILE_SIZE)
+      {
+        Tile tile = { tx, ty, min (TILE_SIZE, width - tx), min (TILE_SIZE, height - ty), region };
+        tile.region.intersect (Rect (sx + tx, sy + ty, tile.width, tile.height));
+        if (!tile.region.empty())
+          tiles.push_back (tile);
+      }
+  cairo_surface_flush (surface);
+  uint8 *pixels = cairo_image_surface_get_data (surface);
+  const int stride = cairo_image_surface_get_stride (surface);
+  TaskPool::the().parallel_for (0, tiles.size(), 1, [&] (size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++)
+        {
+          const Tile &tile = tiles[i];
+          cairo_surface_t *tsurface = cairo_image_surface_create_for_data (pixels + tile.y * stride + tile.x * 4, CAIRO_FORMAT_ARGB32,
+                                                                           tile.width, tile.height, stride);
+          cairo_surface_set_device_offset (tsurface, -(sx + tile.x), -(sy + tile.y));
+          cairo_t *cr = cairo_create (tsurface);
+          critical_unless (CAIRO_STATUS_SUCCESS == cairo_status (cr));
+          render_into (cr, tile.region);
+          cairo_destroy (cr);
+          cairo_surface_destroy (tsurface);
+        }
+    });
+  cairo_surface_mark_dirty (surface);
+  return tiles.size();
+}
+
+bool
+WindowImpl::render_concurrently (const Region &region)
+{
+  return render_children_concurrently (region); // WindowImpl::render() only paints the background
+}
+
 void
 WindowImpl::render (RenderContext &rcontext, const Rect &rect)
 {
@@ -785,7 +849,8 @@ WindowImpl::render (RenderContext &rcontext, const Rect &rect)
     cairo_rectangle (cr, rects[i].x, rects[i].y, rects[i].width, rects[i].height);
   cairo_clip (cr);
   cairo_paint (cr);
-  ViewportImpl::render (rcontext, rect);
+  // exposes are consumed by draw_now() and create_snapshot() before rendering
+  ViewportImpl::render_child (rcontext, rect, false);
 }
 
 void
@@ -894,11 +959,7 @@ WindowImpl::dispatch_event (const Event &event)
     case EVENT_LAST:
     case EVENT_NONE:          return false;
     case MOUSE_ENTER:         return dispatch_enter_event (event);
-    case MOUSE_MOVE:
-      if (display_window_->peek_events ([] (Event *e) { return e->type == MOUSE_MOVE; }))
-        return true; // coalesce multiple motion events
-      else
-        return dispatch_move_event (event);
+    case MOUSE_MOVE:          return dispatch_move_event (event); // motion is coalesced by DisplayWindow
     case MOUSE_LEAVE:         return dispatch_leave_event (event);
     case BUTTON_PRESS:
     case BUTTON_2PRESS:
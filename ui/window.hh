@@ -38,7 +38,7 @@ public:
   virtual              ~WindowImpl              () override;
   virtual WindowImpl*   as_window_impl          ()              { return this; }
   WidgetImpl*           get_focus               () const;
-  cairo_surface_t*      create_snapshot         (const Rect  &subarea);
+  cairo_surface_t*      create_snapshot         (const Rect  &subarea, uint *n_tiles = NULL);
   static  void          forcefully_close_all    ();
   // properties
   virtual String        title                   () const override;
@@ -83,7 +83,10 @@ private:
   virtual void          beep                                    ();
   /* rendering */
   virtual void          draw_now                                ();
+  uint                  render_tiled                            (cairo_surface_t *surface, const Region &region, int sx, int sy,
+                                                                 bool force_tiles = false);
   virtual void          render                                  (RenderContext &rcontext, const Rect &rect);
+  virtual bool          render_concurrently                     (const Region &region) override;
   /* display_window ops */
   virtual void          create_display_window                    ();
   virtual bool          has_display_window                       ();